@@ -0,0 +1,264 @@
+#ifndef BENCHUTIL_H
+#define BENCHUTIL_H
+
+/*
+ * The MIT Licese (MIT)
+ *
+ * Copyright (C) 2016 by Brian Horn, trycatchhorn@gmail.com.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+*/
+
+/*
+ * Small helpers shared by the benchmark programs. The benchmarks have no
+ * dependencies beyond the standard library.
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+namespace bench {
+
+/**
+ * Wall-clock stopwatch started on construction.
+ */
+class Timer {
+
+ public:
+
+  Timer() : start( std::chrono::steady_clock::now() ) {
+  }
+
+  /**
+   * Returns the number of nanoseconds elapsed since the timer was
+   * constructed or last restarted.
+   *
+   * @return the elapsed time in nanoseconds.
+   */
+  double elapsedNanoseconds() const {
+    return std::chrono::duration<double, std::nano>( std::chrono::steady_clock::now() - start ).count();
+  }
+
+  /**
+   * Restarts the timer.
+   */
+  void restart() {
+    start = std::chrono::steady_clock::now();
+  }
+
+ private:
+  std::chrono::steady_clock::time_point start;
+
+};
+
+/**
+ * Deterministic xorshift64* generator, so every run and every heap variant
+ * sees the same input sequence.
+ */
+class Random {
+
+ public:
+
+  explicit Random( uint64_t seed = 0x9E3779B97F4A7C15ULL ) : state( seed ? seed : 1 ) {
+  }
+
+  uint64_t next() {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 0x2545F4914F6CDD1DULL;
+  }
+
+ private:
+  uint64_t state;
+
+};
+
+/**
+ * Benchmark record of Bytes bytes ordered by a leading integer key. The
+ * remaining bytes are payload, which is copied along with the key.
+ */
+template<size_t Bytes>
+struct Record {
+  uint64_t key;
+  char payload[ Bytes - sizeof( uint64_t ) ];
+
+  Record() : key( 0 ) {
+    std::memset( payload, 0, sizeof( payload ) );
+  }
+
+  explicit Record( uint64_t k ) : key( k ) {
+    std::memset( payload, static_cast<int>( k & 0xff ), sizeof( payload ) );
+  }
+
+  friend bool operator < ( const Record& lhs, const Record& rhs ) {
+    return lhs.key < rhs.key;
+  }
+
+  friend bool operator > ( const Record& lhs, const Record& rhs ) {
+    return rhs.key < lhs.key;
+  }
+
+  friend bool operator >= ( const Record& lhs, const Record& rhs ) {
+    return !( lhs.key < rhs.key );
+  }
+
+  friend bool operator == ( const Record& lhs, const Record& rhs ) {
+    return lhs.key == rhs.key;
+  }
+};
+
+/**
+ * Integer key that counts every call to its operator<, to measure the
+ * number of comparisons done by a heap operation.
+ */
+struct CountedKey {
+  uint64_t key;
+
+  CountedKey() : key( 0 ) {
+  }
+
+  explicit CountedKey( uint64_t k ) : key( k ) {
+  }
+
+  /**
+   * Returns the number of comparisons done since the last reset.
+   */
+  static uint64_t& comparisons() {
+    static uint64_t count = 0;
+    return count;
+  }
+
+  friend bool operator < ( const CountedKey& lhs, const CountedKey& rhs ) {
+    ++comparisons();
+    return lhs.key < rhs.key;
+  }
+};
+
+/**
+ * Value of type T whose comparisons are counted on the same counter as
+ * CountedKey, to measure the comparisons of a heap operation on any
+ * benchmark type. All relational operators count, since the heaps under
+ * test do not all use the same one.
+ */
+template<typename T>
+struct Counted {
+  T value;
+
+  Counted() : value() {
+  }
+
+  Counted( const T& v ) : value( v ) {
+  }
+
+  friend bool operator < ( const Counted& lhs, const Counted& rhs ) {
+    ++CountedKey::comparisons();
+    return lhs.value < rhs.value;
+  }
+
+  friend bool operator > ( const Counted& lhs, const Counted& rhs ) {
+    ++CountedKey::comparisons();
+    return rhs.value < lhs.value;
+  }
+
+  friend bool operator >= ( const Counted& lhs, const Counted& rhs ) {
+    ++CountedKey::comparisons();
+    return !( lhs.value < rhs.value );
+  }
+
+  friend bool operator == ( const Counted& lhs, const Counted& rhs ) {
+    ++CountedKey::comparisons();
+    return lhs.value == rhs.value;
+  }
+};
+
+/**
+ * Builds a value of type T from a random number.
+ */
+template<typename T>
+T makeValue( uint64_t r ) {
+  return T( r );
+}
+
+/**
+ * Returns the integer key of a benchmark value, used to keep results alive.
+ */
+inline uint64_t keyOf( int v ) {
+  return static_cast<uint64_t>( v );
+}
+
+inline uint64_t keyOf( uint64_t v ) {
+  return v;
+}
+
+template<size_t Bytes>
+uint64_t keyOf( const Record<Bytes>& v ) {
+  return v.key;
+}
+
+inline uint64_t keyOf( const CountedKey& v ) {
+  return v.key;
+}
+
+template<typename T>
+uint64_t keyOf( const Counted<T>& v ) {
+  return keyOf( v.value );
+}
+
+/**
+ * Prevents the compiler from discarding a computed result.
+ */
+inline void consume( uint64_t value ) {
+  static volatile uint64_t sink;
+  sink = sink + value;
+}
+
+/**
+ * Prints one result line of a benchmark table.
+ */
+inline void report( const std::string& name, const std::string& type, size_t n, double nanoseconds_per_op ) {
+  std::cout << std::left << std::setw( 28 ) << name
+            << std::setw( 18 ) << type
+            << std::right << std::setw( 10 ) << n
+            << std::setw( 12 ) << std::fixed << std::setprecision( 1 ) << nanoseconds_per_op << " ns/op"
+            << std::endl;
+}
+
+/**
+ * Prints one result line of a benchmark table, with the number of
+ * comparisons and heap allocations per operation after the time.
+ */
+inline void report( const std::string& name, const std::string& type, size_t n, double nanoseconds_per_op, double comparisons_per_op, double allocations_per_op ) {
+  std::cout << std::left << std::setw( 28 ) << name
+            << std::setw( 18 ) << type
+            << std::right << std::setw( 10 ) << n
+            << std::setw( 12 ) << std::fixed << std::setprecision( 1 ) << nanoseconds_per_op << " ns/op"
+            << std::setw( 10 ) << std::setprecision( 2 ) << comparisons_per_op << " cmp/op"
+            << std::setw( 10 ) << std::setprecision( 4 ) << allocations_per_op << " alloc/op"
+            << std::endl;
+}
+
+}
+
+#endif
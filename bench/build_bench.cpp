@@ -0,0 +1,52 @@
+/*
+ * Measures how building a max-heap from a vector scales with the number of
+ * threads used by the PARALLEL creation type, next to the single-threaded
+ * ITERATIVE and RECURSIVE builds.
+ *
+ * Usage: build_bench [max_size [max_threads]]
+ */
+
+#include "BenchUtil.h"
+#include "MaxHeap.h"
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+template<size_t Arity>
+void runBuild( const std::string& name, const std::vector<uint64_t>& input, MaxHeapCreationType type, size_t threads ) {
+  std::vector<uint64_t> copy( input );
+  bench::Timer timer;
+  MaxHeap<uint64_t, Arity> h( std::move( copy ), type, threads );
+  double nanoseconds = timer.elapsedNanoseconds();
+  bench::consume( h.heapMaximum() );
+  bench::report( name, "Arity " + std::to_string( Arity ), input.size(), nanoseconds / input.size() );
+}
+
+template<size_t Arity>
+void scale( const std::vector<uint64_t>& input, size_t max_threads ) {
+  runBuild<Arity>( "ITERATIVE", input, ITERATIVE, 1 );
+  runBuild<Arity>( "RECURSIVE", input, RECURSIVE, 1 );
+  for ( size_t threads = 1; threads <= max_threads; threads *= 2 ) {
+    runBuild<Arity>( "PARALLEL " + std::to_string( threads ) + " threads", input, PARALLEL, threads );
+  }
+}
+
+int main( int argc, const char * argv[] ) {
+  size_t max_size = argc > 1 ? std::strtoull( argv[ 1 ], 0, 10 ) : 10000000;
+  size_t max_threads = argc > 2 ? std::strtoull( argv[ 2 ], 0, 10 ) : std::thread::hardware_concurrency();
+  if ( max_threads == 0 ) {
+    max_threads = 1;
+  }
+  for ( size_t n = 1000000; n <= max_size; n *= 10 ) {
+    bench::Random random;
+    std::vector<uint64_t> input;
+    input.reserve( n );
+    for ( size_t i = 0; i < n; i++ ) {
+      input.push_back( random.next() );
+    }
+    scale<2>( input, max_threads );
+    scale<4>( input, max_threads );
+  }
+  return 0;
+}
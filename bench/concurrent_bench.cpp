@@ -0,0 +1,85 @@
+/*
+ * Measures the throughput of ConcurrentMaxHeap under contention, with as
+ * many producer as consumer threads. Every element is pushed and popped
+ * once, either one at a time or in batches, which take the mutex once per
+ * batch instead of once per element.
+ *
+ * Usage: concurrent_bench [elements [max_threads]]
+ */
+
+#include "BenchUtil.h"
+#include "ConcurrentMaxHeap.h"
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+void runContention( const std::string& name, size_t elements, size_t threads, size_t batch ) {
+  ConcurrentMaxHeap<uint64_t> h;
+  size_t per_producer = elements / threads;
+  std::vector<uint64_t> sums( threads, 0 );
+  std::vector<std::thread> consumers;
+  std::vector<std::thread> producers;
+  bench::Timer timer;
+  for ( size_t c = 0; c < threads; c++ ) {
+    consumers.push_back( std::thread( [&, c]() {
+      if ( batch == 1 ) {
+        uint64_t value;
+        while ( h.pop( value ) ) {
+          sums[ c ] += value;
+        }
+      } else {
+        std::vector<uint64_t> values;
+        while ( !( values = h.popBatch( batch ) ).empty() ) {
+          for ( size_t i = 0; i < values.size(); i++ ) {
+            sums[ c ] += values[ i ];
+          }
+        }
+      }
+    } ) );
+  }
+  for ( size_t p = 0; p < threads; p++ ) {
+    producers.push_back( std::thread( [&, p]() {
+      bench::Random random( p + 1 );
+      std::vector<uint64_t> values;
+      values.reserve( batch );
+      for ( size_t i = 0; i < per_producer; i++ ) {
+        if ( batch == 1 ) {
+          h.push( random.next() );
+        } else {
+          values.push_back( random.next() );
+          if ( values.size() == batch ) {
+            h.pushBatch( values.begin(), values.end() );
+            values.clear();
+          }
+        }
+      }
+      h.pushBatch( values.begin(), values.end() );
+    } ) );
+  }
+  for ( size_t i = 0; i < threads; i++ ) {
+    producers[ i ].join();
+  }
+  h.close();
+  for ( size_t i = 0; i < threads; i++ ) {
+    consumers[ i ].join();
+    bench::consume( sums[ i ] );
+  }
+  double nanoseconds = timer.elapsedNanoseconds();
+  size_t operations = 2 * per_producer * threads;
+  bench::report( name, std::to_string( threads ) + "+" + std::to_string( threads ) + " threads", operations, nanoseconds / operations );
+}
+
+int main( int argc, const char * argv[] ) {
+  size_t elements = argc > 1 ? std::strtoull( argv[ 1 ], 0, 10 ) : 1000000;
+  size_t max_threads = argc > 2 ? std::strtoull( argv[ 2 ], 0, 10 ) : std::thread::hardware_concurrency();
+  if ( max_threads == 0 ) {
+    max_threads = 1;
+  }
+  for ( size_t threads = 1; threads <= max_threads; threads *= 2 ) {
+    runContention( "push/pop", elements, threads, 1 );
+    runContention( "pushBatch/popBatch 16", elements, threads, 16 );
+    runContention( "pushBatch/popBatch 256", elements, threads, 256 );
+  }
+  return 0;
+}
@@ -0,0 +1,158 @@
+/*
+ * Runs Dijkstra's shortest-path search on random graphs with integer edge
+ * weights, once with a MaxHeap of (negated distance, vertex) pairs and once
+ * with a RadixMaxHeap keyed by the negated distance. Both use lazy
+ * deletion: a vertex is pushed again when its distance improves, and stale
+ * entries are skipped when they are extracted. Times are per edge.
+ *
+ * Usage: dijkstra_bench [vertices]
+ */
+
+#include "BenchUtil.h"
+#include "MaxHeap.h"
+#include "RadixMaxHeap.h"
+#include <cstdlib>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * A directed graph in compressed sparse row form.
+ */
+struct Graph {
+  std::vector<size_t> offsets;
+  std::vector<uint32_t> targets;
+  std::vector<int64_t> weights;
+
+  size_t vertexCount() const {
+    return offsets.size() - 1;
+  }
+};
+
+/**
+ * Builds a graph where every vertex has the specified number of edges to
+ * random vertices, with weights in [1, max_weight].
+ */
+Graph randomGraph( size_t vertices, size_t degree, uint64_t max_weight ) {
+  bench::Random random;
+  Graph graph;
+  graph.offsets.push_back( 0 );
+  for ( size_t v = 0; v < vertices; v++ ) {
+    for ( size_t e = 0; e < degree; e++ ) {
+      graph.targets.push_back( static_cast<uint32_t>( random.next() % vertices ) );
+      graph.weights.push_back( static_cast<int64_t>( 1 + random.next() % max_weight ) );
+    }
+    graph.offsets.push_back( graph.targets.size() );
+  }
+  return graph;
+}
+
+/**
+ * Builds a square grid graph with edges in both directions between
+ * neighbouring vertices, with weights in [1, max_weight].
+ */
+Graph gridGraph( size_t vertices, uint64_t max_weight ) {
+  bench::Random random;
+  size_t side = 1;
+  while ( ( side + 1 ) * ( side + 1 ) <= vertices ) {
+    side++;
+  }
+  Graph graph;
+  graph.offsets.push_back( 0 );
+  for ( size_t row = 0; row < side; row++ ) {
+    for ( size_t column = 0; column < side; column++ ) {
+      size_t v = row * side + column;
+      size_t neighbours[ 4 ] = { v - side, v + side, v - 1, v + 1 };
+      bool present[ 4 ] = { row > 0, row + 1 < side, column > 0, column + 1 < side };
+      for ( size_t k = 0; k < 4; k++ ) {
+        if ( present[ k ] ) {
+          graph.targets.push_back( static_cast<uint32_t>( neighbours[ k ] ) );
+          graph.weights.push_back( static_cast<int64_t>( 1 + random.next() % max_weight ) );
+        }
+      }
+      graph.offsets.push_back( graph.targets.size() );
+    }
+  }
+  return graph;
+}
+
+const int64_t UNREACHED = std::numeric_limits<int64_t>::max();
+
+int64_t dijkstraMaxHeap( const Graph& graph ) {
+  std::vector<int64_t> distance( graph.vertexCount(), UNREACHED );
+  MaxHeap<std::pair<int64_t, uint32_t> > queue;
+  distance[ 0 ] = 0;
+  queue.maxHeapInsert( std::make_pair( int64_t( 0 ), uint32_t( 0 ) ) );
+  while ( !queue.empty() ) {
+    std::pair<int64_t, uint32_t> top = queue.heapExtractMax();
+    uint32_t v = top.second;
+    if ( -top.first != distance[ v ] ) {
+      continue;
+    }
+    for ( size_t e = graph.offsets[ v ]; e < graph.offsets[ v + 1 ]; e++ ) {
+      int64_t candidate = distance[ v ] + graph.weights[ e ];
+      uint32_t w = graph.targets[ e ];
+      if ( candidate < distance[ w ] ) {
+        distance[ w ] = candidate;
+        queue.maxHeapInsert( std::make_pair( -candidate, w ) );
+      }
+    }
+  }
+  int64_t sum = 0;
+  for ( size_t v = 0; v < distance.size(); v++ ) {
+    sum += distance[ v ] == UNREACHED ? 0 : distance[ v ];
+  }
+  return sum;
+}
+
+int64_t dijkstraRadix( const Graph& graph ) {
+  std::vector<int64_t> distance( graph.vertexCount(), UNREACHED );
+  RadixMaxHeap<int64_t, uint32_t> queue;
+  distance[ 0 ] = 0;
+  queue.maxHeapInsert( 0, 0 );
+  while ( !queue.empty() ) {
+    RadixMaxHeap<int64_t, uint32_t>::Element top = queue.heapExtractMax();
+    uint32_t v = top.second;
+    if ( -top.first != distance[ v ] ) {
+      continue;
+    }
+    for ( size_t e = graph.offsets[ v ]; e < graph.offsets[ v + 1 ]; e++ ) {
+      int64_t candidate = distance[ v ] + graph.weights[ e ];
+      uint32_t w = graph.targets[ e ];
+      if ( candidate < distance[ w ] ) {
+        distance[ w ] = candidate;
+        queue.maxHeapInsert( -candidate, w );
+      }
+    }
+  }
+  int64_t sum = 0;
+  for ( size_t v = 0; v < distance.size(); v++ ) {
+    sum += distance[ v ] == UNREACHED ? 0 : distance[ v ];
+  }
+  return sum;
+}
+
+void run( const std::string& type, const Graph& graph ) {
+  size_t edges = graph.targets.size();
+  bench::Timer timer;
+  int64_t expected = dijkstraMaxHeap( graph );
+  double heap_nanoseconds = timer.elapsedNanoseconds();
+  timer.restart();
+  int64_t actual = dijkstraRadix( graph );
+  double radix_nanoseconds = timer.elapsedNanoseconds();
+  if ( actual != expected ) {
+    std::cout << "RadixMaxHeap distances differ from MaxHeap" << std::endl;
+  }
+  bench::consume( static_cast<uint64_t>( actual ) );
+  bench::report( "MaxHeap<pair>", type, graph.vertexCount(), heap_nanoseconds / edges );
+  bench::report( "RadixMaxHeap<int64_t>", type, graph.vertexCount(), radix_nanoseconds / edges );
+}
+
+int main( int argc, const char * argv[] ) {
+  size_t vertices = argc > 1 ? std::strtoull( argv[ 1 ], 0, 10 ) : 1000000;
+  run( "random w<=100", randomGraph( vertices, 8, 100 ) );
+  run( "random w<=1e9", randomGraph( vertices, 8, 1000000000 ) );
+  run( "grid w<=100", gridGraph( vertices, 100 ) );
+  return 0;
+}
@@ -0,0 +1,63 @@
+/*
+ * Inserts random keys into an ExternalMaxHeap with a fixed memory budget
+ * and then extracts them all, with the runs on local disk. The in-memory
+ * MaxHeap doing the same work is the baseline. Times are per element, for
+ * its insertion plus its extraction. The run files may be served from the
+ * page cache, so the times are a lower bound for a cold disk.
+ *
+ * Usage: external_bench [elements] [budget_bytes] [directory]
+ */
+
+#include "BenchUtil.h"
+#include "ExternalMaxHeap.h"
+#include "MaxHeap.h"
+#include <cstdlib>
+#include <string>
+
+template<typename T>
+void runMaxHeap( const std::string& type, size_t n ) {
+  bench::Random random;
+  bench::Timer timer;
+  MaxHeap<T> h;
+  for ( size_t i = 0; i < n; i++ ) {
+    h.maxHeapInsert( bench::makeValue<T>( random.next() ) );
+  }
+  uint64_t sum = 0;
+  while ( !h.empty() ) {
+    sum += bench::keyOf( h.heapExtractMax() );
+  }
+  double nanoseconds = timer.elapsedNanoseconds();
+  bench::consume( sum );
+  bench::report( "MaxHeap in memory", type, n, nanoseconds / n );
+}
+
+template<typename T>
+void runExternal( const std::string& type, size_t n, size_t budget, const std::string& directory ) {
+  bench::Random random;
+  bench::Timer timer;
+  ExternalMaxHeap<T> h( budget, directory );
+  for ( size_t i = 0; i < n; i++ ) {
+    h.maxHeapInsert( bench::makeValue<T>( random.next() ) );
+  }
+  size_t runs = h.getRunCount();
+  uint64_t sum = 0;
+  while ( !h.empty() ) {
+    sum += bench::keyOf( h.heapExtractMax() );
+  }
+  double nanoseconds = timer.elapsedNanoseconds();
+  bench::consume( sum );
+  bench::report( "ExternalMaxHeap", type, n, nanoseconds / n );
+  std::cout << "  " << runs << " runs, " << h.getBytesWritten() / ( 1 << 20 ) << " MiB written, "
+            << h.getBytesRead() / ( 1 << 20 ) << " MiB read, budget " << budget / ( 1 << 20 ) << " MiB" << std::endl;
+}
+
+int main( int argc, const char * argv[] ) {
+  size_t n = argc > 1 ? std::strtoull( argv[ 1 ], 0, 10 ) : 20000000;
+  size_t budget = argc > 2 ? std::strtoull( argv[ 2 ], 0, 10 ) : 64 << 20;
+  std::string directory = argc > 3 ? argv[ 3 ] : "/tmp";
+  runMaxHeap<uint64_t>( "uint64_t", n );
+  runExternal<uint64_t>( "uint64_t", n, budget, directory );
+  runMaxHeap<bench::Record<64> >( "64 bytes", n / 4 );
+  runExternal<bench::Record<64> >( "64 bytes", n / 4, budget, directory );
+  return 0;
+}
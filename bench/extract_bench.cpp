@@ -0,0 +1,86 @@
+/*
+ * Compares the TOP_DOWN and BOTTOM_UP extraction strategies of MaxHeap in
+ * comparisons per operation and time per operation, for heapExtractMax,
+ * heapSort and removeAt.
+ */
+
+#include "BenchUtil.h"
+#include "MaxHeap.h"
+#include <string>
+#include <vector>
+
+std::vector<bench::CountedKey> makeInput( size_t n ) {
+  bench::Random random;
+  std::vector<bench::CountedKey> input;
+  input.reserve( n );
+  for ( size_t i = 0; i < n; i++ ) {
+    input.push_back( bench::CountedKey( random.next() ) );
+  }
+  return input;
+}
+
+template<size_t Arity>
+void runExtract( const std::string& name, MaxHeapExtractionType type, size_t n ) {
+  MaxHeap<bench::CountedKey, Arity> h( makeInput( n ) );
+  h.setExtractionType( type );
+  bench::CountedKey::comparisons() = 0;
+  bench::Timer timer;
+  uint64_t checksum = 0;
+  while ( !h.empty() ) {
+    checksum += h.heapExtractMax().key;
+  }
+  double nanoseconds = timer.elapsedNanoseconds();
+  bench::consume( checksum );
+  bench::report( name + " extract", "Arity " + std::to_string( Arity ), n, nanoseconds / n );
+  std::cout << "  " << static_cast<double>( bench::CountedKey::comparisons() ) / n << " comparisons/op" << std::endl;
+}
+
+template<size_t Arity>
+void runSort( const std::string& name, MaxHeapExtractionType type, size_t n ) {
+  MaxHeap<bench::CountedKey, Arity> h( makeInput( n ) );
+  h.setExtractionType( type );
+  bench::CountedKey::comparisons() = 0;
+  bench::Timer timer;
+  std::vector<bench::CountedKey> sorted = h.heapSort();
+  double nanoseconds = timer.elapsedNanoseconds();
+  bench::consume( sorted.front().key );
+  bench::report( name + " heapSort", "Arity " + std::to_string( Arity ), n, nanoseconds / n );
+  std::cout << "  " << static_cast<double>( bench::CountedKey::comparisons() ) / n << " comparisons/element" << std::endl;
+}
+
+template<size_t Arity>
+void runRemoveAt( const std::string& name, MaxHeapExtractionType type, size_t n ) {
+  MaxHeap<bench::CountedKey, Arity> h( makeInput( n ) );
+  h.setExtractionType( type );
+  bench::Random random( 42 );
+  size_t removals = n / 2;
+  bench::CountedKey::comparisons() = 0;
+  bench::Timer timer;
+  uint64_t checksum = 0;
+  for ( size_t i = 0; i < removals; i++ ) {
+    checksum += h.removeAt( random.next() % h.getSize() ).key;
+  }
+  double nanoseconds = timer.elapsedNanoseconds();
+  bench::consume( checksum );
+  bench::report( name + " removeAt", "Arity " + std::to_string( Arity ), removals, nanoseconds / removals );
+  std::cout << "  " << static_cast<double>( bench::CountedKey::comparisons() ) / removals << " comparisons/op" << std::endl;
+}
+
+template<size_t Arity>
+void compare( size_t n ) {
+  runExtract<Arity>( "TOP_DOWN", TOP_DOWN, n );
+  runExtract<Arity>( "BOTTOM_UP", BOTTOM_UP, n );
+  runSort<Arity>( "TOP_DOWN", TOP_DOWN, n );
+  runSort<Arity>( "BOTTOM_UP", BOTTOM_UP, n );
+  runRemoveAt<Arity>( "TOP_DOWN", TOP_DOWN, n );
+  runRemoveAt<Arity>( "BOTTOM_UP", BOTTOM_UP, n );
+}
+
+int main( int argc, const char * argv[] ) {
+  size_t sizes[2] = { 10000, 1000000 };
+  for ( size_t i = 0; i < 2; i++ ) {
+    compare<2>( sizes[ i ] );
+    compare<4>( sizes[ i ] );
+  }
+  return 0;
+}
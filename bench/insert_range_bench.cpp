@@ -0,0 +1,72 @@
+/*
+ * Compares inserting batches of elements into a large max-heap one by one
+ * with maxHeapInsert() against a single insertRange() call. Batches hold
+ * either random keys, or ascending keys larger than any key in the heap,
+ * which is the worst case for sifting up one by one.
+ *
+ * Usage: insert_range_bench [heap_size]
+ */
+
+#include "BenchUtil.h"
+#include "MaxHeap.h"
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+std::vector<uint64_t> makeInput( size_t n, uint64_t seed ) {
+  bench::Random random( seed );
+  std::vector<uint64_t> input;
+  input.reserve( n );
+  for ( size_t i = 0; i < n; i++ ) {
+    input.push_back( random.next() );
+  }
+  return input;
+}
+
+void runBatch( size_t heap_size, size_t batch_size, bool ascending ) {
+  std::vector<uint64_t> batch = makeInput( batch_size, 7 );
+  std::string type = ( ascending ? "ascending " : "random " ) + std::to_string( batch_size );
+  if ( ascending ) {
+    for ( size_t i = 0; i < batch_size; i++ ) {
+      batch[ i ] = UINT64_MAX - batch_size + i;
+    }
+  }
+
+  MaxHeap<bench::CountedKey> loop_heap;
+  MaxHeap<bench::CountedKey> range_heap;
+  for ( uint64_t v : makeInput( heap_size, 1 ) ) {
+    loop_heap.emplace( v );
+    range_heap.emplace( v );
+  }
+
+  std::vector<bench::CountedKey> keys;
+  for ( uint64_t v : batch ) {
+    keys.push_back( bench::CountedKey( v ) );
+  }
+
+  bench::CountedKey::comparisons() = 0;
+  bench::Timer timer;
+  for ( size_t i = 0; i < keys.size(); i++ ) {
+    loop_heap.maxHeapInsert( keys[ i ] );
+  }
+  double nanoseconds = timer.elapsedNanoseconds();
+  bench::report( "maxHeapInsert", type, heap_size, nanoseconds / batch_size );
+  std::cout << "  " << static_cast<double>( bench::CountedKey::comparisons() ) / batch_size << " comparisons/element" << std::endl;
+
+  bench::CountedKey::comparisons() = 0;
+  timer.restart();
+  range_heap.insertRange( keys.begin(), keys.end() );
+  nanoseconds = timer.elapsedNanoseconds();
+  bench::report( "insertRange", type, heap_size, nanoseconds / batch_size );
+  std::cout << "  " << static_cast<double>( bench::CountedKey::comparisons() ) / batch_size << " comparisons/element" << std::endl;
+  bench::consume( loop_heap.heapMaximum().key + range_heap.heapMaximum().key );
+}
+
+int main( int argc, const char * argv[] ) {
+  size_t heap_size = argc > 1 ? std::strtoull( argv[ 1 ], 0, 10 ) : 1000000;
+  for ( size_t batch_size = 10; batch_size <= 1000000; batch_size *= 10 ) {
+    runBatch( heap_size, batch_size, false );
+    runBatch( heap_size, batch_size, true );
+  }
+  return 0;
+}
@@ -0,0 +1,70 @@
+/*
+ * Compares KeyedMaxHeap, which sifts only keys and slot numbers, with a
+ * MaxHeap of records that carry their payload, for records of increasing
+ * size. Each operation is a hold: the maximum is extracted and a random
+ * record is inserted.
+ *
+ * Usage: keyed_bench [heap_size]
+ */
+
+#include "BenchUtil.h"
+#include "KeyedMaxHeap.h"
+#include "MaxHeap.h"
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+template<size_t Bytes>
+void runRecords( size_t n, size_t operations ) {
+  bench::Random random;
+  std::vector<bench::Record<Bytes> > input;
+  for ( size_t i = 0; i < n; i++ ) {
+    input.push_back( bench::Record<Bytes>( random.next() ) );
+  }
+  MaxHeap<bench::Record<Bytes> > h( std::move( input ), ITERATIVE );
+  uint64_t sum = 0;
+  bench::Timer timer;
+  for ( size_t i = 0; i < operations; i++ ) {
+    sum += h.heapExtractMax().key;
+    h.maxHeapInsert( bench::Record<Bytes>( random.next() ) );
+  }
+  double nanoseconds = timer.elapsedNanoseconds();
+  bench::consume( sum );
+  bench::report( "MaxHeap<Record>", std::to_string( Bytes ) + " bytes", n, nanoseconds / operations );
+}
+
+template<size_t Bytes>
+void runKeyed( size_t n, size_t operations ) {
+  bench::Random random;
+  KeyedMaxHeap<uint64_t, bench::Record<Bytes> > h;
+  h.reserve( n );
+  for ( size_t i = 0; i < n; i++ ) {
+    uint64_t key = random.next();
+    h.maxHeapInsert( key, bench::Record<Bytes>( key ) );
+  }
+  uint64_t sum = 0;
+  bench::Timer timer;
+  for ( size_t i = 0; i < operations; i++ ) {
+    sum += h.heapExtractMax().second.key;
+    uint64_t key = random.next();
+    h.maxHeapInsert( std::move( key ), bench::Record<Bytes>( key ) );
+  }
+  double nanoseconds = timer.elapsedNanoseconds();
+  bench::consume( sum );
+  bench::report( "KeyedMaxHeap", std::to_string( Bytes ) + " bytes", n, nanoseconds / operations );
+}
+
+template<size_t Bytes>
+void compare( size_t n ) {
+  runRecords<Bytes>( n, 1000000 );
+  runKeyed<Bytes>( n, 1000000 );
+}
+
+int main( int argc, const char * argv[] ) {
+  size_t n = argc > 1 ? std::strtoull( argv[ 1 ], 0, 10 ) : 100000;
+  compare<16>( n );
+  compare<64>( n );
+  compare<256>( n );
+  compare<1024>( n );
+  return 0;
+}
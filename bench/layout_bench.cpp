@@ -0,0 +1,52 @@
+/*
+ * Compares the implicit layout of MaxHeap with the page-blocked BHeapLayout,
+ * for heaps from a few kilobytes, which fit in L1, to far beyond the
+ * last-level cache. Each operation is a hold: the maximum is extracted and
+ * a random key is inserted, so the heap keeps its size and every operation
+ * walks a full root-to-leaf path.
+ *
+ * Usage: layout_bench [max_size]
+ */
+
+#include "BenchUtil.h"
+#include "MaxHeap.h"
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+template<size_t Arity, typename Layout>
+void runHold( const std::string& name, size_t n ) {
+  bench::Random random;
+  std::vector<uint64_t> input;
+  input.reserve( n );
+  for ( size_t i = 0; i < n; i++ ) {
+    input.push_back( random.next() );
+  }
+  MaxHeap<uint64_t, Arity, Layout> h( std::move( input ), ITERATIVE );
+  size_t operations = std::max<size_t>( 1000000, n );
+  uint64_t sum = 0;
+  bench::Timer timer;
+  for ( size_t i = 0; i < operations; i++ ) {
+    sum += h.heapExtractMax();
+    h.maxHeapInsert( random.next() );
+  }
+  double nanoseconds = timer.elapsedNanoseconds();
+  bench::consume( sum );
+  bench::report( name, "Arity " + std::to_string( Arity ), n, nanoseconds / operations );
+}
+
+template<size_t Arity>
+void compareLayouts( size_t n ) {
+  runHold<Arity, ImplicitLayout>( "implicit", n );
+  runHold<Arity, BHeapLayout<64> >( "B-heap 64 B pages", n );
+  runHold<Arity, BHeapLayout<4096> >( "B-heap 4 KiB pages", n );
+}
+
+int main( int argc, const char * argv[] ) {
+  size_t max_size = argc > 1 ? std::strtoull( argv[ 1 ], 0, 10 ) : ( 1 << 26 );
+  for ( size_t n = 1 << 10; n <= max_size; n *= 8 ) {
+    compareLayouts<2>( n );
+    compareLayouts<4>( n );
+  }
+  return 0;
+}
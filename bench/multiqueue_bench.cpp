@@ -0,0 +1,150 @@
+/*
+ * Compares the relaxed MultiQueue with the strict ConcurrentMaxHeap. Each
+ * thread alternates push and pop on a prefilled queue, and the time per
+ * operation is reported for growing numbers of threads. The quality of the
+ * relaxation is reported as the rank error of the popped elements: the
+ * number of larger elements still in the queue when an element is popped,
+ * measured with one thread for several numbers of shards.
+ *
+ * Usage: multiqueue_bench [operations [max_threads]]
+ */
+
+#include "BenchUtil.h"
+#include "ConcurrentMaxHeap.h"
+#include "MultiQueue.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+const size_t PREFILL = 100000;
+
+template<typename Queue>
+void prefill( Queue& q ) {
+  bench::Random random;
+  for ( size_t i = 0; i < PREFILL; i++ ) {
+    q.push( random.next() );
+  }
+}
+
+template<typename Queue>
+void runThroughput( const std::string& name, Queue& q, size_t operations, size_t threads ) {
+  prefill( q );
+  size_t per_thread = operations / threads;
+  std::vector<std::thread> workers;
+  bench::Timer timer;
+  for ( size_t w = 0; w < threads; w++ ) {
+    workers.push_back( std::thread( [&, w]() {
+      bench::Random random( w + 1 );
+      uint64_t sum = 0;
+      uint64_t value;
+      for ( size_t i = 0; i < per_thread; i += 2 ) {
+        q.push( random.next() );
+        if ( q.tryPop( value ) ) {
+          sum += value;
+        }
+      }
+      bench::consume( sum );
+    } ) );
+  }
+  for ( size_t i = 0; i < threads; i++ ) {
+    workers[ i ].join();
+  }
+  double nanoseconds = timer.elapsedNanoseconds();
+  bench::report( name, std::to_string( threads ) + " threads", per_thread * threads, nanoseconds / ( per_thread * threads ) );
+}
+
+/**
+ * Counts the elements present in the queue, by value, in a Fenwick tree,
+ * so the rank of a popped element is found in O(log n).
+ */
+class RankCounter {
+
+ public:
+
+  explicit RankCounter( size_t n ) : tree( n + 1, 0 ), total( 0 ) {
+  }
+
+  void add( size_t value, int delta ) {
+    total += delta;
+    for ( size_t i = value + 1; i < tree.size(); i += i & ( 0 - i ) ) {
+      tree[ i ] += delta;
+    }
+  }
+
+  size_t countGreater( size_t value ) const {
+    size_t not_greater = 0;
+    for ( size_t i = value + 1; i > 0; i -= i & ( 0 - i ) ) {
+      not_greater += tree[ i ];
+    }
+    return total - not_greater;
+  }
+
+ private:
+  std::vector<long> tree;
+  long total;
+
+};
+
+void runRankError( size_t shards, size_t n ) {
+  MultiQueue<size_t> q( shards, 1 );
+  RankCounter present( n );
+  bench::Random random;
+  std::vector<size_t> values( n );
+  for ( size_t i = 0; i < n; i++ ) {
+    values[ i ] = i;
+  }
+  for ( size_t i = n - 1; i > 0; i-- ) {
+    std::swap( values[ i ], values[ random.next() % ( i + 1 ) ] );
+  }
+  size_t next = 0;
+  for ( ; next < n / 2; next++ ) {
+    q.push( values[ next ] );
+    present.add( values[ next ], 1 );
+  }
+  double total_rank_error = 0;
+  size_t max_rank_error = 0;
+  size_t pops = 0;
+  size_t value;
+  while ( q.tryPop( value ) ) {
+    size_t rank_error = present.countGreater( value );
+    total_rank_error += rank_error;
+    max_rank_error = std::max( max_rank_error, rank_error );
+    present.add( value, -1 );
+    pops++;
+    if ( next < n ) {
+      q.push( values[ next ] );
+      present.add( values[ next ], 1 );
+      next++;
+    }
+  }
+  std::cout << std::left << std::setw( 28 ) << "rank error"
+            << std::setw( 18 ) << ( std::to_string( shards ) + " shards" )
+            << std::right << std::setw( 10 ) << n
+            << std::setw( 12 ) << std::fixed << std::setprecision( 1 ) << total_rank_error / pops << " mean"
+            << std::setw( 10 ) << max_rank_error << " max"
+            << std::endl;
+}
+
+int main( int argc, const char * argv[] ) {
+  size_t operations = argc > 1 ? std::strtoull( argv[ 1 ], 0, 10 ) : 2000000;
+  size_t max_threads = argc > 2 ? std::strtoull( argv[ 2 ], 0, 10 ) : std::thread::hardware_concurrency();
+  if ( max_threads == 0 ) {
+    max_threads = 1;
+  }
+  for ( size_t threads = 1; threads <= max_threads; threads *= 2 ) {
+    ConcurrentMaxHeap<uint64_t> strict;
+    runThroughput( "ConcurrentMaxHeap", strict, operations, threads );
+    MultiQueue<uint64_t> relaxed( threads, 2 );
+    runThroughput( "MultiQueue c=2", relaxed, operations, threads );
+    MultiQueue<uint64_t> relaxed4( threads, 4 );
+    runThroughput( "MultiQueue c=4", relaxed4, operations, threads );
+  }
+  for ( size_t shards = 1; shards <= 64; shards *= 4 ) {
+    runRankError( shards, 1000000 );
+  }
+  return 0;
+}
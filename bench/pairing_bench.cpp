@@ -0,0 +1,113 @@
+/*
+ * Compares PairingMaxHeap with MaxHeap for hold operations, where the
+ * maximum is extracted and a random key is inserted, and for merging a
+ * number of partition queues into one, which MaxHeap does with
+ * insertRange and PairingMaxHeap with meld.
+ *
+ * Usage: pairing_bench [heap_size]
+ */
+
+#include "BenchUtil.h"
+#include "MaxHeap.h"
+#include "PairingMaxHeap.h"
+#include <cstdlib>
+#include <vector>
+
+const size_t PARTITIONS = 16;
+
+void holdMaxHeap( size_t n, size_t operations ) {
+  bench::Random random;
+  MaxHeap<uint64_t> h;
+  for ( size_t i = 0; i < n; i++ ) {
+    h.maxHeapInsert( random.next() );
+  }
+  uint64_t sum = 0;
+  bench::Timer timer;
+  for ( size_t i = 0; i < operations; i++ ) {
+    sum += h.heapExtractMax();
+    h.maxHeapInsert( random.next() );
+  }
+  double nanoseconds = timer.elapsedNanoseconds();
+  bench::consume( sum );
+  bench::report( "MaxHeap", "hold", n, nanoseconds / operations );
+}
+
+void holdPairing( size_t n, size_t operations ) {
+  bench::Random random;
+  PairingMaxHeap<uint64_t> h;
+  for ( size_t i = 0; i < n; i++ ) {
+    h.maxHeapInsert( random.next() );
+  }
+  uint64_t sum = 0;
+  bench::Timer timer;
+  for ( size_t i = 0; i < operations; i++ ) {
+    sum += h.heapExtractMax();
+    h.maxHeapInsert( random.next() );
+  }
+  double nanoseconds = timer.elapsedNanoseconds();
+  bench::consume( sum );
+  bench::report( "PairingMaxHeap", "hold", n, nanoseconds / operations );
+}
+
+/*
+ * Every round merges PARTITIONS queues of n / PARTITIONS keys into one and
+ * extracts a key from the result, so that the pairing heap pays for
+ * consolidating its root list. Only the merge and the extraction are
+ * timed.
+ */
+void mergeMaxHeap( size_t n, size_t rounds ) {
+  bench::Random random;
+  double nanoseconds = 0;
+  uint64_t sum = 0;
+  for ( size_t round = 0; round < rounds; round++ ) {
+    std::vector<MaxHeap<uint64_t> > parts( PARTITIONS );
+    std::vector<std::vector<uint64_t> > contents( PARTITIONS );
+    for ( size_t p = 0; p < PARTITIONS; p++ ) {
+      for ( size_t i = 0; i < n / PARTITIONS; i++ ) {
+        contents[ p ].push_back( random.next() );
+        parts[ p ].maxHeapInsert( contents[ p ].back() );
+      }
+    }
+    bench::Timer timer;
+    MaxHeap<uint64_t> merged( std::move( parts[ 0 ] ) );
+    for ( size_t p = 1; p < PARTITIONS; p++ ) {
+      merged.insertRange( contents[ p ].begin(), contents[ p ].end() );
+    }
+    sum += merged.heapExtractMax();
+    nanoseconds += timer.elapsedNanoseconds();
+  }
+  bench::consume( sum );
+  bench::report( "MaxHeap insertRange", "merge 16", n, nanoseconds / rounds );
+}
+
+void mergePairing( size_t n, size_t rounds ) {
+  bench::Random random;
+  double nanoseconds = 0;
+  uint64_t sum = 0;
+  for ( size_t round = 0; round < rounds; round++ ) {
+    std::vector<PairingMaxHeap<uint64_t> > parts( PARTITIONS );
+    for ( size_t p = 0; p < PARTITIONS; p++ ) {
+      for ( size_t i = 0; i < n / PARTITIONS; i++ ) {
+        parts[ p ].maxHeapInsert( random.next() );
+      }
+    }
+    bench::Timer timer;
+    PairingMaxHeap<uint64_t> merged( std::move( parts[ 0 ] ) );
+    for ( size_t p = 1; p < PARTITIONS; p++ ) {
+      merged.meld( parts[ p ] );
+    }
+    sum += merged.heapExtractMax();
+    nanoseconds += timer.elapsedNanoseconds();
+  }
+  bench::consume( sum );
+  bench::report( "PairingMaxHeap meld", "merge 16", n, nanoseconds / rounds );
+}
+
+int main( int argc, const char * argv[] ) {
+  size_t n = argc > 1 ? std::strtoull( argv[ 1 ], 0, 10 ) : 100000;
+  holdMaxHeap( n, 1000000 );
+  holdPairing( n, 1000000 );
+  mergeMaxHeap( n, 20 );
+  mergePairing( n, 20 );
+  return 0;
+}
@@ -0,0 +1,81 @@
+/*
+ * Compares sending a max-heap through an in-memory stream as text with
+ * operator <<, and in the binary format of serializeMaxHeap(). The text
+ * receiver has to parse the elements and rebuild the heap; the binary one
+ * adopts the elements in heap order. Times are per element of the heap.
+ *
+ * Usage: serialize_bench [elements]
+ */
+
+#include "BenchUtil.h"
+#include "MaxHeap.h"
+#include "MaxHeapSerialization.h"
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+int main( int argc, const char * argv[] ) {
+  size_t n = argc > 1 ? std::strtoull( argv[ 1 ], 0, 10 ) : 2000000;
+
+  bench::Random random;
+  std::vector<int> keys;
+  keys.reserve( n );
+  for ( size_t i = 0; i < n; i++ ) {
+    keys.push_back( static_cast<int>( random.next() ) );
+  }
+  MaxHeap<int> original( keys, ITERATIVE );
+
+  bench::Timer timer;
+  std::string text;
+  {
+    std::ostringstream out;
+    for ( size_t i = 0; i < n; i++ ) {
+      out << original.at( i ) << ' ';
+    }
+    text = out.str();
+  }
+  bench::report( "text write", "int", n, timer.elapsedNanoseconds() / n );
+
+  timer.restart();
+  std::vector<int> parsed;
+  parsed.reserve( n );
+  {
+    std::istringstream in( text );
+    int key;
+    while ( in >> key ) {
+      parsed.push_back( key );
+    }
+  }
+  MaxHeap<int> rebuilt( std::move( parsed ), ITERATIVE );
+  bench::report( "text read + rebuild", "int", n, timer.elapsedNanoseconds() / n );
+
+  timer.restart();
+  std::string binary;
+  {
+    std::ostringstream out;
+    serializeMaxHeap( original, out );
+    binary = out.str();
+  }
+  bench::report( "serialize", "int", n, timer.elapsedNanoseconds() / n );
+
+  timer.restart();
+  MaxHeap<int> adopted;
+  {
+    std::istringstream in( binary );
+    deserializeMaxHeap( in, adopted );
+  }
+  bench::report( "deserialize stream", "int", n, timer.elapsedNanoseconds() / n );
+
+  timer.restart();
+  MaxHeap<int> fed;
+  deserializeMaxHeap( binary.data(), binary.size(), fed );
+  bench::report( "deserialize buffer", "int", n, timer.elapsedNanoseconds() / n );
+
+  if ( rebuilt.heapMaximum() != original.heapMaximum() || !( adopted == original ) || !( fed == original ) ) {
+    std::cout << "Received heaps disagree with the original" << std::endl;
+  }
+  std::cout << "text " << text.size() << " bytes, binary " << binary.size() << " bytes" << std::endl;
+  return 0;
+}
@@ -0,0 +1,91 @@
+/*
+ * Compares the hole-based sift-up/sift-down used by MaxHeap with the
+ * heapSwap based sifting it replaced, for a small and a large element type.
+ */
+
+#include "BenchUtil.h"
+#include "MaxHeap.h"
+#include <utility>
+#include <vector>
+
+/**
+ * Reference binary max-heap sifting elements with heapSwap chains, i.e.
+ * three element moves per level.
+ */
+template<typename T>
+class SwapMaxHeap {
+
+ public:
+
+  void maxHeapInsert( const T& key ) {
+    heap.push_back( key );
+    size_t index = heap.size() - 1;
+    while ( index > 0 && heap[ ( index - 1 ) / 2 ] < heap[ index ] ) {
+      std::swap( heap[ index ], heap[ ( index - 1 ) / 2 ] );
+      index = ( index - 1 ) / 2;
+    }
+  }
+
+  T heapExtractMax() {
+    std::swap( heap.front(), heap.back() );
+    T result = heap.back();
+    heap.pop_back();
+    size_t index = 0;
+    size_t size = heap.size();
+    while ( 2 * index + 1 < size ) {
+      size_t largest = 2 * index + 1;
+      if ( largest + 1 < size && heap[ largest ] < heap[ largest + 1 ] ) {
+        largest++;
+      }
+      if ( !( heap[ index ] < heap[ largest ] ) ) {
+        break;
+      }
+      std::swap( heap[ index ], heap[ largest ] );
+      index = largest;
+    }
+    return result;
+  }
+
+ private:
+  std::vector<T> heap;
+
+};
+
+template<typename Heap, typename T>
+double runInsertExtract( size_t n ) {
+  bench::Random random;
+  std::vector<T> input;
+  input.reserve( n );
+  for ( size_t i = 0; i < n; i++ ) {
+    input.push_back( bench::makeValue<T>( random.next() ) );
+  }
+  bench::Timer timer;
+  Heap h;
+  for ( size_t i = 0; i < n; i++ ) {
+    h.maxHeapInsert( input[ i ] );
+  }
+  uint64_t checksum = 0;
+  for ( size_t i = 0; i < n; i++ ) {
+    checksum += bench::keyOf( h.heapExtractMax() );
+  }
+  double nanoseconds = timer.elapsedNanoseconds();
+  bench::consume( checksum );
+  return nanoseconds / ( 2.0 * n );
+}
+
+template<typename T>
+void compare( const std::string& type, size_t n ) {
+  bench::report( "insert+extract heapSwap", type, n, runInsertExtract<SwapMaxHeap<T>, T>( n ) );
+  bench::report( "insert+extract hole", type, n, runInsertExtract<MaxHeap<T>, T>( n ) );
+}
+
+int main( int argc, const char * argv[] ) {
+  size_t sizes[3] = { 1000, 100000, 1000000 };
+  for ( size_t i = 0; i < 3; i++ ) {
+    compare<int>( "int", sizes[ i ] );
+  }
+  for ( size_t i = 0; i < 2; i++ ) {
+    compare<bench::Record<200> >( "Record<200>", sizes[ i ] );
+  }
+  return 0;
+}
@@ -0,0 +1,87 @@
+/*
+ * Compares the SIMD selection of the largest child with the scalar loop,
+ * for d-ary max-heaps of arithmetic keys. The scalar loop is measured with
+ * a key wrapping the same value in a struct, which MaxHeap does not
+ * vectorize. Each operation is a hold: the maximum is extracted and a
+ * random key is inserted. MAXHEAP_SIMD_ALWAYS is defined so that every
+ * kernel is measured, including those MaxHeap does not use by default.
+ *
+ * Usage: simd_bench [heap_size]
+ */
+
+#define MAXHEAP_SIMD_ALWAYS
+
+#include "BenchUtil.h"
+#include "MaxHeap.h"
+#include "MaxHeapSimd.h"
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+/**
+ * A key of type T hidden in a struct, which keeps MaxHeap on its scalar
+ * child selection.
+ */
+template<typename T>
+struct ScalarKey {
+  T value;
+
+  explicit ScalarKey( T v = T() ) : value( v ) {
+  }
+
+  friend bool operator < ( const ScalarKey& lhs, const ScalarKey& rhs ) {
+    return lhs.value < rhs.value;
+  }
+};
+
+template<typename T>
+T valueOf( T key ) {
+  return key;
+}
+
+template<typename T>
+T valueOf( const ScalarKey<T>& key ) {
+  return key.value;
+}
+
+template<typename Key, typename T, size_t Arity>
+void runHold( const std::string& name, size_t n ) {
+  bench::Random random;
+  std::vector<Key> input;
+  input.reserve( n );
+  for ( size_t i = 0; i < n; i++ ) {
+    input.push_back( Key( static_cast<T>( random.next() >> 8 ) ) );
+  }
+  MaxHeap<Key, Arity> h( std::move( input ), ITERATIVE );
+  size_t operations = 2000000;
+  double sum = 0;
+  bench::Timer timer;
+  for ( size_t i = 0; i < operations; i++ ) {
+    sum += static_cast<double>( valueOf( h.heapExtractMax() ) );
+    h.maxHeapInsert( Key( static_cast<T>( random.next() >> 8 ) ) );
+  }
+  double nanoseconds = timer.elapsedNanoseconds();
+  bench::consume( static_cast<uint64_t>( sum ) );
+  bench::report( name, "Arity " + std::to_string( Arity ), n, nanoseconds / operations );
+}
+
+template<typename T, size_t Arity>
+void compare( const std::string& type, size_t n ) {
+  runHold<T, T, Arity>( type + " SIMD", n );
+  runHold<ScalarKey<T>, T, Arity>( type + " scalar", n );
+}
+
+int main( int argc, const char * argv[] ) {
+  size_t n = argc > 1 ? std::strtoull( argv[ 1 ], 0, 10 ) : 1000000;
+  std::cout << "SSE4.1 " << ( SimdMaxChild<int32_t, 4>::available() ? "yes" : "no" )
+            << ", AVX2 " << ( SimdMaxChild<int64_t, 4>::available() ? "yes" : "no" ) << std::endl;
+  compare<int32_t, 4>( "int32_t", n );
+  compare<int32_t, 8>( "int32_t", n );
+  compare<int32_t, 16>( "int32_t", n );
+  compare<float, 8>( "float", n );
+  compare<int64_t, 4>( "int64_t", n );
+  compare<int64_t, 8>( "int64_t", n );
+  compare<uint64_t, 8>( "uint64_t", n );
+  compare<double, 8>( "double", n );
+  return 0;
+}
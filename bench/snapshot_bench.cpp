@@ -0,0 +1,76 @@
+/*
+ * Compares two ways of getting a large max-heap back after a restart:
+ * reading the records from a file and rebuilding the heap, or mapping a
+ * snapshot saved with saveMaxHeapSnapshot() through MappedMaxHeap, with
+ * and without the integrity check. The file may be served from the page
+ * cache, so the times are a lower bound for a cold disk. Times are per
+ * element of the heap.
+ *
+ * Usage: snapshot_bench [elements] [directory]
+ */
+
+#include "BenchUtil.h"
+#include "MappedMaxHeap.h"
+#include "MaxHeap.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+typedef bench::Record<16> Entry;
+
+int main( int argc, const char * argv[] ) {
+  size_t n = argc > 1 ? std::strtoull( argv[ 1 ], 0, 10 ) : 20000000;
+  std::string directory = argc > 2 ? argv[ 2 ] : "/tmp";
+  std::string records_path = directory + "/snapshot_bench.records";
+  std::string snapshot_path = directory + "/snapshot_bench.snapshot";
+
+  bench::Random random;
+  std::vector<Entry> records;
+  records.reserve( n );
+  for ( size_t i = 0; i < n; i++ ) {
+    records.push_back( Entry( random.next() ) );
+  }
+  std::FILE* file = std::fopen( records_path.c_str(), "wb" );
+  std::fwrite( records.data(), sizeof( Entry ), records.size(), file );
+  std::fclose( file );
+
+  MaxHeap<Entry> original( records, ITERATIVE );
+  std::vector<Entry>().swap( records );
+  bench::Timer timer;
+  saveMaxHeapSnapshot( original, snapshot_path );
+  bench::report( "saveMaxHeapSnapshot", "16 bytes", n, timer.elapsedNanoseconds() / n );
+  uint64_t expected = original.heapMaximum().key;
+  original = MaxHeap<Entry>();
+
+  timer.restart();
+  std::vector<Entry> loaded( n );
+  file = std::fopen( records_path.c_str(), "rb" );
+  size_t read = std::fread( loaded.data(), sizeof( Entry ), n, file );
+  std::fclose( file );
+  MaxHeap<Entry> rebuilt( std::move( loaded ), RECURSIVE );
+  bool correct = rebuilt.heapMaximum().key == expected;
+  bench::report( "read records + rebuild", "16 bytes", read, timer.elapsedNanoseconds() / n );
+  rebuilt = MaxHeap<Entry>();
+
+  timer.restart();
+  {
+    MappedMaxHeap<Entry> mapped( snapshot_path );
+    correct = correct && mapped.heapMaximum().key == expected;
+  }
+  bench::report( "MappedMaxHeap verified", "16 bytes", n, timer.elapsedNanoseconds() / n );
+
+  timer.restart();
+  {
+    MappedMaxHeap<Entry> mapped( snapshot_path, OPEN_EXISTING, false );
+    correct = correct && mapped.heapMaximum().key == expected;
+  }
+  bench::report( "MappedMaxHeap unverified", "16 bytes", n, timer.elapsedNanoseconds() / n );
+
+  if ( !correct ) {
+    std::cout << "Restored heaps disagree on the maximum" << std::endl;
+  }
+  std::remove( records_path.c_str() );
+  std::remove( snapshot_path.c_str() );
+  return 0;
+}
@@ -0,0 +1,418 @@
+/*
+ * Benchmark suite for MaxHeap against the standard library. Every workload
+ * is run on MaxHeap and, where the standard library has an equivalent, on
+ * std::priority_queue and the std::make_heap family of algorithms:
+ *
+ *   build     heapify n elements (MaxHeap with both creation types)
+ *   insert    insert n elements one by one into an empty heap
+ *   extract   extract all n elements of a heap (MaxHeap with both
+ *             extraction types)
+ *   removeAt  remove n / 2 elements at random positions (MaxHeap only)
+ *   sort      sort the n elements of a heap
+ *   mixed     n random inserts and extracts on a heap of n elements
+ *
+ * for sizes from 10^3 up to a limit, and for int and records of 16, 64 and
+ * 256 bytes. Each line reports the time, the number of comparisons and the
+ * number of heap allocations per operation. Time and allocations are taken
+ * from a run on the plain type; comparisons from a second run on the same
+ * input wrapped in bench::Counted, so counting does not distort the time.
+ * Sizes whose input would not fit in the memory budget are skipped.
+ *
+ * Usage: suite_bench [max elements] [memory budget in MB]
+ */
+
+#include "BenchUtil.h"
+#include "MaxHeap.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <queue>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::atomic<uint64_t> allocation_count( 0 );
+
+}
+
+// The replacements are kept out of line, so that GCC does not pair an
+// inlined std::free() with a call to the global operator new.
+#if defined( __GNUC__ )
+#define SUITE_BENCH_NOINLINE __attribute__(( noinline ))
+#else
+#define SUITE_BENCH_NOINLINE
+#endif
+
+SUITE_BENCH_NOINLINE void* operator new( size_t bytes ) {
+  allocation_count.fetch_add( 1, std::memory_order_relaxed );
+  void* pointer = std::malloc( bytes ? bytes : 1 );
+  if ( !pointer ) {
+    throw std::bad_alloc();
+  }
+  return pointer;
+}
+
+SUITE_BENCH_NOINLINE void operator delete( void* pointer ) noexcept {
+  std::free( pointer );
+}
+
+namespace {
+
+/**
+ * Measures the time, comparisons and allocations of the region between
+ * start() and stop(), and the number of operations done in it.
+ */
+class Probe {
+
+ public:
+
+  Probe() : nanoseconds( 0 ), comparisons( 0 ), allocations( 0 ), ops( 0 ) {
+  }
+
+  void start() {
+    comparisons = bench::CountedKey::comparisons();
+    allocations = allocation_count.load( std::memory_order_relaxed );
+    timer.restart();
+  }
+
+  void stop( size_t operations ) {
+    nanoseconds = timer.elapsedNanoseconds();
+    comparisons = bench::CountedKey::comparisons() - comparisons;
+    allocations = allocation_count.load( std::memory_order_relaxed ) - allocations;
+    ops = operations;
+  }
+
+  double nanoseconds;
+  uint64_t comparisons;
+  uint64_t allocations;
+  size_t ops;
+
+ private:
+  bench::Timer timer;
+
+};
+
+template<typename T>
+struct BuildRecursive {
+  static const char* name() { return "MaxHeap build RECURSIVE"; }
+  static uint64_t run( const std::vector<T>& input, Probe& probe ) {
+    std::vector<T> v( input );
+    probe.start();
+    MaxHeap<T> heap( std::move( v ), RECURSIVE );
+    probe.stop( input.size() );
+    return bench::keyOf( heap.heapMaximum() );
+  }
+};
+
+template<typename T>
+struct BuildIterative {
+  static const char* name() { return "MaxHeap build ITERATIVE"; }
+  static uint64_t run( const std::vector<T>& input, Probe& probe ) {
+    std::vector<T> v( input );
+    probe.start();
+    MaxHeap<T> heap( std::move( v ), ITERATIVE );
+    probe.stop( input.size() );
+    return bench::keyOf( heap.heapMaximum() );
+  }
+};
+
+template<typename T>
+struct BuildPriorityQueue {
+  static const char* name() { return "priority_queue build"; }
+  static uint64_t run( const std::vector<T>& input, Probe& probe ) {
+    std::vector<T> v( input );
+    probe.start();
+    std::priority_queue<T> queue( std::less<T>(), std::move( v ) );
+    probe.stop( input.size() );
+    return bench::keyOf( queue.top() );
+  }
+};
+
+template<typename T>
+struct BuildMakeHeap {
+  static const char* name() { return "make_heap"; }
+  static uint64_t run( const std::vector<T>& input, Probe& probe ) {
+    std::vector<T> v( input );
+    probe.start();
+    std::make_heap( v.begin(), v.end() );
+    probe.stop( input.size() );
+    return bench::keyOf( v.front() );
+  }
+};
+
+template<typename T>
+struct InsertMaxHeap {
+  static const char* name() { return "MaxHeap insert"; }
+  static uint64_t run( const std::vector<T>& input, Probe& probe ) {
+    MaxHeap<T> heap;
+    probe.start();
+    for ( size_t i = 0; i < input.size(); i++ ) {
+      heap.maxHeapInsert( input[ i ] );
+    }
+    probe.stop( input.size() );
+    return bench::keyOf( heap.heapMaximum() );
+  }
+};
+
+template<typename T>
+struct InsertPriorityQueue {
+  static const char* name() { return "priority_queue push"; }
+  static uint64_t run( const std::vector<T>& input, Probe& probe ) {
+    std::priority_queue<T> queue;
+    probe.start();
+    for ( size_t i = 0; i < input.size(); i++ ) {
+      queue.push( input[ i ] );
+    }
+    probe.stop( input.size() );
+    return bench::keyOf( queue.top() );
+  }
+};
+
+template<typename T>
+struct InsertPushHeap {
+  static const char* name() { return "push_heap"; }
+  static uint64_t run( const std::vector<T>& input, Probe& probe ) {
+    std::vector<T> v;
+    probe.start();
+    for ( size_t i = 0; i < input.size(); i++ ) {
+      v.push_back( input[ i ] );
+      std::push_heap( v.begin(), v.end() );
+    }
+    probe.stop( input.size() );
+    return bench::keyOf( v.front() );
+  }
+};
+
+template<typename T>
+struct ExtractMaxHeap {
+  static const char* name() { return "MaxHeap extract TOP_DOWN"; }
+  static uint64_t run( const std::vector<T>& input, Probe& probe ) {
+    MaxHeap<T> heap( input, ITERATIVE );
+    uint64_t sum = 0;
+    probe.start();
+    for ( size_t i = 0; i < input.size(); i++ ) {
+      sum += bench::keyOf( heap.heapExtractMax() );
+    }
+    probe.stop( input.size() );
+    return sum;
+  }
+};
+
+template<typename T>
+struct ExtractMaxHeapBottomUp {
+  static const char* name() { return "MaxHeap extract BOTTOM_UP"; }
+  static uint64_t run( const std::vector<T>& input, Probe& probe ) {
+    MaxHeap<T> heap( input, ITERATIVE );
+    heap.setExtractionType( BOTTOM_UP );
+    uint64_t sum = 0;
+    probe.start();
+    for ( size_t i = 0; i < input.size(); i++ ) {
+      sum += bench::keyOf( heap.heapExtractMax() );
+    }
+    probe.stop( input.size() );
+    return sum;
+  }
+};
+
+template<typename T>
+struct ExtractPriorityQueue {
+  static const char* name() { return "priority_queue pop"; }
+  static uint64_t run( const std::vector<T>& input, Probe& probe ) {
+    std::priority_queue<T> queue( input.begin(), input.end() );
+    uint64_t sum = 0;
+    probe.start();
+    for ( size_t i = 0; i < input.size(); i++ ) {
+      sum += bench::keyOf( queue.top() );
+      queue.pop();
+    }
+    probe.stop( input.size() );
+    return sum;
+  }
+};
+
+template<typename T>
+struct ExtractPopHeap {
+  static const char* name() { return "pop_heap"; }
+  static uint64_t run( const std::vector<T>& input, Probe& probe ) {
+    std::vector<T> v( input );
+    std::make_heap( v.begin(), v.end() );
+    uint64_t sum = 0;
+    probe.start();
+    for ( size_t i = 0; i < input.size(); i++ ) {
+      std::pop_heap( v.begin(), v.end() );
+      sum += bench::keyOf( v.back() );
+      v.pop_back();
+    }
+    probe.stop( input.size() );
+    return sum;
+  }
+};
+
+template<typename T>
+struct RemoveAtMaxHeap {
+  static const char* name() { return "MaxHeap removeAt"; }
+  static uint64_t run( const std::vector<T>& input, Probe& probe ) {
+    MaxHeap<T> heap( input, ITERATIVE );
+    size_t removals = input.size() / 2;
+    std::vector<size_t> positions( removals );
+    bench::Random random( 7 );
+    for ( size_t i = 0; i < removals; i++ ) {
+      positions[ i ] = random.next() % ( input.size() - i );
+    }
+    uint64_t sum = 0;
+    probe.start();
+    for ( size_t i = 0; i < removals; i++ ) {
+      sum += bench::keyOf( heap.removeAt( positions[ i ] ) );
+    }
+    probe.stop( removals );
+    return sum;
+  }
+};
+
+template<typename T>
+struct SortMaxHeap {
+  static const char* name() { return "MaxHeap heapSort"; }
+  static uint64_t run( const std::vector<T>& input, Probe& probe ) {
+    MaxHeap<T> heap( input, ITERATIVE );
+    probe.start();
+    std::vector<T> sorted = heap.heapSort();
+    probe.stop( input.size() );
+    return bench::keyOf( sorted.front() );
+  }
+};
+
+template<typename T>
+struct SortSortHeap {
+  static const char* name() { return "sort_heap"; }
+  static uint64_t run( const std::vector<T>& input, Probe& probe ) {
+    std::vector<T> v( input );
+    std::make_heap( v.begin(), v.end() );
+    probe.start();
+    std::sort_heap( v.begin(), v.end() );
+    probe.stop( input.size() );
+    return bench::keyOf( v.back() );
+  }
+};
+
+/**
+ * Returns the coin flips of the mixed workload: true for an insert, false
+ * for an extract.
+ */
+inline std::vector<bool> mixedOperations( size_t n ) {
+  std::vector<bool> inserts( n );
+  bench::Random random( 11 );
+  for ( size_t i = 0; i < n; i++ ) {
+    inserts[ i ] = ( random.next() >> 32 ) & 1;
+  }
+  return inserts;
+}
+
+template<typename T>
+struct MixedMaxHeap {
+  static const char* name() { return "MaxHeap mixed"; }
+  static uint64_t run( const std::vector<T>& input, Probe& probe ) {
+    std::vector<bool> inserts = mixedOperations( input.size() );
+    MaxHeap<T> heap( input, ITERATIVE );
+    heap.reserve( 2 * input.size() );
+    uint64_t sum = 0;
+    probe.start();
+    for ( size_t i = 0; i < input.size(); i++ ) {
+      if ( inserts[ i ] ) {
+        heap.maxHeapInsert( input[ input.size() - 1 - i ] );
+      } else {
+        sum += bench::keyOf( heap.heapExtractMax() );
+      }
+    }
+    probe.stop( input.size() );
+    return sum;
+  }
+};
+
+template<typename T>
+struct MixedPriorityQueue {
+  static const char* name() { return "priority_queue mixed"; }
+  static uint64_t run( const std::vector<T>& input, Probe& probe ) {
+    std::vector<bool> inserts = mixedOperations( input.size() );
+    std::vector<T> v;
+    v.reserve( 2 * input.size() );
+    v.assign( input.begin(), input.end() );
+    std::priority_queue<T> queue( std::less<T>(), std::move( v ) );
+    uint64_t sum = 0;
+    probe.start();
+    for ( size_t i = 0; i < input.size(); i++ ) {
+      if ( inserts[ i ] ) {
+        queue.push( input[ input.size() - 1 - i ] );
+      } else {
+        sum += bench::keyOf( queue.top() );
+        queue.pop();
+      }
+    }
+    probe.stop( input.size() );
+    return sum;
+  }
+};
+
+/**
+ * Runs one workload on the input, timed on T and counted on
+ * bench::Counted<T>, and prints its line.
+ */
+template<template<typename> class Workload, typename T>
+void measure( const std::string& type, const std::vector<T>& input ) {
+  Probe timed;
+  bench::consume( Workload<T>::run( input, timed ) );
+  std::vector<bench::Counted<T> > counted( input.begin(), input.end() );
+  Probe counting;
+  bench::consume( Workload<bench::Counted<T> >::run( counted, counting ) );
+  double ops = static_cast<double>( timed.ops );
+  bench::report( Workload<T>::name(), type, input.size(), timed.nanoseconds / ops, counting.comparisons / ops, timed.allocations / ops );
+}
+
+template<typename T>
+void runSuite( const std::string& type, size_t max_elements, size_t budget_bytes ) {
+  for ( size_t n = 1000; n <= max_elements; n *= 10 ) {
+    // The input, its counted copy and the container under test.
+    if ( n > budget_bytes / sizeof( T ) / 3 ) {
+      std::cout << "skipping " << type << " at " << n << " elements: over the memory budget" << std::endl;
+      break;
+    }
+    std::vector<T> input;
+    input.reserve( n );
+    bench::Random random;
+    for ( size_t i = 0; i < n; i++ ) {
+      input.push_back( bench::makeValue<T>( random.next() ) );
+    }
+    measure<BuildRecursive>( type, input );
+    measure<BuildIterative>( type, input );
+    measure<BuildPriorityQueue>( type, input );
+    measure<BuildMakeHeap>( type, input );
+    measure<InsertMaxHeap>( type, input );
+    measure<InsertPriorityQueue>( type, input );
+    measure<InsertPushHeap>( type, input );
+    measure<ExtractMaxHeap>( type, input );
+    measure<ExtractMaxHeapBottomUp>( type, input );
+    measure<ExtractPriorityQueue>( type, input );
+    measure<ExtractPopHeap>( type, input );
+    measure<RemoveAtMaxHeap>( type, input );
+    measure<SortMaxHeap>( type, input );
+    measure<SortSortHeap>( type, input );
+    measure<MixedMaxHeap>( type, input );
+    measure<MixedPriorityQueue>( type, input );
+    std::cout << std::endl;
+  }
+}
+
+}
+
+int main( int argc, const char * argv[] ) {
+  size_t max_elements = argc > 1 ? std::strtoull( argv[ 1 ], 0, 10 ) : 1000000;
+  size_t budget_bytes = ( argc > 2 ? std::strtoull( argv[ 2 ], 0, 10 ) : 2048 ) << 20;
+  runSuite<int>( "int", max_elements, budget_bytes );
+  runSuite<bench::Record<16> >( "16 bytes", max_elements, budget_bytes );
+  runSuite<bench::Record<64> >( "64 bytes", max_elements, budget_bytes );
+  runSuite<bench::Record<256> >( "256 bytes", max_elements, budget_bytes );
+  return 0;
+}
@@ -0,0 +1,100 @@
+/*
+ * Measures how the WorkStealingScheduler balances skewed task generation.
+ * The tasks are queued up front, spread over the workers by a Zipf-like
+ * law, or all on a single worker, and each task spins for a fixed amount of
+ * work. The time to run every task is reported per task, with stealing
+ * disabled and with several steal batch sizes.
+ *
+ * Usage: work_stealing_bench [tasks [max_threads]]
+ */
+
+#include "BenchUtil.h"
+#include "WorkStealingScheduler.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+const size_t TASK_WORK = 200;
+
+uint64_t runTask( uint64_t task ) {
+  uint64_t value = task;
+  for ( size_t i = 0; i < TASK_WORK; i++ ) {
+    value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+  }
+  return value;
+}
+
+/**
+ * Returns the worker that generates the task with the specified random
+ * number: worker w with a probability proportional to 1 / (w + 1)^skew.
+ */
+size_t skewedWorker( uint64_t r, const std::vector<double>& cumulative ) {
+  double u = static_cast<double>( r >> 11 ) / static_cast<double>( 1ULL << 53 ) * cumulative.back();
+  size_t worker = 0;
+  while ( worker + 1 < cumulative.size() && cumulative[ worker ] < u ) {
+    worker++;
+  }
+  return worker;
+}
+
+void runSkewed( const std::string& name, size_t tasks, size_t threads, double skew, size_t steal_batch ) {
+  WorkStealingScheduler<uint64_t> s( threads, steal_batch );
+  std::vector<double> cumulative;
+  double sum = 0;
+  for ( size_t w = 0; w < threads; w++ ) {
+    sum += skew < 0 ? ( w == 0 ? 1.0 : 0.0 ) : 1.0 / std::pow( w + 1.0, skew );
+    cumulative.push_back( sum );
+  }
+  bench::Random random;
+  for ( size_t i = 0; i < tasks; i++ ) {
+    uint64_t r = random.next();
+    s.push( skewedWorker( r, cumulative ), r );
+  }
+  std::atomic<size_t> done( 0 );
+  std::vector<std::thread> workers;
+  bench::Timer timer;
+  for ( size_t w = 0; w < threads; w++ ) {
+    workers.push_back( std::thread( [&, w]() {
+      uint64_t task;
+      uint64_t result = 0;
+      while ( done.load() < tasks ) {
+        if ( s.tryPop( w, task ) ) {
+          result += runTask( task );
+          done.fetch_add( 1 );
+        } else if ( steal_batch == 0 ) {
+          break;
+        } else {
+          std::this_thread::yield();
+        }
+      }
+      bench::consume( result );
+    } ) );
+  }
+  for ( size_t i = 0; i < threads; i++ ) {
+    workers[ i ].join();
+  }
+  double nanoseconds = timer.elapsedNanoseconds();
+  std::string type = std::to_string( threads ) + "t " + ( steal_batch == 0 ? "no steal" : "steal " + std::to_string( steal_batch ) );
+  bench::report( name, type, tasks, nanoseconds / tasks );
+}
+
+int main( int argc, const char * argv[] ) {
+  size_t tasks = argc > 1 ? std::strtoull( argv[ 1 ], 0, 10 ) : 1000000;
+  size_t max_threads = argc > 2 ? std::strtoull( argv[ 2 ], 0, 10 ) : std::thread::hardware_concurrency();
+  if ( max_threads == 0 ) {
+    max_threads = 1;
+  }
+  size_t steal_batches[4] = { 0, 1, 16, 256 };
+  for ( size_t threads = 2; threads <= std::max<size_t>( 2, max_threads ); threads *= 2 ) {
+    for ( size_t i = 0; i < 4; i++ ) {
+      runSkewed( "zipf 1.0", tasks, threads, 1.0, steal_batches[ i ] );
+      runSkewed( "zipf 2.0", tasks, threads, 2.0, steal_batches[ i ] );
+      runSkewed( "single producer", tasks, threads, -1.0, steal_batches[ i ] );
+    }
+  }
+  return 0;
+}
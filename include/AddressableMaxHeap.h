@@ -0,0 +1,548 @@
+#ifndef ADDRESSABLEMAXHEAP_H
+#define ADDRESSABLEMAXHEAP_H
+
+/*
+ * The MIT Licese (MIT)
+ *
+ * Copyright (C) 2016 by Brian Horn, trycatchhorn@gmail.com.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "MaxHeapSift.h"
+
+/**
+ * A d-ary max-heap where every inserted element is identified by a handle.
+ * The handle stays valid while the element moves around in the heap, so an
+ * element can be erased, or have its key changed, in O(log n) without
+ * searching for it.
+ *
+ * The heap is laid out like MaxHeap, in a vector of entries placed by the
+ * Layout, next to a table mapping each handle to the current index of its
+ * entry. The sifts are those of MaxHeapSift, and every move keeps the table
+ * up to date.
+ *
+ * A handle packs the slot of its element in the table with the generation
+ * of that slot, which is bumped whenever an element leaves the heap. A
+ * handle kept after its element was removed is therefore rejected, even
+ * once a later insertion reuses the slot.
+ *
+ * NOTE: a handle becomes invalid when its element leaves the heap. The
+ * generation wraps around after 2^32 removals from the same slot, and the
+ * table holds at most 2^32 slots.
+ */
+template<typename T, size_t Arity = 2, typename Layout = ImplicitLayout>
+class AddressableMaxHeap {
+
+  static_assert( Arity >= 2, "AddressableMaxHeap requires an arity of at least two" );
+
+ public:
+
+  /**
+   * Identifies an element in the max-heap.
+   */
+  typedef uint64_t Handle;
+
+  /**
+   * Creates an empty max-heap.
+   */
+  AddressableMaxHeap();
+
+  /**
+   * Returns the size of the max-heap.
+   *
+   * @return the size of the max-heap.
+   */
+  size_t getSize() const;
+
+  /**
+   * Returns if the max-heap is empty.
+   *
+   * @return true if the max-heap is empty, otherwise false.
+   */
+  bool empty() const;
+
+  /**
+   * Determines if the specified handle refers to an element in the max-heap.
+   *
+   * @param  handle of an element.
+   * @return true if the handle refers to an element in the max-heap.
+   */
+  bool contains( Handle handle ) const;
+
+  /**
+   * Returns the element referred to by the specified handle.
+   *
+   * @param  handle of an element in the max-heap.
+   * @return the element referred to by the handle.
+   */
+  const T& get( Handle handle ) const;
+
+  /**
+   * Returns the element with the maximum key in the max-heap.
+   *
+   * @return the element with the maximum key in the max-heap.
+   */
+  const T& heapMaximum() const;
+
+  /**
+   * Returns the handle of the element with the maximum key in the max-heap.
+   *
+   * @return the handle of the element with the maximum key.
+   */
+  Handle maximumHandle() const;
+
+  /**
+   * Removes and returns the element with the maximum key in the max-heap,
+   * while maintaining the max-heap property. The handle of the element
+   * becomes invalid.
+   *
+   * @return the element with the maximum key in the max-heap.
+   */
+  T heapExtractMax();
+
+  /**
+   * Inserts the specified key into the max-heap and maintains the max-heap
+   * property.
+   *
+   * @param  key the key to be inserted into the max-heap.
+   * @return the handle of the inserted element.
+   */
+  Handle maxHeapInsert( const T& key );
+
+  /**
+   * Inserts the specified key into the max-heap by moving it, and maintains
+   * the max-heap property.
+   *
+   * @param  key the key to be moved into the max-heap.
+   * @return the handle of the inserted element.
+   */
+  Handle maxHeapInsert( T&& key );
+
+  /**
+   * Removes and returns the element referred to by the specified handle in
+   * O(log n), while maintaining the max-heap property. The handle becomes
+   * invalid.
+   *
+   * @param  handle of the element to be removed.
+   * @return the element being removed.
+   */
+  T erase( Handle handle );
+
+  /**
+   * Replaces the element referred to by the specified handle with a key
+   * that is not smaller, and moves it up as necessary.
+   *
+   * @param  handle of the element to be changed.
+   * @param  key the new key, which must not be smaller than the current key.
+   */
+  void increaseKey( Handle handle, T key );
+
+  /**
+   * Replaces the element referred to by the specified handle with a key
+   * that is not larger, and moves it down as necessary.
+   *
+   * @param  handle of the element to be changed.
+   * @param  key the new key, which must not be larger than the current key.
+   */
+  void decreaseKey( Handle handle, T key );
+
+  /**
+   * Replaces the element referred to by the specified handle with the
+   * specified key, and moves it up or down as necessary.
+   *
+   * @param  handle of the element to be changed.
+   * @param  key the new key.
+   */
+  void updateKey( Handle handle, T key );
+
+  /**
+   * Determines if this heap satisfies the max-heap property, and if every
+   * handle refers to the entry holding it.
+   *
+   * @return true if the heap is consistent, false otherwise.
+   */
+  bool isMaxHeap() const;
+
+ private:
+
+  /**
+   * An element of the max-heap together with its handle.
+   */
+  struct Entry {
+    T key;
+    Handle handle;
+
+    Entry( T&& k, Handle h ) : key( std::move( k ) ), handle( h ) {
+    }
+  };
+
+  typedef typename Layout::template Index<Entry, Arity> Index;
+  typedef MaxHeapSift<Entry, Arity, Layout> Sift;
+
+  /**
+   * The accessor through which MaxHeapSift reaches the entries, holding the
+   * entry being sifted. Every move records the new index of the entry.
+   */
+  struct Sifter {
+    typedef Entry KeyType;
+
+    AddressableMaxHeap<T, Arity, Layout>& owner;
+    Entry* held;
+
+    Sifter( AddressableMaxHeap<T, Arity, Layout>& o, Entry* h ) : owner( o ), held( h ) {
+    }
+
+    const Entry* keys( size_t index ) {
+      return &owner.heap[ index ];
+    }
+
+    bool less( size_t lhs, size_t rhs ) {
+      return owner.heap[ lhs ].key < owner.heap[ rhs ].key;
+    }
+
+    bool heldLess( size_t index ) {
+      return held->key < owner.heap[ index ].key;
+    }
+
+    bool lessHeld( size_t index ) {
+      return owner.heap[ index ].key < held->key;
+    }
+
+    void compared( uint64_t ) {
+    }
+
+    void move( size_t hole, size_t index ) {
+      owner.place( hole, std::move( owner.heap[ index ] ) );
+    }
+
+    void place( size_t hole ) {
+      owner.place( hole, std::move( *held ) );
+    }
+  };
+
+  /**
+   * The index of the entry holding a handle, or npos if the slot is free,
+   * together with the generation of the handles currently using the slot.
+   */
+  struct Slot {
+    size_t position;
+    uint32_t generation;
+
+    Slot() : position( npos ), generation( 0 ) {
+    }
+  };
+
+  std::vector<Entry> heap;
+  std::vector<Slot> slots;
+  std::vector<uint32_t> free_slots;
+
+  static const size_t npos = static_cast<size_t>( -1 );
+
+  /**
+   * Returns the slot of the specified handle.
+   *
+   * @param  handle of an element.
+   * @return the index of the slot in the table.
+   */
+  static size_t slotOf( Handle handle );
+
+  /**
+   * Returns the generation of the specified handle.
+   *
+   * @param  handle of an element.
+   * @return the generation the handle was issued in.
+   */
+  static uint32_t generationOf( Handle handle );
+
+  /**
+   * Returns the index of the entry referred to by the specified handle,
+   * and throws std::invalid_argument if the handle is not in the heap.
+   *
+   * @param  handle of an element in the max-heap.
+   * @return the index of the entry in the heap.
+   */
+  size_t indexOf( Handle handle ) const;
+
+  /**
+   * Returns a free handle, reusing the slot of a removed element if any,
+   * and throws std::length_error if the table is full.
+   *
+   * @return a handle not referring to any element.
+   */
+  Handle allocateHandle();
+
+  /**
+   * Appends the specified key and moves it up to its final position.
+   *
+   * @param  key the key to be inserted.
+   * @return the handle of the inserted element.
+   */
+  Handle insertKey( T&& key );
+
+  /**
+   * Removes the entry at the specified index and fills the hole with the
+   * last entry of the heap.
+   *
+   * @param  index of the entry to be removed.
+   * @return the element being removed.
+   */
+  T removeIndex( size_t index );
+
+  /**
+   * Writes the specified entry at the specified index and records the
+   * index for the handle of the entry.
+   *
+   * @param  index in the heap.
+   * @param  entry the entry to be written.
+   */
+  void place( size_t index, Entry&& entry );
+
+  /**
+   * Moves the specified entry up from the hole at the specified index, one
+   * move per level, and places it once at its final position.
+   *
+   * @param  hole index of the empty slot in the heap.
+   * @param  entry the entry being sifted up.
+   */
+  void siftUp( size_t hole, Entry&& entry );
+
+  /**
+   * Moves the specified entry down from the hole at the specified index,
+   * one move per level, and places it once at its final position.
+   *
+   * @param  hole index of the empty slot in the heap.
+   * @param  entry the entry being sifted down.
+   */
+  void siftDown( size_t hole, Entry&& entry );
+
+  /**
+   * Moves the specified entry up or down from the hole at the specified
+   * index, as required to restore the max-heap property.
+   *
+   * @param  hole index of the empty slot in the heap.
+   * @param  entry the entry being sifted.
+   */
+  void restore( size_t hole, Entry&& entry );
+
+};
+
+template<typename T, size_t Arity, typename Layout>
+const size_t AddressableMaxHeap<T, Arity, Layout>::npos;
+
+template<typename T, size_t Arity, typename Layout>
+AddressableMaxHeap<T, Arity, Layout>::AddressableMaxHeap() {
+}
+
+template<typename T, size_t Arity, typename Layout>
+size_t AddressableMaxHeap<T, Arity, Layout>::getSize() const {
+  return heap.size();
+}
+
+template<typename T, size_t Arity, typename Layout>
+bool AddressableMaxHeap<T, Arity, Layout>::empty() const {
+  return heap.empty();
+}
+
+template<typename T, size_t Arity, typename Layout>
+bool AddressableMaxHeap<T, Arity, Layout>::contains( Handle handle ) const {
+  size_t slot = slotOf( handle );
+  return slot < slots.size() && slots[ slot ].position != npos && slots[ slot ].generation == generationOf( handle );
+}
+
+template<typename T, size_t Arity, typename Layout>
+const T& AddressableMaxHeap<T, Arity, Layout>::get( Handle handle ) const {
+  return heap[ indexOf( handle ) ].key;
+}
+
+template<typename T, size_t Arity, typename Layout>
+const T& AddressableMaxHeap<T, Arity, Layout>::heapMaximum() const {
+  if ( empty() ) {
+    throw std::underflow_error( "AddressableMaxHeap is empty!" );
+  }
+  return heap.front().key;
+}
+
+template<typename T, size_t Arity, typename Layout>
+typename AddressableMaxHeap<T, Arity, Layout>::Handle AddressableMaxHeap<T, Arity, Layout>::maximumHandle() const {
+  if ( empty() ) {
+    throw std::underflow_error( "AddressableMaxHeap is empty!" );
+  }
+  return heap.front().handle;
+}
+
+template<typename T, size_t Arity, typename Layout>
+T AddressableMaxHeap<T, Arity, Layout>::heapExtractMax() {
+  if ( empty() ) {
+    throw std::underflow_error( "AddressableMaxHeap is empty!" );
+  }
+  return removeIndex( 0 );
+}
+
+template<typename T, size_t Arity, typename Layout>
+typename AddressableMaxHeap<T, Arity, Layout>::Handle AddressableMaxHeap<T, Arity, Layout>::maxHeapInsert( const T& key ) {
+  T copy( key );
+  return insertKey( std::move( copy ) );
+}
+
+template<typename T, size_t Arity, typename Layout>
+typename AddressableMaxHeap<T, Arity, Layout>::Handle AddressableMaxHeap<T, Arity, Layout>::maxHeapInsert( T&& key ) {
+  return insertKey( std::move( key ) );
+}
+
+template<typename T, size_t Arity, typename Layout>
+T AddressableMaxHeap<T, Arity, Layout>::erase( Handle handle ) {
+  return removeIndex( indexOf( handle ) );
+}
+
+template<typename T, size_t Arity, typename Layout>
+void AddressableMaxHeap<T, Arity, Layout>::increaseKey( Handle handle, T key ) {
+  size_t index = indexOf( handle );
+  if ( key < heap[ index ].key ) {
+    throw std::invalid_argument( "New key is smaller than current key!" );
+  }
+  siftUp( index, Entry( std::move( key ), handle ) );
+}
+
+template<typename T, size_t Arity, typename Layout>
+void AddressableMaxHeap<T, Arity, Layout>::decreaseKey( Handle handle, T key ) {
+  size_t index = indexOf( handle );
+  if ( heap[ index ].key < key ) {
+    throw std::invalid_argument( "New key is larger than current key!" );
+  }
+  siftDown( index, Entry( std::move( key ), handle ) );
+}
+
+template<typename T, size_t Arity, typename Layout>
+void AddressableMaxHeap<T, Arity, Layout>::updateKey( Handle handle, T key ) {
+  size_t index = indexOf( handle );
+  Entry entry( std::move( key ), handle );
+  restore( index, std::move( entry ) );
+}
+
+template<typename T, size_t Arity, typename Layout>
+bool AddressableMaxHeap<T, Arity, Layout>::isMaxHeap() const {
+  for ( size_t i = 0; i < heap.size(); i++ ) {
+    if ( i > 0 && heap[ Index::parent( i ) ].key < heap[ i ].key ) {
+      return false;
+    }
+    if ( !contains( heap[ i ].handle ) || slots[ slotOf( heap[ i ].handle ) ].position != i ) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template<typename T, size_t Arity, typename Layout>
+size_t AddressableMaxHeap<T, Arity, Layout>::indexOf( Handle handle ) const {
+  if ( !contains( handle ) ) {
+    throw std::invalid_argument( "Handle does not refer to an element in the heap!" );
+  }
+  return slots[ slotOf( handle ) ].position;
+}
+
+template<typename T, size_t Arity, typename Layout>
+size_t AddressableMaxHeap<T, Arity, Layout>::slotOf( Handle handle ) {
+  return static_cast<size_t>( handle & 0xFFFFFFFFu );
+}
+
+template<typename T, size_t Arity, typename Layout>
+uint32_t AddressableMaxHeap<T, Arity, Layout>::generationOf( Handle handle ) {
+  return static_cast<uint32_t>( handle >> 32 );
+}
+
+template<typename T, size_t Arity, typename Layout>
+typename AddressableMaxHeap<T, Arity, Layout>::Handle AddressableMaxHeap<T, Arity, Layout>::allocateHandle() {
+  size_t slot;
+  if ( free_slots.empty() ) {
+    if ( slots.size() > 0xFFFFFFFFu ) {
+      throw std::length_error( "AddressableMaxHeap has run out of handles!" );
+    }
+    slots.push_back( Slot() );
+    slot = slots.size() - 1;
+  } else {
+    slot = free_slots.back();
+    free_slots.pop_back();
+  }
+  return static_cast<Handle>( slots[ slot ].generation ) << 32 | slot;
+}
+
+template<typename T, size_t Arity, typename Layout>
+typename AddressableMaxHeap<T, Arity, Layout>::Handle AddressableMaxHeap<T, Arity, Layout>::insertKey( T&& key ) {
+  Handle handle = allocateHandle();
+  try {
+    heap.push_back( Entry( std::move( key ), handle ) );
+  }
+  catch ( ... ) {
+    free_slots.push_back( static_cast<uint32_t>( slotOf( handle ) ) );
+    throw;
+  }
+  slots[ slotOf( handle ) ].position = heap.size() - 1;
+  Entry entry = std::move( heap.back() );
+  siftUp( heap.size() - 1, std::move( entry ) );
+  return handle;
+}
+
+template<typename T, size_t Arity, typename Layout>
+T AddressableMaxHeap<T, Arity, Layout>::removeIndex( size_t index ) {
+  Handle handle = heap[ index ].handle;
+  T result = std::move( heap[ index ].key );
+  Entry last = std::move( heap.back() );
+  heap.pop_back();
+  Slot& slot = slots[ slotOf( handle ) ];
+  slot.position = npos;
+  slot.generation++;
+  free_slots.push_back( static_cast<uint32_t>( slotOf( handle ) ) );
+  if ( index < heap.size() ) {
+    restore( index, std::move( last ) );
+  }
+  return result;
+}
+
+template<typename T, size_t Arity, typename Layout>
+void AddressableMaxHeap<T, Arity, Layout>::place( size_t index, Entry&& entry ) {
+  slots[ slotOf( entry.handle ) ].position = index;
+  heap[ index ] = std::move( entry );
+}
+
+template<typename T, size_t Arity, typename Layout>
+void AddressableMaxHeap<T, Arity, Layout>::siftUp( size_t hole, Entry&& entry ) {
+  Sifter sifter( *this, &entry );
+  Sift::up( sifter, hole );
+}
+
+template<typename T, size_t Arity, typename Layout>
+void AddressableMaxHeap<T, Arity, Layout>::siftDown( size_t hole, Entry&& entry ) {
+  Sifter sifter( *this, &entry );
+  Sift::down( sifter, hole, heap.size() );
+}
+
+template<typename T, size_t Arity, typename Layout>
+void AddressableMaxHeap<T, Arity, Layout>::restore( size_t hole, Entry&& entry ) {
+  Sifter sifter( *this, &entry );
+  Sift::restore( sifter, hole, heap.size() );
+}
+
+#endif
@@ -0,0 +1,252 @@
+#ifndef CONCURRENTMAXHEAP_H
+#define CONCURRENTMAXHEAP_H
+
+/*
+ * The MIT Licese (MIT)
+ *
+ * Copyright (C) 2016 by Brian Horn, trycatchhorn@gmail.com.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+*/
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "MaxHeap.h"
+
+/**
+ * A max-heap shared by several producer and consumer threads.
+ *
+ * Every operation locks one mutex around a MaxHeap. The batched operations,
+ * pushBatch() and popBatch(), move many elements under a single lock
+ * acquisition, which is what keeps the mutex from becoming the bottleneck
+ * when many threads hand work to each other.
+ *
+ * Consumers block in pop() and popBatch() until an element is available.
+ * After close() they drain the remaining elements and are then released,
+ * which is how a dispatcher shuts its workers down.
+ */
+template<typename T, size_t Arity = 2>
+class ConcurrentMaxHeap {
+
+ public:
+
+  /**
+   * Creates an empty, open max-heap.
+   */
+  ConcurrentMaxHeap();
+
+  ConcurrentMaxHeap( const ConcurrentMaxHeap& ) = delete;
+
+  ConcurrentMaxHeap& operator=( const ConcurrentMaxHeap& ) = delete;
+
+  /**
+   * Returns the size of the max-heap at the time of the call.
+   *
+   * @return the size of the max-heap.
+   */
+  size_t getSize();
+
+  /**
+   * Returns if the max-heap is empty at the time of the call.
+   *
+   * @return true if the max-heap is empty, otherwise false.
+   */
+  bool empty();
+
+  /**
+   * Inserts the specified key into the max-heap and wakes one waiting
+   * consumer.
+   *
+   * @param  key the key to be inserted.
+   */
+  void push( const T& key );
+
+  /**
+   * Moves the specified key into the max-heap and wakes one waiting
+   * consumer.
+   *
+   * @param  key the key to be inserted.
+   */
+  void push( T&& key );
+
+  /**
+   * Inserts every element in the range [first, last) into the max-heap
+   * under a single lock acquisition, using MaxHeap::insertRange(), and wakes
+   * the waiting consumers.
+   *
+   * @param  first the beginning of the range of elements.
+   * @param  last the end of the range of elements.
+   */
+  template<typename InputIterator>
+  void pushBatch( InputIterator first, InputIterator last );
+
+  /**
+   * Removes the element with the maximum key, blocking until an element is
+   * available or the max-heap is closed.
+   *
+   * @param  result receives the element with the maximum key.
+   * @return true if an element was removed, false if the max-heap is closed
+   *         and empty.
+   */
+  bool pop( T& result );
+
+  /**
+   * Removes the element with the maximum key if the max-heap is not empty,
+   * without blocking.
+   *
+   * @param  result receives the element with the maximum key.
+   * @return true if an element was removed, otherwise false.
+   */
+  bool tryPop( T& result );
+
+  /**
+   * Removes up to the specified number of elements in descending order
+   * under a single lock acquisition, blocking until at least one element is
+   * available or the max-heap is closed.
+   *
+   * @param  n the maximum number of elements to remove.
+   * @return vector<T> the removed elements, largest first; empty only if
+   *         the max-heap is closed and empty, or n is zero.
+   */
+  std::vector<T> popBatch( size_t n );
+
+  /**
+   * Closes the max-heap and wakes every waiting consumer. Elements already
+   * in the max-heap can still be removed; pushing after close() is allowed
+   * but no consumer waits for it.
+   */
+  void close();
+
+  /**
+   * Returns if the max-heap has been closed.
+   *
+   * @return true if close() has been called, otherwise false.
+   */
+  bool isClosed();
+
+ private:
+  MaxHeap<T, Arity> heap;
+  std::mutex mutex;
+  std::condition_variable available;
+  bool closed;
+
+};
+
+template<typename T, size_t Arity>
+ConcurrentMaxHeap<T, Arity>::ConcurrentMaxHeap() : closed( false ) {
+}
+
+template<typename T, size_t Arity>
+size_t ConcurrentMaxHeap<T, Arity>::getSize() {
+  std::lock_guard<std::mutex> lock( mutex );
+  return heap.getSize();
+}
+
+template<typename T, size_t Arity>
+bool ConcurrentMaxHeap<T, Arity>::empty() {
+  std::lock_guard<std::mutex> lock( mutex );
+  return heap.empty();
+}
+
+template<typename T, size_t Arity>
+void ConcurrentMaxHeap<T, Arity>::push( const T& key ) {
+  {
+    std::lock_guard<std::mutex> lock( mutex );
+    heap.maxHeapInsert( key );
+  }
+  available.notify_one();
+}
+
+template<typename T, size_t Arity>
+void ConcurrentMaxHeap<T, Arity>::push( T&& key ) {
+  {
+    std::lock_guard<std::mutex> lock( mutex );
+    heap.maxHeapInsert( std::move( key ) );
+  }
+  available.notify_one();
+}
+
+template<typename T, size_t Arity>
+template<typename InputIterator>
+void ConcurrentMaxHeap<T, Arity>::pushBatch( InputIterator first, InputIterator last ) {
+  if ( first == last ) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock( mutex );
+    heap.insertRange( first, last );
+  }
+  available.notify_all();
+}
+
+template<typename T, size_t Arity>
+bool ConcurrentMaxHeap<T, Arity>::pop( T& result ) {
+  std::unique_lock<std::mutex> lock( mutex );
+  while ( heap.empty() && !closed ) {
+    available.wait( lock );
+  }
+  if ( heap.empty() ) {
+    return false;
+  }
+  result = heap.heapExtractMax();
+  return true;
+}
+
+template<typename T, size_t Arity>
+bool ConcurrentMaxHeap<T, Arity>::tryPop( T& result ) {
+  std::lock_guard<std::mutex> lock( mutex );
+  if ( heap.empty() ) {
+    return false;
+  }
+  result = heap.heapExtractMax();
+  return true;
+}
+
+template<typename T, size_t Arity>
+std::vector<T> ConcurrentMaxHeap<T, Arity>::popBatch( size_t n ) {
+  if ( n == 0 ) {
+    return std::vector<T>();
+  }
+  std::unique_lock<std::mutex> lock( mutex );
+  while ( heap.empty() && !closed ) {
+    available.wait( lock );
+  }
+  return heap.extractBatch( n );
+}
+
+template<typename T, size_t Arity>
+void ConcurrentMaxHeap<T, Arity>::close() {
+  {
+    std::lock_guard<std::mutex> lock( mutex );
+    closed = true;
+  }
+  available.notify_all();
+}
+
+template<typename T, size_t Arity>
+bool ConcurrentMaxHeap<T, Arity>::isClosed() {
+  std::lock_guard<std::mutex> lock( mutex );
+  return closed;
+}
+
+#endif
@@ -0,0 +1,569 @@
+#ifndef EXTERNALMAXHEAP_H
+#define EXTERNALMAXHEAP_H
+
+/*
+ * The MIT Licese (MIT)
+ *
+ * Copyright (C) 2016 by Brian Horn, trycatchhorn@gmail.com.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+*/
+
+#include "MaxHeap.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+/**
+ * An external-memory max-heap for more elements than fit in memory. New
+ * elements go into an in-memory MaxHeap, the insertion buffer. When the
+ * buffer is full it is sorted and written to a temporary file as a run of
+ * descending elements. heapExtractMax compares the maximum of the buffer
+ * with the heads of the runs, which are merged through a small MaxHeap of
+ * one head per run.
+ *
+ * The memory budget is split between the insertion buffer, which gets
+ * half of it, and one read block per run. Two more blocks are kept free
+ * for merging: when the blocks of another run would not fit, all runs are
+ * merged through an output block into a single run, whose read block is
+ * filled before the old runs are released. Memory therefore stays within
+ * the budget however many elements are inserted. Each merge rewrites
+ * every element on disk, so the budget should leave room for many runs:
+ * with the default blocks of 1 MiB, a budget of B bytes holds about
+ * B / 2 MiB runs. Runs are written and read sequentially, one block at a
+ * time, without stdio buffering.
+ *
+ * The run files are created in the specified directory and unlinked at
+ * once, so they disappear when the heap is destroyed or the process
+ * exits. A run replaces the elements it holds only once it has been
+ * written and read back in full, so when writing fails, for example on a
+ * full disk, the heap throws std::runtime_error and keeps its elements.
+ *
+ * NOTE: T is written to disk as raw bytes and must be trivially copyable.
+ * The run files are created with POSIX mkstemp.
+ */
+template<typename T>
+class ExternalMaxHeap {
+
+  static_assert( std::is_trivially_copyable<T>::value, "ExternalMaxHeap requires a trivially copyable type" );
+
+ public:
+
+  /**
+   * Creates an empty max-heap that uses at most the specified number of
+   * bytes of memory for its elements, and keeps its runs in the specified
+   * directory. Throws std::invalid_argument if the budget cannot hold the
+   * insertion buffer and the blocks of at least two runs.
+   *
+   * @param memory_budget the number of bytes of memory for elements.
+   * @param directory where the run files are created.
+   * @param block_bytes the size of the read and write blocks of a run.
+   */
+  ExternalMaxHeap( size_t memory_budget, const std::string& directory = "/tmp", size_t block_bytes = 1 << 20 );
+
+  /**
+   * Closes and removes the run files.
+   */
+  ~ExternalMaxHeap();
+
+  /**
+   * Returns the size of the max-heap, including the elements on disk.
+   *
+   * @return the size of the max-heap.
+   */
+  uint64_t getSize() const;
+
+  /**
+   * Returns if the max-heap is empty.
+   *
+   * @return true if the max-heap is empty, otherwise false.
+   */
+  bool empty() const;
+
+  /**
+   * Returns the number of runs on disk that still hold elements.
+   *
+   * @return the number of runs on disk.
+   */
+  size_t getRunCount() const;
+
+  /**
+   * Returns the number of bytes written to the run files so far.
+   *
+   * @return the number of bytes written to disk.
+   */
+  uint64_t getBytesWritten() const;
+
+  /**
+   * Returns the number of bytes read from the run files so far.
+   *
+   * @return the number of bytes read from disk.
+   */
+  uint64_t getBytesRead() const;
+
+  /**
+   * Returns the element with the maximum key in the max-heap.
+   *
+   * @return the element with the maximum key in the max-heap.
+   */
+  T heapMaximum();
+
+  /**
+   * Removes and returns the element with the maximum key in the max-heap.
+   *
+   * @return the element with the maximum key in the max-heap.
+   */
+  T heapExtractMax();
+
+  /**
+   * Inserts the specified key into the max-heap, writing the insertion
+   * buffer to disk as a new run if it is full. If the run cannot be
+   * written, std::runtime_error is thrown and the max-heap is unchanged.
+   *
+   * @param key the key to be inserted into the max-heap.
+   */
+  void maxHeapInsert( const T& key );
+
+ private:
+
+  /**
+   * A run on disk: a temporary file of descending elements, read one block
+   * at a time.
+   */
+  struct Run {
+    std::FILE* file;
+    std::vector<T> block;
+    size_t position;
+    uint64_t unread;
+    uint64_t block_offset;
+
+    Run() : file( 0 ), position( 0 ), unread( 0 ), block_offset( 0 ) {
+    }
+
+    ~Run() {
+      if ( file != 0 ) {
+        std::fclose( file );
+      }
+    }
+  };
+
+  /**
+   * Where a run stands, to rewind it if a merge fails.
+   */
+  struct Mark {
+    size_t position;
+    size_t block_size;
+    uint64_t unread;
+    uint64_t block_offset;
+  };
+
+  /**
+   * The element at the head of a run, ordered by its key.
+   */
+  struct RunHead {
+    T key;
+    size_t run;
+
+    RunHead( const T& k, size_t r ) : key( k ), run( r ) {
+    }
+
+    friend bool operator < ( const RunHead& lhs, const RunHead& rhs ) {
+      return lhs.key < rhs.key;
+    }
+  };
+
+  std::string directory;
+  size_t block_elements;
+  size_t buffer_capacity;
+  size_t max_runs;
+  MaxHeap<T> buffer;
+  std::vector<std::unique_ptr<Run> > runs;
+  MaxHeap<RunHead> heads;
+  uint64_t size;
+  uint64_t bytes_written;
+  uint64_t bytes_read;
+
+  ExternalMaxHeap( const ExternalMaxHeap<T>& other );
+  ExternalMaxHeap<T>& operator = ( const ExternalMaxHeap<T>& other );
+
+  /**
+   * Creates an unlinked temporary file in the run directory.
+   *
+   * @return the open file.
+   */
+  std::FILE* createFile();
+
+  /**
+   * Writes the specified elements to a file, and throws std::runtime_error
+   * if the write fails. The file is left open either way.
+   *
+   * @param file the file to write to.
+   * @param elements the first element to be written.
+   * @param count the number of elements to be written.
+   */
+  void writeElements( std::FILE* file, const T* elements, size_t count );
+
+  /**
+   * Rewinds a written run file and reads its first block. The returned
+   * run owns the file; on failure the file is closed and
+   * std::runtime_error is thrown.
+   *
+   * @param file the file holding the run.
+   * @param count the number of elements in the run, at least one.
+   * @return the run, not yet added to the max-heap.
+   */
+  std::unique_ptr<Run> openRun( std::FILE* file, uint64_t count );
+
+  /**
+   * Adds an opened run and its head to the max-heap. Room for the run and
+   * its head is reserved up front, so adding does not fail.
+   *
+   * @param run the run to be added.
+   */
+  void addRun( std::unique_ptr<Run> run );
+
+  /**
+   * Reads the next block of the specified run, which is left empty when
+   * the run has no unread elements.
+   *
+   * @param run the run to be refilled.
+   */
+  void readBlock( Run& run );
+
+  /**
+   * Closes the file of a run and frees its block, making its slot free.
+   *
+   * @param run the run to be released.
+   */
+  void releaseRun( Run& run );
+
+  /**
+   * Removes and returns the head of the run at the top of the merge heap,
+   * and pushes the next head of that run.
+   *
+   * @param release whether a run that runs out is released at once, or
+   *        kept open so that a failed merge can rewind it.
+   * @return the largest head of all runs.
+   */
+  T popRunHead( bool release = true );
+
+  /**
+   * Sorts the insertion buffer and writes it to disk as a new run, first
+   * merging the existing runs into one if another run would not fit.
+   */
+  void spill();
+
+  /**
+   * Merges all runs into a single run. The old runs are released only once
+   * the merged run has been written and opened; if that fails, they are
+   * rewound to where the merge started.
+   */
+  void mergeRuns();
+
+};
+
+template<typename T>
+ExternalMaxHeap<T>::ExternalMaxHeap( size_t memory_budget, const std::string& directory, size_t block_bytes )
+  : directory( directory ), size( 0 ), bytes_written( 0 ), bytes_read( 0 ) {
+  size_t buffer_bytes = memory_budget / 2;
+  block_elements = std::max<size_t>( 1, std::min( block_bytes, buffer_bytes / 8 ) / sizeof( T ) );
+  buffer_capacity = buffer_bytes / sizeof( T );
+  // Each run holds a block, a head, and during a merge a saved head and a
+  // mark. A merge also needs an output block and the merged run.
+  size_t per_run = block_elements * sizeof( T ) + 2 * sizeof( RunHead ) + sizeof( Mark ) + sizeof( std::unique_ptr<Run> ) + sizeof( Run );
+  size_t merging = 2 * block_elements * sizeof( T ) + sizeof( Run );
+  size_t remaining = memory_budget - buffer_capacity * sizeof( T );
+  if ( buffer_capacity == 0 || remaining < merging + 2 * per_run ) {
+    throw std::invalid_argument( "Memory budget is too small!" );
+  }
+  max_runs = ( remaining - merging ) / per_run;
+  buffer.reserve( buffer_capacity );
+  runs.reserve( max_runs );
+  heads.reserve( max_runs );
+}
+
+template<typename T>
+ExternalMaxHeap<T>::~ExternalMaxHeap() {
+}
+
+template<typename T>
+uint64_t ExternalMaxHeap<T>::getSize() const {
+  return size;
+}
+
+template<typename T>
+bool ExternalMaxHeap<T>::empty() const {
+  return size == 0;
+}
+
+template<typename T>
+size_t ExternalMaxHeap<T>::getRunCount() const {
+  size_t count = 0;
+  for ( size_t i = 0; i < runs.size(); i++ ) {
+    count += runs[ i ]->file != 0 ? 1 : 0;
+  }
+  return count;
+}
+
+template<typename T>
+uint64_t ExternalMaxHeap<T>::getBytesWritten() const {
+  return bytes_written;
+}
+
+template<typename T>
+uint64_t ExternalMaxHeap<T>::getBytesRead() const {
+  return bytes_read;
+}
+
+template<typename T>
+T ExternalMaxHeap<T>::heapMaximum() {
+  if ( empty() ) {
+    throw std::underflow_error( "ExternalMaxHeap is empty!" );
+  }
+  if ( heads.empty() || ( !buffer.empty() && heads.heapMaximum().key < buffer.heapMaximum() ) ) {
+    return buffer.heapMaximum();
+  }
+  return heads.heapMaximum().key;
+}
+
+template<typename T>
+T ExternalMaxHeap<T>::heapExtractMax() {
+  if ( empty() ) {
+    throw std::underflow_error( "ExternalMaxHeap is empty!" );
+  }
+  if ( heads.empty() || ( !buffer.empty() && heads.heapMaximum().key < buffer.heapMaximum() ) ) {
+    size--;
+    return buffer.heapExtractMax();
+  }
+  T result = popRunHead();
+  size--;
+  return result;
+}
+
+template<typename T>
+void ExternalMaxHeap<T>::maxHeapInsert( const T& key ) {
+  if ( buffer.getSize() == buffer_capacity ) {
+    spill();
+  }
+  buffer.maxHeapInsert( key );
+  size++;
+}
+
+template<typename T>
+std::FILE* ExternalMaxHeap<T>::createFile() {
+  std::string path = directory + "/maxheap-run-XXXXXX";
+  std::vector<char> name( path.begin(), path.end() );
+  name.push_back( '\0' );
+  int descriptor = mkstemp( &name[ 0 ] );
+  if ( descriptor < 0 ) {
+    throw std::runtime_error( "Cannot create run file in " + directory + "!" );
+  }
+  unlink( &name[ 0 ] );
+  std::FILE* file = fdopen( descriptor, "w+b" );
+  if ( file == 0 ) {
+    close( descriptor );
+    throw std::runtime_error( "Cannot open run file in " + directory + "!" );
+  }
+  // Whole blocks are read and written, so a stdio buffer would only add
+  // memory outside the budget.
+  std::setvbuf( file, 0, _IONBF, 0 );
+  return file;
+}
+
+template<typename T>
+void ExternalMaxHeap<T>::writeElements( std::FILE* file, const T* elements, size_t count ) {
+  if ( std::fwrite( elements, sizeof( T ), count, file ) != count ) {
+    throw std::runtime_error( "Cannot write run file!" );
+  }
+  bytes_written += static_cast<uint64_t>( count ) * sizeof( T );
+}
+
+template<typename T>
+std::unique_ptr<typename ExternalMaxHeap<T>::Run> ExternalMaxHeap<T>::openRun( std::FILE* file, uint64_t count ) {
+  if ( std::fflush( file ) != 0 || std::fseek( file, 0, SEEK_SET ) != 0 ) {
+    std::fclose( file );
+    throw std::runtime_error( "Cannot rewind run file!" );
+  }
+  std::unique_ptr<Run> run;
+  try {
+    run.reset( new Run() );
+  } catch ( ... ) {
+    std::fclose( file );
+    throw;
+  }
+  run->file = file;
+  run->unread = count;
+  run->block.reserve( block_elements );
+  readBlock( *run );
+  return run;
+}
+
+template<typename T>
+void ExternalMaxHeap<T>::addRun( std::unique_ptr<Run> run ) {
+  size_t index = 0;
+  while ( index < runs.size() && runs[ index ]->file != 0 ) {
+    index++;
+  }
+  heads.reserve( heads.getSize() + 1 );
+  if ( index == runs.size() ) {
+    runs.reserve( runs.size() + 1 );
+    runs.push_back( std::move( run ) );
+  } else {
+    runs[ index ].swap( run );
+  }
+  heads.maxHeapInsert( RunHead( runs[ index ]->block[ 0 ], index ) );
+}
+
+template<typename T>
+void ExternalMaxHeap<T>::readBlock( Run& run ) {
+  size_t count = static_cast<size_t>( std::min<uint64_t>( block_elements, run.unread ) );
+  run.block_offset += static_cast<uint64_t>( run.block.size() ) * sizeof( T );
+  run.block.resize( count );
+  run.position = 0;
+  if ( count == 0 ) {
+    return;
+  }
+  if ( std::fread( &run.block[ 0 ], sizeof( T ), count, run.file ) != count ) {
+    throw std::runtime_error( "Cannot read run file!" );
+  }
+  run.unread -= count;
+  bytes_read += static_cast<uint64_t>( count ) * sizeof( T );
+}
+
+template<typename T>
+void ExternalMaxHeap<T>::releaseRun( Run& run ) {
+  std::fclose( run.file );
+  run.file = 0;
+  run.unread = 0;
+  run.position = 0;
+  run.block_offset = 0;
+  std::vector<T>().swap( run.block );
+}
+
+template<typename T>
+T ExternalMaxHeap<T>::popRunHead( bool release ) {
+  size_t index = heads.heapMaximum().run;
+  Run& run = *runs[ index ];
+  T result = run.block[ run.position ];
+  if ( run.position + 1 == run.block.size() ) {
+    readBlock( run );
+  } else {
+    run.position++;
+  }
+  if ( !run.block.empty() ) {
+    heads.heapReplaceMax( RunHead( run.block[ run.position ], index ) );
+  } else {
+    heads.heapExtractMax();
+    if ( release ) {
+      releaseRun( run );
+    }
+  }
+  return result;
+}
+
+template<typename T>
+void ExternalMaxHeap<T>::spill() {
+  if ( heads.getSize() >= max_runs ) {
+    mergeRuns();
+  }
+  std::vector<T> sorted = buffer.sortInPlace();
+  try {
+    std::FILE* file = createFile();
+    try {
+      writeElements( file, sorted.data(), sorted.size() );
+    } catch ( ... ) {
+      std::fclose( file );
+      throw;
+    }
+    addRun( openRun( file, sorted.size() ) );
+  } catch ( ... ) {
+    // A descending vector is a max-heap, so the buffer is restored as is.
+    buffer = MaxHeap<T>( std::move( sorted ), ITERATIVE );
+    throw;
+  }
+  sorted.clear();
+  buffer = MaxHeap<T>( std::move( sorted ), ITERATIVE );
+}
+
+template<typename T>
+void ExternalMaxHeap<T>::mergeRuns() {
+  std::vector<Mark> marks( runs.size() );
+  for ( size_t i = 0; i < runs.size(); i++ ) {
+    Mark mark = { runs[ i ]->position, runs[ i ]->block.size(), runs[ i ]->unread, runs[ i ]->block_offset };
+    marks[ i ] = mark;
+  }
+  MaxHeap<RunHead> saved_heads( heads );
+  std::unique_ptr<Run> merged;
+  try {
+    std::FILE* file = createFile();
+    uint64_t count = 0;
+    try {
+      std::vector<T> output;
+      output.reserve( block_elements );
+      while ( !heads.empty() ) {
+        output.push_back( popRunHead( false ) );
+        if ( output.size() == block_elements ) {
+          writeElements( file, output.data(), output.size() );
+          count += output.size();
+          output.clear();
+        }
+      }
+      writeElements( file, output.data(), output.size() );
+      count += output.size();
+    } catch ( ... ) {
+      std::fclose( file );
+      throw;
+    }
+    merged = openRun( file, count );
+  } catch ( ... ) {
+    for ( size_t i = 0; i < runs.size(); i++ ) {
+      Run& run = *runs[ i ];
+      if ( run.file == 0 ) {
+        continue;
+      }
+      run.block.resize( marks[ i ].block_size );
+      run.position = marks[ i ].position;
+      run.unread = marks[ i ].unread;
+      run.block_offset = marks[ i ].block_offset;
+      if ( std::fseek( run.file, static_cast<long>( run.block_offset ), SEEK_SET ) != 0
+           || ( !run.block.empty() && std::fread( &run.block[ 0 ], sizeof( T ), run.block.size(), run.file ) != run.block.size() ) ) {
+        throw std::runtime_error( "Cannot rewind run file after a failed merge!" );
+      }
+    }
+    heads = saved_heads;
+    throw;
+  }
+  for ( size_t i = 0; i < runs.size(); i++ ) {
+    if ( runs[ i ]->file != 0 ) {
+      releaseRun( *runs[ i ] );
+    }
+  }
+  addRun( std::move( merged ) );
+}
+
+#endif
@@ -0,0 +1,389 @@
+#ifndef KEYEDMAXHEAP_H
+#define KEYEDMAXHEAP_H
+
+/*
+ * The MIT Licese (MIT)
+ *
+ * Copyright (C) 2016 by Brian Horn, trycatchhorn@gmail.com.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "MaxHeapSift.h"
+
+/**
+ * A d-ary max-heap of values ordered by separate keys, laid out as a
+ * structure of arrays. The keys are kept in heap order in one dense array,
+ * next to a parallel array with the slot of each value. The values
+ * themselves stay in their slots until they leave the heap.
+ *
+ * Sifting compares and moves only keys and slot numbers, with the sifts of
+ * MaxHeapSift, so the keys follow the Layout, and dense arithmetic keys
+ * are compared with SimdMaxChild when MaxHeapSimd.h is included. A large
+ * value ordered by a small key is moved once on insertion and once on
+ * removal, instead of once per level as in MaxHeap<T>. The extra indirection costs
+ * more than it saves for small values: in bench/keyed_bench.cpp MaxHeap is
+ * faster up to 64-byte records, and KeyedMaxHeap from 256 bytes on.
+ *
+ * NOTE: the slot of a removed value is reused by a later insertion. Until
+ * then it holds the moved-from value, so Value must be move-assignable.
+ */
+template<typename Key, typename Value, size_t Arity = 2, typename Layout = ImplicitLayout>
+class KeyedMaxHeap {
+
+  static_assert( Arity >= 2, "KeyedMaxHeap requires an arity of at least two" );
+
+ public:
+
+  /**
+   * An element of the max-heap, as returned when it is removed.
+   */
+  typedef std::pair<Key, Value> Element;
+
+  /**
+   * Creates an empty max-heap.
+   */
+  KeyedMaxHeap();
+
+  /**
+   * Returns the size of the max-heap.
+   *
+   * @return the size of the max-heap.
+   */
+  size_t getSize() const;
+
+  /**
+   * Returns if the max-heap is empty.
+   *
+   * @return true if the max-heap is empty, otherwise false.
+   */
+  bool empty() const;
+
+  /**
+   * Reserves room for the specified number of elements, so that inserting
+   * up to that many elements does not reallocate.
+   *
+   * @param capacity the number of elements to reserve room for.
+   */
+  void reserve( size_t capacity );
+
+  /**
+   * Returns the key at the specified index of the max-heap.
+   *
+   * @param  index of the element in the max-heap.
+   * @return the key at the index.
+   */
+  const Key& keyAt( size_t index ) const;
+
+  /**
+   * Returns the value at the specified index of the max-heap.
+   *
+   * @param  index of the element in the max-heap.
+   * @return the value at the index.
+   */
+  const Value& valueAt( size_t index ) const;
+
+  /**
+   * Returns the maximum key in the max-heap.
+   *
+   * @return the maximum key in the max-heap.
+   */
+  const Key& heapMaximum() const;
+
+  /**
+   * Returns the value of the maximum key in the max-heap.
+   *
+   * @return the value of the maximum key in the max-heap.
+   */
+  const Value& maximumValue() const;
+
+  /**
+   * Removes and returns the maximum key and its value, while maintaining the
+   * max-heap property.
+   *
+   * @return the maximum key and its value.
+   */
+  Element heapExtractMax();
+
+  /**
+   * Inserts the specified key and value into the max-heap and maintains the
+   * max-heap property.
+   *
+   * @param  key the key to be inserted into the max-heap.
+   * @param  value the value ordered by the key.
+   */
+  void maxHeapInsert( const Key& key, const Value& value );
+
+  /**
+   * Inserts the specified key and value into the max-heap by moving them,
+   * and maintains the max-heap property.
+   *
+   * @param  key the key to be moved into the max-heap.
+   * @param  value the value to be moved into the max-heap.
+   */
+  void maxHeapInsert( Key&& key, Value&& value );
+
+  /**
+   * Removes and returns the element at the specified index, while
+   * maintaining the max-heap property.
+   *
+   * @param  index of the element to be removed.
+   * @return the key and value being removed.
+   */
+  Element removeAt( size_t index );
+
+  /**
+   * Determines if the keys satisfy the max-heap property, and if every
+   * element refers to its own slot.
+   *
+   * @return true if the heap is consistent, false otherwise.
+   */
+  bool isMaxHeap() const;
+
+ private:
+
+  typedef typename Layout::template Index<Key, Arity> Index;
+  typedef MaxHeapSift<Key, Arity, Layout> Sift;
+
+  std::vector<Key> keys;
+  std::vector<size_t> slots;
+  std::vector<Value> values;
+  std::vector<size_t> free_slots;
+
+  /**
+   * The accessor through which MaxHeapSift reaches the keys, holding the
+   * key being sifted and the slot of its value. Every move carries the slot
+   * along with the key.
+   */
+  struct Sifter {
+    typedef Key KeyType;
+
+    KeyedMaxHeap<Key, Value, Arity, Layout>& owner;
+    Key* held;
+    size_t held_slot;
+
+    Sifter( KeyedMaxHeap<Key, Value, Arity, Layout>& o, Key* h, size_t slot ) : owner( o ), held( h ), held_slot( slot ) {
+    }
+
+    const Key* keys( size_t index ) {
+      return &owner.keys[ index ];
+    }
+
+    bool less( size_t lhs, size_t rhs ) {
+      return owner.keys[ lhs ] < owner.keys[ rhs ];
+    }
+
+    bool heldLess( size_t index ) {
+      return *held < owner.keys[ index ];
+    }
+
+    bool lessHeld( size_t index ) {
+      return owner.keys[ index ] < *held;
+    }
+
+    void compared( uint64_t ) {
+    }
+
+    void move( size_t hole, size_t index ) {
+      owner.keys[ hole ] = std::move( owner.keys[ index ] );
+      owner.slots[ hole ] = owner.slots[ index ];
+    }
+
+    void place( size_t hole ) {
+      owner.keys[ hole ] = std::move( *held );
+      owner.slots[ hole ] = held_slot;
+    }
+  };
+
+  /**
+   * Returns a slot for a new value, reusing the slot of a removed value if
+   * any.
+   *
+   * @param  value the value to be stored.
+   * @return the slot holding the value.
+   */
+  size_t storeValue( Value&& value );
+
+  /**
+   * Appends the specified key with its slot and moves it up to its final
+   * position.
+   *
+   * @param  key the key to be inserted.
+   * @param  slot of the value ordered by the key.
+   */
+  void insertKey( Key&& key, size_t slot );
+
+  /**
+   * Moves the specified key and slot up from the hole at the specified
+   * index, and places them once at their final position.
+   *
+   * @param  hole index of the empty position in the heap.
+   * @param  key the key being sifted up.
+   * @param  slot of the value ordered by the key.
+   */
+  void siftUp( size_t hole, Key&& key, size_t slot );
+
+};
+
+template<typename Key, typename Value, size_t Arity, typename Layout>
+KeyedMaxHeap<Key, Value, Arity, Layout>::KeyedMaxHeap() {
+}
+
+template<typename Key, typename Value, size_t Arity, typename Layout>
+size_t KeyedMaxHeap<Key, Value, Arity, Layout>::getSize() const {
+  return keys.size();
+}
+
+template<typename Key, typename Value, size_t Arity, typename Layout>
+bool KeyedMaxHeap<Key, Value, Arity, Layout>::empty() const {
+  return keys.empty();
+}
+
+template<typename Key, typename Value, size_t Arity, typename Layout>
+void KeyedMaxHeap<Key, Value, Arity, Layout>::reserve( size_t capacity ) {
+  keys.reserve( capacity );
+  slots.reserve( capacity );
+  values.reserve( capacity );
+}
+
+template<typename Key, typename Value, size_t Arity, typename Layout>
+const Key& KeyedMaxHeap<Key, Value, Arity, Layout>::keyAt( size_t index ) const {
+  if ( index >= keys.size() ) {
+    throw std::out_of_range( "Index out of range!" );
+  }
+  return keys[ index ];
+}
+
+template<typename Key, typename Value, size_t Arity, typename Layout>
+const Value& KeyedMaxHeap<Key, Value, Arity, Layout>::valueAt( size_t index ) const {
+  if ( index >= keys.size() ) {
+    throw std::out_of_range( "Index out of range!" );
+  }
+  return values[ slots[ index ] ];
+}
+
+template<typename Key, typename Value, size_t Arity, typename Layout>
+const Key& KeyedMaxHeap<Key, Value, Arity, Layout>::heapMaximum() const {
+  if ( empty() ) {
+    throw std::underflow_error( "KeyedMaxHeap is empty!" );
+  }
+  return keys.front();
+}
+
+template<typename Key, typename Value, size_t Arity, typename Layout>
+const Value& KeyedMaxHeap<Key, Value, Arity, Layout>::maximumValue() const {
+  if ( empty() ) {
+    throw std::underflow_error( "KeyedMaxHeap is empty!" );
+  }
+  return values[ slots.front() ];
+}
+
+template<typename Key, typename Value, size_t Arity, typename Layout>
+typename KeyedMaxHeap<Key, Value, Arity, Layout>::Element KeyedMaxHeap<Key, Value, Arity, Layout>::heapExtractMax() {
+  if ( empty() ) {
+    throw std::underflow_error( "KeyedMaxHeap is empty!" );
+  }
+  return removeAt( 0 );
+}
+
+template<typename Key, typename Value, size_t Arity, typename Layout>
+void KeyedMaxHeap<Key, Value, Arity, Layout>::maxHeapInsert( const Key& key, const Value& value ) {
+  Key key_copy( key );
+  Value value_copy( value );
+  insertKey( std::move( key_copy ), storeValue( std::move( value_copy ) ) );
+}
+
+template<typename Key, typename Value, size_t Arity, typename Layout>
+void KeyedMaxHeap<Key, Value, Arity, Layout>::maxHeapInsert( Key&& key, Value&& value ) {
+  insertKey( std::move( key ), storeValue( std::move( value ) ) );
+}
+
+template<typename Key, typename Value, size_t Arity, typename Layout>
+typename KeyedMaxHeap<Key, Value, Arity, Layout>::Element KeyedMaxHeap<Key, Value, Arity, Layout>::removeAt( size_t index ) {
+  if ( index >= keys.size() ) {
+    throw std::out_of_range( "Index out of range!" );
+  }
+  size_t slot = slots[ index ];
+  Element result( std::move( keys[ index ] ), std::move( values[ slot ] ) );
+  free_slots.push_back( slot );
+  Key last_key = std::move( keys.back() );
+  size_t last_slot = slots.back();
+  keys.pop_back();
+  slots.pop_back();
+  if ( index < keys.size() ) {
+    Sifter sifter( *this, &last_key, last_slot );
+    Sift::restore( sifter, index, keys.size() );
+  }
+  return result;
+}
+
+template<typename Key, typename Value, size_t Arity, typename Layout>
+bool KeyedMaxHeap<Key, Value, Arity, Layout>::isMaxHeap() const {
+  if ( slots.size() != keys.size() || values.size() != keys.size() + free_slots.size() ) {
+    return false;
+  }
+  std::vector<bool> used( values.size(), false );
+  for ( size_t i = 0; i < free_slots.size(); i++ ) {
+    used[ free_slots[ i ] ] = true;
+  }
+  for ( size_t i = 0; i < keys.size(); i++ ) {
+    if ( i > 0 && keys[ Index::parent( i ) ] < keys[ i ] ) {
+      return false;
+    }
+    if ( slots[ i ] >= values.size() || used[ slots[ i ] ] ) {
+      return false;
+    }
+    used[ slots[ i ] ] = true;
+  }
+  return true;
+}
+
+template<typename Key, typename Value, size_t Arity, typename Layout>
+size_t KeyedMaxHeap<Key, Value, Arity, Layout>::storeValue( Value&& value ) {
+  if ( free_slots.empty() ) {
+    values.push_back( std::move( value ) );
+    return values.size() - 1;
+  }
+  size_t slot = free_slots.back();
+  free_slots.pop_back();
+  values[ slot ] = std::move( value );
+  return slot;
+}
+
+template<typename Key, typename Value, size_t Arity, typename Layout>
+void KeyedMaxHeap<Key, Value, Arity, Layout>::insertKey( Key&& key, size_t slot ) {
+  keys.push_back( std::move( key ) );
+  slots.push_back( slot );
+  Key appended = std::move( keys.back() );
+  siftUp( keys.size() - 1, std::move( appended ), slot );
+}
+
+template<typename Key, typename Value, size_t Arity, typename Layout>
+void KeyedMaxHeap<Key, Value, Arity, Layout>::siftUp( size_t hole, Key&& key, size_t slot ) {
+  Sifter sifter( *this, &key, slot );
+  Sift::up( sifter, hole );
+}
+
+#endif
@@ -0,0 +1,469 @@
+#ifndef MAPPEDMAXHEAP_H
+#define MAPPEDMAXHEAP_H
+
+/*
+ * The MIT Licese (MIT)
+ *
+ * Copyright (C) 2016 by Brian Horn, trycatchhorn@gmail.com.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+*/
+
+#include "MaxHeapSift.h"
+#include "MaxHeapSnapshot.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * How MappedMaxHeap opens its file. OPEN_EXISTING maps a snapshot written
+ * by saveMaxHeapSnapshot() or by another MappedMaxHeap, and CREATE_NEW
+ * replaces the file with an empty heap.
+ */
+enum MappedMaxHeapMode {
+  OPEN_EXISTING,
+  CREATE_NEW
+};
+
+/**
+ * A d-ary max-heap of trivially copyable elements kept in a memory-mapped
+ * snapshot file (see MaxHeapSnapshot.h). Opening a snapshot maps it in
+ * O(1) and pages the elements in on demand, so a large heap is usable right
+ * after a restart, without reading records or rebuilding the heap. Every
+ * operation works directly on the mapping, and the file grows by doubling
+ * when the heap outgrows it.
+ *
+ * By default the whole heap is checked with isMaxHeap() when it is opened,
+ * which reads every page once; pass verify = false to skip the check for
+ * a file known to be intact.
+ *
+ * NOTE: changes reach the file when the kernel writes the pages back, and
+ * are durable only after sync(). A crash between two calls of sync() may
+ * leave a file that fails the check on the next open.
+ */
+template<typename T, size_t Arity = 2>
+class MappedMaxHeap {
+
+  static_assert( Arity >= 2, "MappedMaxHeap requires an arity of at least two" );
+  static_assert( std::is_trivially_copyable<T>::value, "MappedMaxHeap requires a trivially copyable type" );
+  static_assert( alignof( T ) <= sizeof( MaxHeapSnapshotHeader ), "MappedMaxHeap requires an alignment of at most 64 bytes" );
+
+ public:
+
+  /**
+   * Opens or creates the max-heap in the specified file. Throws
+   * std::runtime_error if the file cannot be mapped, if its header does
+   * not match T and Arity, or if verify is set and the elements do not
+   * form a max-heap.
+   *
+   * @param path of the snapshot file.
+   * @param mode whether to open an existing snapshot or create a new one.
+   * @param verify whether to check the max-heap property of an existing
+   *        snapshot.
+   */
+  MappedMaxHeap( const std::string& path, MappedMaxHeapMode mode = OPEN_EXISTING, bool verify = true );
+
+  /**
+   * Move constructor, taking over the mapping of the other max-heap.
+   *
+   * @param other the max-heap to be moved.
+   */
+  MappedMaxHeap( MappedMaxHeap<T, Arity>&& other );
+
+  /**
+   * Unmaps and closes the file, without waiting for the changes to reach
+   * the disk.
+   */
+  ~MappedMaxHeap();
+
+  /**
+   * Returns the size of the max-heap.
+   *
+   * @return the size of the max-heap.
+   */
+  size_t getSize() const;
+
+  /**
+   * Returns if the max-heap is empty.
+   *
+   * @return true if the max-heap is empty, otherwise false.
+   */
+  bool empty() const;
+
+  /**
+   * Returns the number of elements the file has room for.
+   *
+   * @return the capacity of the file.
+   */
+  size_t getCapacity() const;
+
+  /**
+   * Returns the mapped array backing the max-heap.
+   *
+   * @return the first element of the max-heap.
+   */
+  const T* data() const;
+
+  /**
+   * Returns the element at the specified index, and throws
+   * std::out_of_range for an index outside the max-heap.
+   *
+   * @param  index in the max-heap.
+   * @return the element at the index.
+   */
+  const T& at( size_t index ) const;
+
+  /**
+   * Returns the element with the maximum key in the max-heap.
+   *
+   * @return the element with the maximum key in the max-heap.
+   */
+  const T& heapMaximum() const;
+
+  /**
+   * Removes and returns the element with the maximum key in the max-heap,
+   * while maintaining the max-heap property.
+   *
+   * @return the element with the maximum key in the max-heap.
+   */
+  T heapExtractMax();
+
+  /**
+   * Inserts the specified key into the max-heap, growing the file if it is
+   * full.
+   *
+   * @param key the key to be inserted into the max-heap.
+   */
+  void maxHeapInsert( const T& key );
+
+  /**
+   * Grows the file to hold at least the specified number of elements.
+   *
+   * @param capacity the number of elements to make room for.
+   */
+  void reserve( size_t capacity );
+
+  /**
+   * Writes the header and the elements of the max-heap to disk and waits
+   * until they are stored. Throws std::runtime_error if that fails.
+   */
+  void sync();
+
+  /**
+   * Determines if this heap satisfies the max-heap property.
+   *
+   * @return true if the heap satisfies the max-heap property, false otherwise.
+   */
+  bool isMaxHeap() const;
+
+ private:
+
+  int descriptor;
+  void* mapping;
+  size_t mapped_bytes;
+  MaxHeapSnapshotHeader* header;
+  T* elements;
+
+  // Snapshots are written in the implicit layout.
+  typedef MaxHeapSift<T, Arity, ImplicitLayout> Sift;
+
+  /**
+   * The accessor through which MaxHeapSift reaches the mapped elements,
+   * holding the key being sifted.
+   */
+  struct Sifter {
+    typedef T KeyType;
+
+    T* elements;
+    const T* held;
+
+    Sifter( T* e, const T* h ) : elements( e ), held( h ) {
+    }
+
+    const T* keys( size_t index ) {
+      return &elements[ index ];
+    }
+
+    bool less( size_t lhs, size_t rhs ) {
+      return elements[ lhs ] < elements[ rhs ];
+    }
+
+    bool heldLess( size_t index ) {
+      return *held < elements[ index ];
+    }
+
+    bool lessHeld( size_t index ) {
+      return elements[ index ] < *held;
+    }
+
+    void compared( uint64_t ) {
+    }
+
+    void move( size_t hole, size_t index ) {
+      elements[ hole ] = elements[ index ];
+    }
+
+    void place( size_t hole ) {
+      elements[ hole ] = *held;
+    }
+  };
+
+  MappedMaxHeap( const MappedMaxHeap<T, Arity>& other );
+  MappedMaxHeap<T, Arity>& operator = ( const MappedMaxHeap<T, Arity>& other );
+
+  /**
+   * Maps the file, which must hold the header and the specified number of
+   * elements. The previous mapping, if any, is replaced only once the new
+   * one succeeded, so on failure the max-heap stays usable.
+   *
+   * @param capacity the number of elements in the file.
+   */
+  void map( size_t capacity );
+
+  /**
+   * Unmaps and closes the file.
+   */
+  void close();
+
+  /**
+   * Moves the specified key up from the hole at the specified index, one
+   * move per level, and places it once at its final position.
+   *
+   * @param hole index of the empty slot in the heap.
+   * @param key the key being sifted up.
+   */
+  void siftUp( size_t hole, const T& key );
+
+  /**
+   * Moves the specified key down from the hole at the specified index, one
+   * move per level, and places it once at its final position.
+   *
+   * @param hole index of the empty slot in the heap.
+   * @param key the key being sifted down.
+   */
+  void siftDown( size_t hole, const T& key );
+
+};
+
+template<typename T, size_t Arity>
+MappedMaxHeap<T, Arity>::MappedMaxHeap( const std::string& path, MappedMaxHeapMode mode, bool verify )
+  : descriptor( -1 ), mapping( 0 ), mapped_bytes( 0 ), header( 0 ), elements( 0 ) {
+  int flags = mode == CREATE_NEW ? O_RDWR | O_CREAT | O_TRUNC : O_RDWR;
+  descriptor = ::open( path.c_str(), flags, 0644 );
+  if ( descriptor < 0 ) {
+    throw std::runtime_error( "Cannot open snapshot " + path + "!" );
+  }
+  try {
+    if ( mode == CREATE_NEW ) {
+      MaxHeapSnapshotHeader created( sizeof( T ), Arity, 0, 0 );
+      if ( ::pwrite( descriptor, &created, sizeof( created ), 0 ) != static_cast<ssize_t>( sizeof( created ) ) ) {
+        throw std::runtime_error( "Cannot write snapshot " + path + "!" );
+      }
+      map( 0 );
+      return;
+    }
+    MaxHeapSnapshotHeader stored( 0, 0, 0, 0 );
+    struct stat status;
+    if ( ::pread( descriptor, &stored, sizeof( stored ), 0 ) != static_cast<ssize_t>( sizeof( stored ) ) || ::fstat( descriptor, &status ) != 0 ) {
+      throw std::runtime_error( "Not a max-heap snapshot!" );
+    }
+    stored.validate( sizeof( T ), Arity );
+    if ( static_cast<uint64_t>( status.st_size ) < sizeof( stored ) + stored.capacity * sizeof( T ) ) {
+      throw std::runtime_error( "Max-heap snapshot is truncated!" );
+    }
+    map( static_cast<size_t>( stored.capacity ) );
+    if ( verify && !isMaxHeap() ) {
+      throw std::runtime_error( "Max-heap snapshot fails the integrity check!" );
+    }
+  }
+  catch ( ... ) {
+    close();
+    throw;
+  }
+}
+
+template<typename T, size_t Arity>
+MappedMaxHeap<T, Arity>::MappedMaxHeap( MappedMaxHeap<T, Arity>&& other )
+  : descriptor( other.descriptor ), mapping( other.mapping ), mapped_bytes( other.mapped_bytes ), header( other.header ), elements( other.elements ) {
+  other.descriptor = -1;
+  other.mapping = 0;
+  other.mapped_bytes = 0;
+  other.header = 0;
+  other.elements = 0;
+}
+
+template<typename T, size_t Arity>
+MappedMaxHeap<T, Arity>::~MappedMaxHeap() {
+  close();
+}
+
+template<typename T, size_t Arity>
+size_t MappedMaxHeap<T, Arity>::getSize() const {
+  return static_cast<size_t>( header->size );
+}
+
+template<typename T, size_t Arity>
+bool MappedMaxHeap<T, Arity>::empty() const {
+  return header->size == 0;
+}
+
+template<typename T, size_t Arity>
+size_t MappedMaxHeap<T, Arity>::getCapacity() const {
+  return static_cast<size_t>( header->capacity );
+}
+
+template<typename T, size_t Arity>
+const T* MappedMaxHeap<T, Arity>::data() const {
+  return elements;
+}
+
+template<typename T, size_t Arity>
+const T& MappedMaxHeap<T, Arity>::at( size_t index ) const {
+  if ( index >= getSize() ) {
+    throw std::out_of_range( "Index out of range!" );
+  }
+  return elements[ index ];
+}
+
+template<typename T, size_t Arity>
+const T& MappedMaxHeap<T, Arity>::heapMaximum() const {
+  if ( empty() ) {
+    throw std::underflow_error( "MappedMaxHeap is empty!" );
+  }
+  return elements[ 0 ];
+}
+
+template<typename T, size_t Arity>
+T MappedMaxHeap<T, Arity>::heapExtractMax() {
+  if ( empty() ) {
+    throw std::underflow_error( "MappedMaxHeap is empty!" );
+  }
+  T result = elements[ 0 ];
+  size_t last = getSize() - 1;
+  header->size = last;
+  if ( last > 0 ) {
+    siftDown( 0, elements[ last ] );
+  }
+  return result;
+}
+
+template<typename T, size_t Arity>
+void MappedMaxHeap<T, Arity>::maxHeapInsert( const T& key ) {
+  T inserted = key;
+  size_t size = getSize();
+  if ( size == getCapacity() ) {
+    reserve( std::max<size_t>( 2 * size, 16 ) );
+  }
+  header->size = size + 1;
+  siftUp( size, inserted );
+}
+
+template<typename T, size_t Arity>
+void MappedMaxHeap<T, Arity>::reserve( size_t capacity ) {
+  if ( capacity <= getCapacity() ) {
+    return;
+  }
+  size_t old_bytes = mapped_bytes;
+  if ( ::ftruncate( descriptor, static_cast<off_t>( sizeof( MaxHeapSnapshotHeader ) + capacity * sizeof( T ) ) ) != 0 ) {
+    throw std::runtime_error( "Cannot grow snapshot file!" );
+  }
+  try {
+    map( capacity );
+  }
+  catch ( ... ) {
+    // The old mapping is still in place, so only the file has to shrink
+    // back; if that fails too, the header simply does not claim the tail.
+    int ignored = ::ftruncate( descriptor, static_cast<off_t>( old_bytes ) );
+    static_cast<void>( ignored );
+    throw;
+  }
+  header->capacity = capacity;
+}
+
+template<typename T, size_t Arity>
+void MappedMaxHeap<T, Arity>::sync() {
+  size_t bytes = sizeof( MaxHeapSnapshotHeader ) + getSize() * sizeof( T );
+  if ( ::msync( mapping, bytes, MS_SYNC ) != 0 ) {
+    throw std::runtime_error( "Cannot sync snapshot file!" );
+  }
+}
+
+template<typename T, size_t Arity>
+bool MappedMaxHeap<T, Arity>::isMaxHeap() const {
+  size_t size = getSize();
+  for ( size_t i = 1; i < size; i++ ) {
+    if ( elements[ Sift::Index::parent( i ) ] < elements[ i ] ) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template<typename T, size_t Arity>
+void MappedMaxHeap<T, Arity>::map( size_t capacity ) {
+  size_t bytes = sizeof( MaxHeapSnapshotHeader ) + capacity * sizeof( T );
+  void* replacement = ::mmap( 0, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0 );
+  if ( replacement == MAP_FAILED ) {
+    throw std::runtime_error( "Cannot map snapshot file!" );
+  }
+  if ( mapping != 0 ) {
+    ::munmap( mapping, mapped_bytes );
+  }
+  mapping = replacement;
+  mapped_bytes = bytes;
+  header = static_cast<MaxHeapSnapshotHeader*>( mapping );
+  elements = reinterpret_cast<T*>( static_cast<char*>( mapping ) + sizeof( MaxHeapSnapshotHeader ) );
+}
+
+template<typename T, size_t Arity>
+void MappedMaxHeap<T, Arity>::close() {
+  if ( mapping != 0 ) {
+    ::munmap( mapping, mapped_bytes );
+    mapping = 0;
+  }
+  if ( descriptor >= 0 ) {
+    ::close( descriptor );
+    descriptor = -1;
+  }
+}
+
+template<typename T, size_t Arity>
+void MappedMaxHeap<T, Arity>::siftUp( size_t hole, const T& key ) {
+  T held = key;
+  Sifter sifter( elements, &held );
+  Sift::up( sifter, hole );
+}
+
+template<typename T, size_t Arity>
+void MappedMaxHeap<T, Arity>::siftDown( size_t hole, const T& key ) {
+  T held = key;
+  Sifter sifter( elements, &held );
+  Sift::down( sifter, hole, getSize() );
+}
+
+#endif
@@ -26,22 +26,90 @@
 */
 
 #include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
 #include <iostream>
 #include <iterator>
 #include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "MaxHeapLayout.h"
+#include "MaxHeapSift.h"
+#include "MaxHeapStats.h"
+
+/**
+ * Algorithm used to build a max-heap from the elements of a vector or an
+ * array. PARALLEL heapifies disjoint subtrees concurrently and then fixes
+ * up the levels above them on the calling thread.
+ */
 enum MaxHeapCreationType {
   ITERATIVE,
-  RECURSIVE
+  RECURSIVE,
+  PARALLEL
 };
 
-template<typename T> class MaxHeap;
-template<typename T> std::ostream& operator << ( std::ostream& s, const MaxHeap<T>& other );
-template<typename T> std::ostream& operator << ( std::ostream& s, std::vector<T> vec );
+/**
+ * Heaps with fewer elements than this are built on the calling thread,
+ * even when PARALLEL is requested, since starting threads would cost more
+ * than heapifying the elements.
+ */
+#ifndef MAXHEAP_PARALLEL_THRESHOLD
+#define MAXHEAP_PARALLEL_THRESHOLD 65536
+#endif
 
-template<typename T>
-class MaxHeap {
+/**
+ * Strategy used to restore the max-heap property after the root, or any
+ * other element, has been replaced by the last element of the heap.
+ *
+ * TOP_DOWN compares the sifted element with the largest child on every
+ * level, which costs Arity comparisons per level.
+ *
+ * BOTTOM_UP (Floyd/Wegener) first moves the hole down to a leaf along the
+ * largest children, which costs Arity - 1 comparisons per level, and then
+ * sifts the element up from the leaf. Since the element usually belongs
+ * near the bottom, this roughly halves the comparisons for binary heaps,
+ * which pays off for keys with an expensive operator<.
+ */
+enum MaxHeapExtractionType {
+  TOP_DOWN,
+  BOTTOM_UP
+};
+
+#ifndef MAXHEAP_DEFAULT_EXTRACTION
+#define MAXHEAP_DEFAULT_EXTRACTION TOP_DOWN
+#endif
+
+template<typename T, size_t Arity = 2, typename Layout = ImplicitLayout, typename Stats = NoMaxHeapStats> class MaxHeap;
+template<typename T, size_t Arity, typename Layout, typename Stats> std::ostream& operator << ( std::ostream& s, const MaxHeap<T, Arity, Layout, Stats>& other );
+template<typename T> std::ostream& operator << ( std::ostream& s, const std::vector<T>& vec );
+
+/**
+ * A max-heap of elements of type T backed by a std::vector. The heap is laid
+ * out implicitly in the vector as a complete d-ary tree, where d is given by
+ * the Arity template parameter (2 gives the classic binary heap). A larger
+ * arity gives a shallower tree, and with 4 to 16 children per node all the
+ * children of a node typically share a single cache line.
+ *
+ * The Layout template parameter selects where the nodes are placed in the
+ * vector (see MaxHeapLayout.h). ImplicitLayout stores the tree level by
+ * level; BHeapLayout packs subtrees into pages, which pays off for heaps
+ * much larger than the last-level cache. The public API is the same for
+ * every layout, but the indices it takes and returns are positions in the
+ * vector, so they depend on the layout.
+ *
+ * The Stats template parameter is an instrumentation policy (see
+ * MaxHeapStats.h) counting comparisons, moves, sift depths, reallocations
+ * and operations, read with getStats(). The default NoMaxHeapStats counts
+ * nothing and costs nothing.
+ */
+template<typename T, size_t Arity, typename Layout, typename Stats>
+class MaxHeap : private Stats {
+
+  static_assert( Arity >= 2, "MaxHeap requires an arity of at least two" );
 
  public:
 
@@ -55,9 +123,15 @@ class MaxHeap {
    * Creates a max-heap from a std::vector. The max-heap is constructed from the
    * elements contained in the vector.
    *
+   * NOTE: an rvalue vector is adopted as the backing vector of the max-heap
+   * without copying its elements, while an lvalue vector is copied once.
+   *
    * @param  vec contains the elements from which the max-heap is constructed.
+   * @param  type the algorithm used to build the max-heap.
+   * @param  threads the number of threads used by a PARALLEL build, where
+   *         zero selects std::thread::hardware_concurrency().
    */
-  MaxHeap( std::vector<T> vec, MaxHeapCreationType type = RECURSIVE );
+  MaxHeap( std::vector<T> vec, MaxHeapCreationType type = RECURSIVE, size_t threads = 0 );
 
   /**
    * Creates a max-heap from an array. The max-heap is constructed from the
@@ -65,8 +139,11 @@ class MaxHeap {
    *
    * @param  arr contains the elements from which the max-heap is constructed.
    * @param  size specifies the upper limit in the specified array from where elements are copied.
+   * @param  type the algorithm used to build the max-heap.
+   * @param  threads the number of threads used by a PARALLEL build, where
+   *         zero selects std::thread::hardware_concurrency().
    */
-  MaxHeap( T arr[], size_t size, MaxHeapCreationType type = RECURSIVE );
+  MaxHeap( T arr[], size_t size, MaxHeapCreationType type = RECURSIVE, size_t threads = 0 );
 
   /**
    * Creates a copy of the specified max-heap.
@@ -74,7 +151,15 @@ class MaxHeap {
    * @param  other a reference to the max-heap from where the copy should be made.
    * @return a copy of the specified max-heap.
    */
-  MaxHeap( const MaxHeap<T> &other );
+  MaxHeap( const MaxHeap<T, Arity, Layout, Stats> &other );
+
+  /**
+   * Creates a max-heap by taking over the elements of the specified
+   * max-heap, which is left empty.
+   *
+   * @param  other the max-heap from where the elements are moved.
+   */
+  MaxHeap( MaxHeap<T, Arity, Layout, Stats> &&other ) noexcept;
 
   /**
    * Returns the index of the parent to the element at the specified
@@ -83,25 +168,35 @@ class MaxHeap {
    * @param   index of element in the max_heap.
    * @return  the index of the parent to the specified element.
    */
-  size_t parentIndex( size_t index ) throw( std::overflow_error );
+  size_t parentIndex( size_t index );
 
   /**
-   * Returns the index of the left child to the element at the specified
-   * index in the max-heap.
+   * Returns the index of the left (first) child to the element at the
+   * specified index in the max-heap.
    *
    * @param   index of element in the max-heap.
    * @return  the index of the left child to the specified element.
    */
-  size_t leftChildIndex( size_t index ) throw( std::overflow_error );
+  size_t leftChildIndex( size_t index );
 
   /**
-   * Returns the index of the right child to the element at the specified
-   * index in the max-heap.
+   * Returns the index of the right (last) child to the element at the
+   * specified index in the max-heap.
    *
    * @param   index of element in the max-heap.
    * @return  the index of the right child to the specified element.
    */
-  size_t rightChildIndex( size_t index ) throw( std::overflow_error );
+  size_t rightChildIndex( size_t index );
+
+  /**
+   * Returns the index of the k'th child, counting from zero, to the element
+   * at the specified index in the max-heap.
+   *
+   * @param   index of element in the max-heap.
+   * @param   k the number of the child, which must be less than Arity.
+   * @return  the index of the k'th child to the specified element.
+   */
+  size_t childIndex( size_t index, size_t k );
 
   /**
    * Returns the parent of the element at the specified
@@ -135,7 +230,7 @@ class MaxHeap {
    *
    * @return the size of the max-heap.
    */
-  size_t getSize();
+  size_t getSize() const;
 
   /**
    * Returns if the max-heap is empty.
@@ -144,13 +239,44 @@ class MaxHeap {
    */
   bool empty() const;
 
+  /**
+   * Reserves storage for at least the specified number of elements, so that
+   * inserting up to that many elements does not reallocate.
+   *
+   * @param  capacity the number of elements to reserve storage for.
+   */
+  void reserve( size_t capacity );
+
+  /**
+   * Returns the array backing the max-heap, of getSize() elements in the
+   * order of the layout. The pointer is invalidated by any change to the
+   * max-heap.
+   *
+   * @return the array backing the max-heap.
+   */
+  const T* data() const;
+
+  /**
+   * Replaces the contents of the max-heap with the specified elements,
+   * which must already be a max-heap in the order of the layout, without
+   * rebuilding it. Throws std::runtime_error if they do not form a
+   * max-heap, leaving both unchanged; otherwise the vector is left empty.
+   *
+   * @param  elements the elements of a max-heap.
+   */
+  void adopt( std::vector<T>& elements );
+
   /**
    * Returns the max-heap element at the specified index.
    *
+   * NOTE: the index is range checked, and std::out_of_range is thrown for
+   * an index outside the max-heap. The internal algorithms of the max-heap
+   * use the unchecked elementAt() instead.
+   *
    * @param  index in the max-heap.
    * @return the max-heap element at the specified index.
    */
-  T at( size_t index );
+  const T& at( size_t index );
 
   /**
    * Sorts the contents in the max-heap by applying the heap-sort algorithm.
@@ -159,27 +285,98 @@ class MaxHeap {
    * 1) Use a vector to contruct a max-heap
    * 2) Apply heapSort() method to the max-heap
    *
+   * The max-heap itself is left untouched; its elements are copied exactly
+   * once and then sorted in place. Use sortInPlace() or sortInto() when the
+   * max-heap is no longer needed afterwards.
+   *
    * @return vector<T> vector is a sorted version of the max-heap
    */
   std::vector<T> heapSort();
 
+  /**
+   * Sorts the max-heap in place and hands out the backing vector, sorted in
+   * descending order, without copying any element. The max-heap is empty
+   * afterwards.
+   *
+   * @return vector<T> the former backing vector of the max-heap in sorted
+   *         (descending) order.
+   */
+  std::vector<T> sortInPlace();
+
+  /**
+   * Moves the elements of the max-heap in descending order into the range
+   * starting at the specified output iterator. No memory is allocated by the
+   * max-heap, and the max-heap is empty afterwards.
+   *
+   * @param  out the beginning of the destination range, which must be able
+   *         to hold getSize() elements.
+   * @return the output iterator one past the last element written.
+   */
+  template<typename OutputIterator>
+  OutputIterator sortInto( OutputIterator out );
+
+  /**
+   * Returns copies of the k largest elements in the max-heap, in descending
+   * order, in O(k log k). The max-heap is neither modified nor copied: its
+   * array is walked from the root with a small frontier heap of candidate
+   * indices, holding the children of every element returned so far.
+   *
+   * @param  k the number of elements to return; at most getSize() are
+   *         returned.
+   * @return vector<T> the k largest elements, largest first.
+   */
+  std::vector<T> peekTopK( size_t k );
+
   /**
    * Returns the element with the maximum key in the max-heap.
    *
    * @return T the element with the maximum key in the max-heap.
    */
-  T heapMaximum() throw( std::underflow_error );
+  const T& heapMaximum();
 
   /**
    * Returns the element with the maximum key in the max-heap.
    *
    * NOTE: the element is removed from the max-heap after
    * the operation and the heap maintains its max-heap
-   * property.
+   * property. The element is moved, not copied, out of the heap.
    *
    * @return T the element with the maximum key in the max-heap.
    */
-  T heapExtractMax() throw( std::underflow_error );
+  T heapExtractMax();
+
+  /**
+   * Replaces the element with the maximum key in the max-heap by the
+   * specified element, and returns the former maximum. This is equivalent
+   * to heapExtractMax() followed by maxHeapInsert(), but sifts only once.
+   *
+   * NOTE: std::underflow_error is thrown if the max-heap is empty.
+   *
+   * @param  key the element to insert in place of the maximum.
+   * @return T the former element with the maximum key in the max-heap.
+   */
+  T heapReplaceMax( const T& key );
+
+  /**
+   * Replaces the element with the maximum key in the max-heap by the
+   * specified element, which is moved into the max-heap.
+   *
+   * @param  key the element to insert in place of the maximum.
+   * @return T the former element with the maximum key in the max-heap.
+   */
+  T heapReplaceMax( T&& key );
+
+  /**
+   * Removes the specified number of elements with the largest keys from the
+   * max-heap and returns them in descending order, in O(count log n). Taking
+   * half of the elements splits the work of one max-heap between two
+   * owners, with the larger keys going to the caller.
+   *
+   * @param  count the number of elements to remove; at most getSize()
+   *         elements are removed.
+   * @return vector<T> the removed elements, largest first.
+   */
+  std::vector<T> extractBatch( size_t count );
 
   /**
    * Inserts the specified key into the max-heap and
@@ -187,7 +384,113 @@ class MaxHeap {
    *
    * @param key the key to be inserted into the max-heap.
    */
-  void maxHeapInsert( const T key );
+  void maxHeapInsert( const T& key );
+
+  /**
+   * Inserts the specified key into the max-heap by moving it, and
+   * maintains the max-heap property.
+   *
+   * @param key the key to be moved into the max-heap.
+   */
+  void maxHeapInsert( T&& key );
+
+  /**
+   * Constructs a new element in place at the end of the backing vector
+   * from the specified arguments, and moves it up to maintain the max-heap
+   * property.
+   *
+   * @param args the arguments forwarded to the constructor of T.
+   */
+  template<typename... Args>
+  void emplace( Args&&... args );
+
+  /**
+   * Inserts the elements in the range [first, last) into the max-heap and
+   * maintains the max-heap property. The elements are appended to the
+   * backing vector in one go, which allocates at most once for forward
+   * iterators. Small batches are then sifted up one by one, while larger
+   * batches rebuild only the subtrees above the appended elements, bottom
+   * up, like buildMaxHeapIterative().
+   *
+   * NOTE: use std::make_move_iterator to move the elements into the heap.
+   *
+   * @param first the beginning of the range of elements to be inserted.
+   * @param last the end of the range of elements to be inserted.
+   */
+  template<typename InputIterator>
+  void insertRange( InputIterator first, InputIterator last );
+
+  /**
+   * Replaces the element at the specified index with a key that is not
+   * smaller, and moves it up as necessary to maintain the max-heap property.
+   *
+   * @param index of the element in the max-heap.
+   * @param key the new key, which must not be smaller than the current key.
+   */
+  void increaseKey( size_t index, T key );
+
+  /**
+   * Replaces the element at the specified index with a key that is not
+   * larger, and moves it down as necessary to maintain the max-heap property.
+   *
+   * @param index of the element in the max-heap.
+   * @param key the new key, which must not be larger than the current key.
+   */
+  void decreaseKey( size_t index, T key );
+
+  /**
+   * Replaces the element at the specified index with the specified key,
+   * and moves it up or down as necessary to maintain the max-heap property.
+   *
+   * @param index of the element in the max-heap.
+   * @param key the new key.
+   */
+  void updateKey( size_t index, T key );
+
+  /**
+   * Replaces several elements at once and restores the max-heap property a
+   * single time afterwards. The range holds std::pair<size_t, T> values,
+   * each giving an index in the max-heap and the new key for that index.
+   * Only the changed elements and their ancestors are heapified, unless so
+   * many keys change that rebuilding the whole max-heap is cheaper.
+   *
+   * @param first the beginning of the range of index and key pairs.
+   * @param last the end of the range of index and key pairs.
+   */
+  template<typename InputIterator>
+  void updateKeys( InputIterator first, InputIterator last );
+
+  /**
+   * Returns the strategy used by heapExtractMax(), heapSort() and
+   * removeAt() to sift elements down. Unless changed with
+   * setExtractionType(), this is MAXHEAP_DEFAULT_EXTRACTION, which may be
+   * defined before including this header and defaults to TOP_DOWN.
+   *
+   * @return the extraction strategy of the max-heap.
+   */
+  MaxHeapExtractionType getExtractionType() const;
+
+  /**
+   * Selects the strategy used by heapExtractMax(), heapSort() and
+   * removeAt() to sift elements down.
+   *
+   * @param type the extraction strategy to be used by the max-heap.
+   */
+  void setExtractionType( MaxHeapExtractionType type );
+
+  /**
+   * Returns a snapshot of the counts of the instrumentation policy: those
+   * of the max-heap for InstanceMaxHeapStats, those of the calling thread
+   * for ThreadLocalMaxHeapStats, and zero for NoMaxHeapStats.
+   *
+   * @return the counts of the instrumentation policy.
+   */
+  MaxHeapStats getStats() const;
+
+  /**
+   * Sets the counts of the instrumentation policy to zero.
+   */
+  void resetStats();
 
   /**
    * Determines if the element at the specified index is a leaf element
@@ -225,9 +528,18 @@ class MaxHeap {
    * the call are either assigned to or destroyed.
    *
    * @param  other the max-heap from where the elements are copied.
-   * @return a copy of the specified max-heap.
+   * @return a reference to this max-heap.
+   */
+  MaxHeap<T, Arity, Layout, Stats>& operator = ( const MaxHeap<T, Arity, Layout, Stats>& other );
+
+  /**
+   * Move assignment operator replaces the contents of the max-heap with
+   * the elements of 'other', which is left empty.
+   *
+   * @param  other the max-heap from where the elements are moved.
+   * @return a reference to this max-heap.
    */
-  MaxHeap<T>& operator = ( MaxHeap<T>& other );
+  MaxHeap<T, Arity, Layout, Stats>& operator = ( MaxHeap<T, Arity, Layout, Stats>&& other ) noexcept;
 
   /**
    * Equal operator determines if the two max-heaps specified
@@ -237,8 +549,8 @@ class MaxHeap {
    * @param  rhs the max-heap at the right-hand side of the equal operator.
    * @return true if the two specified max-heaps are equal.
    */
-  template<typename F>
-  friend bool operator == ( const MaxHeap<F>& lhs, const MaxHeap<F>& rhs );
+  template<typename F, size_t A, typename L, typename S>
+  friend bool operator == ( const MaxHeap<F, A, L, S>& lhs, const MaxHeap<F, A, L, S>& rhs );
 
   /**
    * Inequal operator determines if the two max-heaps specified
@@ -248,8 +560,8 @@ class MaxHeap {
    * @param  rhs the max-heap at the right-hand side of the inequal operator.
    * @return true if the two specified max-heaps are inequal.
    */
-  template<typename F>
-  friend bool operator != ( const MaxHeap<F>& lhs, const MaxHeap<F>& rhs );
+  template<typename F, size_t A, typename L, typename S>
+  friend bool operator != ( const MaxHeap<F, A, L, S>& lhs, const MaxHeap<F, A, L, S>& rhs );
 
   /**
    * Output stream operator for the max-heap
@@ -258,7 +570,7 @@ class MaxHeap {
    * @param  other the max-heap at the right-hand side of the output stream operator.
    * @return the output stream for the max-heap.
    */
-  friend std::ostream& operator << <T> ( std::ostream& s, const MaxHeap<T>& other );
+  friend std::ostream& operator << <T, Arity, Layout, Stats> ( std::ostream& s, const MaxHeap<T, Arity, Layout, Stats>& other );
 
   /**
    * Output stream operator for the vector backing the max-heap.
@@ -267,10 +579,149 @@ class MaxHeap {
    * @param  vec is the vector at the right-hand side of the output stream operator.
    * @return the output stream for the vector.
    */
-  friend std::ostream& operator << <T> ( std::ostream& s, std::vector<T> vec );
+  friend std::ostream& operator << <T> ( std::ostream& s, const std::vector<T>& vec );
 
  private:
+  typedef typename Layout::template Index<T, Arity> Index;
+  typedef MaxHeapSift<T, Arity, Layout> Sift;
+
   std::vector<T> heap;
+  MaxHeapExtractionType extraction_type;
+
+  /**
+   * Returns the instrumentation policy. It is a private base rather than a
+   * member, so that an empty policy such as NoMaxHeapStats takes no space.
+   *
+   * @return the instrumentation policy.
+   */
+  Stats& stats() {
+    return *this;
+  }
+
+  const Stats& stats() const {
+    return *this;
+  }
+
+  /**
+   * The accessor through which MaxHeapSift reaches the elements. It owns
+   * the key being sifted, so that the key can stay in a register instead
+   * of being reloaded after every store into the heap. Comparisons and
+   * moves are counted with the instrumentation policy.
+   */
+  struct Sifter {
+    typedef T KeyType;
+
+    MaxHeap<T, Arity, Layout, Stats>& owner;
+    T held;
+
+    Sifter( MaxHeap<T, Arity, Layout, Stats>& o, T&& h ) : owner( o ), held( std::move( h ) ) {
+    }
+
+    const T* keys( size_t index ) {
+      return &owner.elementAt( index );
+    }
+
+    bool less( size_t lhs, size_t rhs ) {
+      return owner.less( owner.elementAt( lhs ), owner.elementAt( rhs ) );
+    }
+
+    bool heldLess( size_t index ) {
+      return owner.less( held, owner.elementAt( index ) );
+    }
+
+    bool lessHeld( size_t index ) {
+      return owner.less( owner.elementAt( index ), held );
+    }
+
+    void compared( uint64_t n ) {
+      owner.stats().compared( n );
+    }
+
+    void move( size_t hole, size_t index ) {
+      owner.elementAt( hole ) = std::move( owner.elementAt( index ) );
+      owner.stats().moved();
+      owner.stats().descended();
+    }
+
+    void place( size_t hole ) {
+      owner.elementAt( hole ) = std::move( held );
+      owner.stats().moved();
+      owner.stats().sifted();
+    }
+  };
+
+  /**
+   * A candidate of peekTopK(): the index of an element in the max-heap,
+   * ordered by the element it refers to.
+   */
+  struct Candidate {
+    const T* key;
+    size_t index;
+
+    Candidate( const T* k, size_t i ) : key( k ), index( i ) {
+    }
+
+    bool operator<( const Candidate& other ) const {
+      return *key < *other.key;
+    }
+  };
+
+  /**
+   * Returns a reference to the max-heap element at the specified index
+   * without range checking the index. Every index passed by the heapify,
+   * sift and sort routines is known to be inside the max-heap.
+   *
+   * @param   index of element in the max-heap.
+   * @return  a reference to the element at the specified index.
+   */
+  T& elementAt( size_t index );
+
+  /**
+   * Compares two elements with operator<, counting the comparison with the
+   * instrumentation policy. The hot paths compare through less().
+   *
+   * @param   lhs the element at the left-hand side of the comparison.
+   * @param   rhs the element at the right-hand side of the comparison.
+   * @return  true if lhs is less than rhs.
+   */
+  bool less( const T& lhs, const T& rhs );
+
+  /**
+   * Returns the index of the parent to the element at the specified index
+   * without range checking the index, which must be greater than zero.
+   *
+   * @param   index of element in the max-heap.
+   * @return  the index of the parent to the specified element.
+   */
+  static size_t parentOf( size_t index );
+
+  /**
+   * Returns the index of the first child to the element at the specified
+   * index without range checking the index.
+   *
+   * @param   index of element in the max-heap.
+   * @return  the index of the first child to the specified element.
+   */
+  static size_t firstChildOf( size_t index );
+
+  /**
+   * Returns the index of the k-th child to the element at the specified
+   * index without range checking the index. The children of an element are
+   * only contiguous in the implicit layout.
+   *
+   * @param   index of element in the max-heap.
+   * @param   k the number of the child, which must be less than Arity.
+   * @return  the index of the k-th child to the specified element.
+   */
+  static size_t childOf( size_t index, size_t k );
+
+  /**
+   * Verifies the max-heap property after a mutation when the header is
+   * compiled with MAXHEAP_DEBUG_INVARIANTS defined, and throws
+   * std::logic_error if it is violated. The check costs O(n) per mutation.
+   * Without MAXHEAP_DEBUG_INVARIANTS it does nothing.
+   */
+  void checkInvariants();
 
   /**
    * Responsible for maintaining the max-heap property of the max-heap.
@@ -283,6 +734,19 @@ class MaxHeap {
   */
   void maxHeapifyRecursive( size_t index );
 
+  /**
+   * Recursive step of maxHeapifyRecursive(index). The key being sifted
+   * down is held by the sifter, while the slot at 'hole' is treated as
+   * empty. Each level moves the largest child up into the hole, and the key
+   * is written once when it reaches its final position.
+   *
+   * @param   sifter holding the key being sifted down.
+   * @param   hole index of the empty slot in the max-heap.
+   * @param   size the number of elements at the front of the backing vector
+   *          that form the max-heap.
+  */
+  void maxHeapifyRecursive( Sifter& sifter, size_t hole, size_t size );
+
   /**
    * Responsible for maintaining the max-heap property of the max-heap.
    * This function assumes that the subtree located at the left
@@ -310,6 +774,61 @@ class MaxHeap {
    */
   void buildMaxHeapIterative();
 
+  /**
+   * Responsible for building the max-heap bottom up using several threads.
+   * It picks the shallowest level with enough nodes to keep every thread
+   * busy, heapifies the subtrees rooted at that level concurrently, and
+   * then calls maxHeapify on the levels above it on the calling thread.
+   * After calling this function the max-heap satisfies the max-heap property.
+   * NOTE: heaps smaller than MAXHEAP_PARALLEL_THRESHOLD, a single thread, or
+   * an instrumentation policy that is not PARALLEL_SAFE, fall back to
+   * buildMaxHeapIterative().
+   *
+   * @param  threads the number of threads, where zero selects
+   *         std::thread::hardware_concurrency().
+   */
+  void buildMaxHeapParallel( size_t threads );
+
+  /**
+   * Builds the subtree rooted at the specified index into a max-heap,
+   * bottom up and level by level. Only elements inside the subtree are
+   * touched, so disjoint subtrees may be built concurrently.
+   *
+   * @param  root the index of the root of the subtree.
+   */
+  void buildMaxHeapSubtree( size_t root );
+
+  /**
+   * Builds the max-heap with the specified algorithm.
+   *
+   * @param  type the algorithm used to build the max-heap.
+   * @param  threads the number of threads used by a PARALLEL build.
+   */
+  void buildMaxHeap( MaxHeapCreationType type, size_t threads );
+
+  /**
+   * Restores the max-heap property after the elements in [begin, end) have
+   * been appended to a max-heap of 'begin' elements. Starting with the
+   * parents of the appended elements, it calls maxHeapify on every ancestor
+   * of the appended elements, one level at a time, bottom up. Subtrees that
+   * hold no appended element are left untouched.
+   *
+   * @param  begin the index of the first appended element.
+   * @param  end the index one past the last appended element.
+   */
+  void buildMaxHeapAppended( size_t begin, size_t end );
+
+  /**
+   * Restores the max-heap property after the elements at the specified
+   * indices have been replaced. It calls maxHeapify on every changed
+   * element and every ancestor of a changed element, in decreasing index
+   * order, like buildMaxHeapIterative() restricted to the subtrees that
+   * hold a change.
+   *
+   * @param  changed the indices of the replaced elements.
+   */
+  void buildMaxHeapChanged( const std::vector<size_t>& changed );
+
   /**
    * Inserts new elements into the max-heap by allowing the specified key to
    * propagate up through the max-heap as necessary. The idea is that index will
@@ -319,22 +838,71 @@ class MaxHeap {
    * @param  index at which the heap will initially be overwritten with element key.
    * @param  key value of element to be inserted at the specified index.
    */
-  void heapIncreaseKey( int index, T key ) throw( std::invalid_argument );
+  void heapIncreaseKey( size_t index, T key );
+
+  /**
+   * Moves the specified key up from the hole at the specified index. Each
+   * smaller ancestor is moved one level down into the hole, and the key is
+   * written once when it reaches its final position. This costs one element
+   * move per level, compared to the three moves done by swapping.
+   *
+   * @param  hole index of the empty slot in the max-heap.
+   * @param  key value of the element being sifted up.
+   */
+  void siftUp( size_t hole, T&& key );
+
+  /**
+   * Moves the element at the specified index up until its parent is not
+   * less than it. The element is only taken out of the heap when it has
+   * to move.
+   *
+   * @param  index of the element to be sifted up.
+   */
+  void siftUp( size_t index );
 
   /**
-   * Swaps the elements in the max-heap specified by the indices.
+   * Moves the specified key down from the hole at the specified index. Each
+   * level moves the largest child up into the hole, and the key is written
+   * once when it is not less than any of the children of the hole, or the
+   * hole has become a leaf.
    *
-   * @param  i the first index of the heap element to be swapped.
-   * @param  j the second index of the heap element to be swapped.
+   * @param  hole index of the empty slot in the max-heap.
+   * @param  key value of the element being sifted down.
+   * @param  size the number of elements at the front of the backing vector
+   *         that form the max-heap.
    */
-  void heapSwap( size_t i, size_t j );
+  void siftDown( size_t hole, T&& key, size_t size );
 
   /**
-   * Compares node at index 'index' with the left node and moves
+   * Moves the hole at the specified index down to a leaf, each level moving
+   * the largest child up into the hole, and then moves the specified key up
+   * from the leaf, but not above the starting index, until its parent is
+   * not less than it. The key is written once at its final position.
+   *
+   * @param  hole index of the empty slot in the max-heap.
+   * @param  key value of the element being sifted down.
+   * @param  size the number of elements at the front of the backing vector
+   *         that form the max-heap.
+   */
+  void siftDownBottomUp( size_t hole, T&& key, size_t size );
+
+  /**
+   * Moves the specified key down from the hole at the specified index
+   * using the extraction strategy of the max-heap.
+   *
+   * @param  hole index of the empty slot in the max-heap.
+   * @param  key value of the element being sifted down.
+   * @param  size the number of elements at the front of the backing vector
+   *         that form the max-heap.
+   */
+  void siftDownExtract( size_t hole, T&& key, size_t size );
+
+  /**
+   * Compares node at index 'index' with its children and moves
    * the node at index i down the heap by successively exchanging
-   * the node with the smaller of its two children. The operation
-   * continues until the node reaches a position where it is less
-   * than both its children, or, failing that, until it reaches a
+   * the node with the largest of its children. The operation
+   * continues until the node reaches a position where it is not less
+   * than any of its children, or, failing that, until it reaches a
    * leaf nodee.
    *
    * @param  index the index of the heap element to be propageated.
@@ -343,297 +911,727 @@ class MaxHeap {
 
 };
 
-template<typename T>
-MaxHeap<T>::MaxHeap() {
+template<typename T, size_t Arity, typename Layout, typename Stats>
+MaxHeap<T, Arity, Layout, Stats>::MaxHeap() : extraction_type( MAXHEAP_DEFAULT_EXTRACTION ) {
 }
 
 // Constructor from vector
-template<typename T>
-MaxHeap<T>::MaxHeap( std::vector<T> v, MaxHeapCreationType type ) {
-  heap = v;
-  if ( type == ITERATIVE ) {
-    buildMaxHeapIterative();
-  } else {
-    buildMaxHeapRecursive();
-  }
+template<typename T, size_t Arity, typename Layout, typename Stats>
+MaxHeap<T, Arity, Layout, Stats>::MaxHeap( std::vector<T> v, MaxHeapCreationType type, size_t threads ) :
+  heap( std::move( v ) ), extraction_type( MAXHEAP_DEFAULT_EXTRACTION ) {
+  buildMaxHeap( type, threads );
+  checkInvariants();
 }
 
 // Constructor from array
-template<typename T>
-MaxHeap<T>::MaxHeap( T arr[], size_t size, MaxHeapCreationType type ) {
-  std::vector<T> v( arr, arr + size );
-  heap = v;
-  if ( type == ITERATIVE ) {
-    buildMaxHeapIterative();
-  } else {
-    buildMaxHeapRecursive();
-  }
+template<typename T, size_t Arity, typename Layout, typename Stats>
+MaxHeap<T, Arity, Layout, Stats>::MaxHeap( T arr[], size_t size, MaxHeapCreationType type, size_t threads ) :
+  heap( arr, arr + size ), extraction_type( MAXHEAP_DEFAULT_EXTRACTION ) {
+  buildMaxHeap( type, threads );
+  checkInvariants();
 }
 
 // Copy constructor
-template<typename T>
-MaxHeap<T>::MaxHeap( const MaxHeap<T> &other ) : heap( other.heap ) {
+template<typename T, size_t Arity, typename Layout, typename Stats>
+MaxHeap<T, Arity, Layout, Stats>::MaxHeap( const MaxHeap<T, Arity, Layout, Stats> &other ) :
+  Stats( other.stats() ), heap( other.heap ), extraction_type( other.extraction_type ) {
 }
 
-template<typename T>
-size_t MaxHeap<T>::getSize() {
+// Move constructor
+template<typename T, size_t Arity, typename Layout, typename Stats>
+MaxHeap<T, Arity, Layout, Stats>::MaxHeap( MaxHeap<T, Arity, Layout, Stats> &&other ) noexcept :
+  Stats( other.stats() ), heap( std::move( other.heap ) ), extraction_type( other.extraction_type ) {
+  other.heap.clear();
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+size_t MaxHeap<T, Arity, Layout, Stats>::getSize() const {
   return heap.size();
 }
 
-template<typename T>
-bool MaxHeap<T>::empty() const {
+template<typename T, size_t Arity, typename Layout, typename Stats>
+void MaxHeap<T, Arity, Layout, Stats>::reserve( size_t capacity ) {
+  size_t before = heap.capacity();
+  heap.reserve( capacity );
+  stats().reallocated( before, heap.capacity() );
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+const T* MaxHeap<T, Arity, Layout, Stats>::data() const {
+  return heap.data();
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+void MaxHeap<T, Arity, Layout, Stats>::adopt( std::vector<T>& elements ) {
+  heap.swap( elements );
+  if ( !isMaxHeap() ) {
+    heap.swap( elements );
+    throw std::runtime_error( "Elements do not form a max-heap!" );
+  }
+  elements.clear();
+  checkInvariants();
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+bool MaxHeap<T, Arity, Layout, Stats>::empty() const {
   return heap.empty();
 }
 
-template<typename T>
-size_t MaxHeap<T>::parentIndex( size_t index ) throw( std::overflow_error ) {
+template<typename T, size_t Arity, typename Layout, typename Stats>
+size_t MaxHeap<T, Arity, Layout, Stats>::parentIndex( size_t index ) {
   if ( index > heap.size() ) {
     throw std::overflow_error( "No parent at specified index" );
   }
-  return ( index - 1 ) / 2;
+  return parentOf( index );
 }
 
-template<typename T>
-size_t MaxHeap<T>::leftChildIndex( size_t index ) throw( std::overflow_error ) {
+template<typename T, size_t Arity, typename Layout, typename Stats>
+size_t MaxHeap<T, Arity, Layout, Stats>::leftChildIndex( size_t index ) {
   if ( index > heap.size() ) {
     throw std::overflow_error( "No left child at specified index" );
   }
-  return 2 * index + 1;
+  return firstChildOf( index );
 }
 
-template<typename T>
-size_t MaxHeap<T>::rightChildIndex( size_t index ) throw( std::overflow_error ) {
+template<typename T, size_t Arity, typename Layout, typename Stats>
+size_t MaxHeap<T, Arity, Layout, Stats>::rightChildIndex( size_t index ) {
   if ( index > heap.size() ) {
     throw std::overflow_error( "No right child at specified index" );
   }
-  return 2 * index + 2;
+  return childOf( index, Arity - 1 );
 }
 
-template<typename T>
-T MaxHeap<T>::parent( size_t index ) {
+template<typename T, size_t Arity, typename Layout, typename Stats>
+size_t MaxHeap<T, Arity, Layout, Stats>::childIndex( size_t index, size_t k ) {
+  if ( index > heap.size() || k >= Arity ) {
+    throw std::overflow_error( "No child at specified index" );
+  }
+  return childOf( index, k );
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+T MaxHeap<T, Arity, Layout, Stats>::parent( size_t index ) {
   return at( parentIndex( index ) );
 }
 
-template<typename T>
-T MaxHeap<T>::leftChild( size_t index ) {
+template<typename T, size_t Arity, typename Layout, typename Stats>
+T MaxHeap<T, Arity, Layout, Stats>::leftChild( size_t index ) {
   return at( leftChildIndex( index ) );
 }
 
-template<typename T>
-T MaxHeap<T>::rightChild( size_t index ) {
+template<typename T, size_t Arity, typename Layout, typename Stats>
+T MaxHeap<T, Arity, Layout, Stats>::rightChild( size_t index ) {
   return at( rightChildIndex( index ) );
 }
 
-template<typename T>
-void MaxHeap<T>::maxHeapifyRecursive( size_t index ) {
-  size_t left_child_index = leftChildIndex( index );
-  size_t right_child_index = rightChildIndex( index );
-  size_t largest;
-  size_t heap_size = heap.size();
-  if ( left_child_index < heap_size && at( left_child_index ) > at( index ) ) {
-    largest = left_child_index;
-  } else {
-    largest = index;
+template<typename T, size_t Arity, typename Layout, typename Stats>
+T& MaxHeap<T, Arity, Layout, Stats>::elementAt( size_t index ) {
+  return heap[ index ];
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+bool MaxHeap<T, Arity, Layout, Stats>::less( const T& lhs, const T& rhs ) {
+  stats().compared();
+  return lhs < rhs;
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+size_t MaxHeap<T, Arity, Layout, Stats>::parentOf( size_t index ) {
+  return Index::parent( index );
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+size_t MaxHeap<T, Arity, Layout, Stats>::firstChildOf( size_t index ) {
+  return Index::child( index, 0 );
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+size_t MaxHeap<T, Arity, Layout, Stats>::childOf( size_t index, size_t k ) {
+  return Index::child( index, k );
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+void MaxHeap<T, Arity, Layout, Stats>::checkInvariants() {
+#ifdef MAXHEAP_DEBUG_INVARIANTS
+  if ( !isMaxHeap() ) {
+    throw std::logic_error( "MaxHeap property violated!" );
   }
-  if ( right_child_index < heap_size && at( right_child_index ) > at( largest ) ) {
-    largest = right_child_index;
+#endif
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+void MaxHeap<T, Arity, Layout, Stats>::maxHeapifyRecursive( size_t index ) {
+  if ( firstChildOf( index ) >= heap.size() ) {
+    return;
   }
-  if ( largest != index ) {
-    heapSwap( index, largest );
-    maxHeapifyRecursive( largest );
+  Sifter sifter( *this, std::move( elementAt( index ) ) );
+  maxHeapifyRecursive( sifter, index, heap.size() );
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+void MaxHeap<T, Arity, Layout, Stats>::maxHeapifyRecursive( Sifter& sifter, size_t hole, size_t size ) {
+  if ( firstChildOf( hole ) < size ) {
+    size_t largest = Sift::maxChild( sifter, hole, size );
+    if ( sifter.heldLess( largest ) ) {
+      sifter.move( hole, largest );
+      maxHeapifyRecursive( sifter, largest, size );
+      return;
+    }
   }
+  sifter.place( hole );
 }
 
-template<typename T>
-void MaxHeap<T>::maxHeapifyIterative( size_t index ) {
-  size_t left_child_index = leftChildIndex( index );
-  while ( left_child_index < heap.size() ) {
-    size_t right_child_index = left_child_index + 1;
-    if ( right_child_index == heap.size() ) {
-      if ( at( left_child_index ) > at( index ) ) {
-        heapSwap( left_child_index, index );
+template<typename T, size_t Arity, typename Layout, typename Stats>
+void MaxHeap<T, Arity, Layout, Stats>::maxHeapifyIterative( size_t index ) {
+  if ( firstChildOf( index ) >= heap.size() ) {
+    return;
+  }
+  T key = std::move( elementAt( index ) );
+  siftDown( index, std::move( key ), heap.size() );
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+void MaxHeap<T, Arity, Layout, Stats>::buildMaxHeapRecursive() {
+  size_t size = heap.size();
+  for ( size_t i = Index::internalEnd( size ); i > 0; --i ) {
+    maxHeapifyRecursive( i - 1 );
+  }
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+void MaxHeap<T, Arity, Layout, Stats>::buildMaxHeapIterative() {
+  size_t size = heap.size();
+  for ( size_t i = Index::internalEnd( size ); i > 0; --i ) {
+    maxHeapifyIterative( i - 1 );
+  }
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+void MaxHeap<T, Arity, Layout, Stats>::buildMaxHeapParallel( size_t threads ) {
+  size_t size = heap.size();
+  if ( threads == 0 ) {
+    threads = std::max( 1u, std::thread::hardware_concurrency() );
+  }
+  if ( threads == 1 || size < MAXHEAP_PARALLEL_THRESHOLD || !Index::LEVEL_ORDER || !Stats::PARALLEL_SAFE ) {
+    buildMaxHeapIterative();
+    return;
+  }
+
+  // Find the shallowest level with a few subtrees per thread, so that
+  // uneven subtrees at the bottom of the heap still balance out.
+  size_t level_begin = 0;
+  size_t level_width = 1;
+  while ( level_width < 8 * threads && firstChildOf( level_begin ) < size ) {
+    level_begin = firstChildOf( level_begin );
+    level_width *= Arity;
+  }
+  size_t level_end = std::min( level_begin + level_width, size );
+
+  std::atomic<size_t> next_root( level_begin );
+  std::vector<std::exception_ptr> errors( threads );
+  std::vector<std::thread> workers;
+  workers.reserve( threads );
+  for ( size_t t = 0; t < threads; t++ ) {
+    workers.push_back( std::thread( [ this, t, level_end, &next_root, &errors ]() {
+      try {
+        size_t root;
+        while ( ( root = next_root.fetch_add( 1 ) ) < level_end ) {
+          buildMaxHeapSubtree( root );
+        }
+      } catch ( ... ) {
+        errors[ t ] = std::current_exception();
       }
-      return;
+    } ) );
+  }
+  for ( size_t t = 0; t < threads; t++ ) {
+    workers[ t ].join();
+  }
+  for ( size_t t = 0; t < threads; t++ ) {
+    if ( errors[ t ] ) {
+      std::rethrow_exception( errors[ t ] );
     }
-    size_t choice = right_child_index;
-    if ( at( left_child_index ) > at( right_child_index ) ) {
-      choice = left_child_index;
+  }
+
+  // Fix up the levels above the concurrently built subtrees.
+  for ( size_t i = level_begin; i > 0; --i ) {
+    maxHeapifyIterative( i - 1 );
+  }
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+void MaxHeap<T, Arity, Layout, Stats>::buildMaxHeapSubtree( size_t root ) {
+  size_t size = heap.size();
+  // The descendants of root at a given depth occupy a contiguous range of
+  // the heap, starting at level_begin[ depth ] and level_width[ depth ] wide.
+  size_t level_begin[ 64 ];
+  size_t level_width[ 64 ];
+  size_t depth = 0;
+  size_t begin = root;
+  size_t width = 1;
+  while ( begin < size ) {
+    level_begin[ depth ] = begin;
+    level_width[ depth ] = width;
+    depth++;
+    begin = firstChildOf( begin );
+    width *= Arity;
+  }
+  for ( size_t d = depth; d > 0; --d ) {
+    size_t end = std::min( level_begin[ d - 1 ] + level_width[ d - 1 ], size );
+    for ( size_t i = end; i > level_begin[ d - 1 ]; --i ) {
+      maxHeapifyIterative( i - 1 );
     }
-    if ( at( choice ) < at( index ) ) {
-      return;
+  }
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+void MaxHeap<T, Arity, Layout, Stats>::buildMaxHeapAppended( size_t begin, size_t end ) {
+  if ( begin == end ) {
+    return;
+  }
+  if ( begin == 0 ) {
+    buildMaxHeapIterative();
+    return;
+  }
+  if ( !Index::LEVEL_ORDER ) {
+    std::vector<size_t> appended;
+    appended.reserve( end - begin );
+    for ( size_t i = begin; i < end; i++ ) {
+      appended.push_back( i );
+    }
+    buildMaxHeapChanged( appended );
+    return;
+  }
+  // The parents of a contiguous range of elements form a contiguous range
+  // one level up, so every level of ancestors is a range [low, high].
+  size_t low = parentOf( begin );
+  size_t high = parentOf( end - 1 );
+  while ( true ) {
+    for ( size_t i = high + 1; i > low; --i ) {
+      maxHeapifyIterative( i - 1 );
+    }
+    if ( low == 0 ) {
+      break;
     }
-    heapSwap( index, choice );
-    index = choice;
-    left_child_index = 2 * index + 1;
+    low = parentOf( low );
+    high = parentOf( high );
   }
 }
 
-template<typename T>
-void MaxHeap<T>::buildMaxHeapRecursive() {
+template<typename T, size_t Arity, typename Layout, typename Stats>
+void MaxHeap<T, Arity, Layout, Stats>::buildMaxHeapChanged( const std::vector<size_t>& changed ) {
   size_t size = heap.size();
-  for ( int i = size / 2 - 1; i >= 0; --i ) {
-    maxHeapifyRecursive( i );
+  size_t height = 1;
+  for ( size_t n = size; n >= Arity; n /= Arity ) {
+    height++;
+  }
+  if ( changed.size() * height >= size ) {
+    buildMaxHeapIterative();
+    return;
+  }
+  std::vector<size_t> nodes;
+  nodes.reserve( changed.size() * height );
+  for ( size_t i = 0; i < changed.size(); i++ ) {
+    size_t index = changed[ i ];
+    nodes.push_back( index );
+    while ( index > 0 ) {
+      index = parentOf( index );
+      nodes.push_back( index );
+    }
+  }
+  std::sort( nodes.begin(), nodes.end() );
+  nodes.erase( std::unique( nodes.begin(), nodes.end() ), nodes.end() );
+  for ( size_t i = nodes.size(); i > 0; --i ) {
+    maxHeapifyIterative( nodes[ i - 1 ] );
   }
 }
 
-template<typename T>
-void MaxHeap<T>::buildMaxHeapIterative() {
-  size_t size = heap.size();
-  for ( int i = size / 2 - 1; i >= 0; --i ) {
-    maxHeapifyIterative( i );
+template<typename T, size_t Arity, typename Layout, typename Stats>
+void MaxHeap<T, Arity, Layout, Stats>::buildMaxHeap( MaxHeapCreationType type, size_t threads ) {
+  if ( type == ITERATIVE ) {
+    buildMaxHeapIterative();
+  } else if ( type == PARALLEL ) {
+    buildMaxHeapParallel( threads );
+  } else {
+    buildMaxHeapRecursive();
   }
 }
 
-template<typename T>
-T MaxHeap<T>::at( size_t index ) {
+template<typename T, size_t Arity, typename Layout, typename Stats>
+const T& MaxHeap<T, Arity, Layout, Stats>::at( size_t index ) {
   // Exception will be thrown if index is out of range
   return heap.at( index );
 }
 
-template<typename T>
-MaxHeap<T>& MaxHeap<T>::operator = ( MaxHeap<T>& h ) {
+template<typename T, size_t Arity, typename Layout, typename Stats>
+MaxHeap<T, Arity, Layout, Stats>& MaxHeap<T, Arity, Layout, Stats>::operator = ( const MaxHeap<T, Arity, Layout, Stats>& h ) {
   heap = h.heap;
-  return h;
+  extraction_type = h.extraction_type;
+  stats() = h.stats();
+  return *this;
 }
 
-template<typename T>
-std::vector<T> MaxHeap<T>::heapSort() {
+template<typename T, size_t Arity, typename Layout, typename Stats>
+MaxHeap<T, Arity, Layout, Stats>& MaxHeap<T, Arity, Layout, Stats>::operator = ( MaxHeap<T, Arity, Layout, Stats>&& h ) noexcept {
+  heap = std::move( h.heap );
+  extraction_type = h.extraction_type;
+  stats() = h.stats();
+  h.heap.clear();
+  return *this;
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+std::vector<T> MaxHeap<T, Arity, Layout, Stats>::heapSort() {
+  MaxHeap<T, Arity, Layout, Stats> heapCopy( *this );
+  heapCopy.stats() = Stats();
+  std::vector<T> result = heapCopy.sortInPlace();
+  stats().merge( heapCopy.stats() );
+  return result;
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+std::vector<T> MaxHeap<T, Arity, Layout, Stats>::sortInPlace() {
+  stats().sorted();
+  for ( size_t end = heap.size(); end > 1; --end ) {
+    T key = std::move( elementAt( end - 1 ) );
+    elementAt( end - 1 ) = std::move( elementAt( 0 ) );
+    siftDownExtract( 0, std::move( key ), end - 1 );
+  }
+  std::reverse( heap.begin(), heap.end() );
   std::vector<T> result;
-  MaxHeap<T> heapCopy = *this;
-  for ( typename std::vector<T>::reverse_iterator it = heap.rbegin(); it != heap.rend(); ++it ) {
-    std::swap( heap.front(), *it );
-    result.push_back( heap.back() );
-    heap.pop_back();
-    maxHeapifyRecursive( 0 );
+  result.swap( heap );
+  checkInvariants();
+  return result;
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+std::vector<T> MaxHeap<T, Arity, Layout, Stats>::peekTopK( size_t k ) {
+  std::vector<T> result;
+  k = std::min( k, heap.size() );
+  if ( k == 0 ) {
+    return result;
+  }
+  result.reserve( k );
+  MaxHeap<Candidate, Arity> frontier;
+  frontier.reserve( ( Arity - 1 ) * k + 1 );
+  frontier.maxHeapInsert( Candidate( &elementAt( 0 ), 0 ) );
+  while ( true ) {
+    Candidate top = frontier.heapExtractMax();
+    result.push_back( *top.key );
+    if ( result.size() == k ) {
+      break;
+    }
+    for ( size_t child_number = 0; child_number < Arity; child_number++ ) {
+      size_t child = childOf( top.index, child_number );
+      if ( child >= heap.size() ) {
+        break;
+      }
+      frontier.maxHeapInsert( Candidate( &elementAt( child ), child ) );
+    }
   }
-  *this = heapCopy;
   return result;
 }
 
-template<typename T>
-T MaxHeap<T>::heapMaximum() throw( std::underflow_error ) {
+template<typename T, size_t Arity, typename Layout, typename Stats>
+template<typename OutputIterator>
+OutputIterator MaxHeap<T, Arity, Layout, Stats>::sortInto( OutputIterator out ) {
+  stats().sorted();
+  while ( !heap.empty() ) {
+    *out = std::move( heap.front() );
+    ++out;
+    T key = std::move( heap.back() );
+    heap.pop_back();
+    if ( !heap.empty() ) {
+      siftDownExtract( 0, std::move( key ), heap.size() );
+    }
+  }
+  checkInvariants();
+  return out;
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+const T& MaxHeap<T, Arity, Layout, Stats>::heapMaximum() {
   if ( empty() ) {
     throw std::underflow_error( "MaxHeap is empty!" );
   }
-  return at( 0 );
+  return heap.front();
 }
 
-template<typename T>
-T MaxHeap<T>::heapExtractMax() throw( std::underflow_error ) {
-  size_t size = heap.size();
+template<typename T, size_t Arity, typename Layout, typename Stats>
+T MaxHeap<T, Arity, Layout, Stats>::heapExtractMax() {
   if ( empty() ) {
     throw std::underflow_error( "MaxHeap is empty!" );
   }
 
-  T result;
-  heapSwap( 0, size - 1 );
-  result = heap.back();
+  stats().extracted();
+  T result = std::move( heap.front() );
+  T key = std::move( heap.back() );
   heap.pop_back();
-  maxHeapifyRecursive( 0 );
+  if ( !heap.empty() ) {
+    siftDownExtract( 0, std::move( key ), heap.size() );
+  }
+  checkInvariants();
   return result;
 }
 
-template<typename T>
-void MaxHeap<T>::heapIncreaseKey( int index, T key ) throw( std::invalid_argument ) {
-  if ( key < at( index ) ) {
+template<typename T, size_t Arity, typename Layout, typename Stats>
+std::vector<T> MaxHeap<T, Arity, Layout, Stats>::extractBatch( size_t count ) {
+  count = std::min( count, heap.size() );
+  stats().extracted( count );
+  std::vector<T> result;
+  result.reserve( count );
+  while ( result.size() < count ) {
+    result.push_back( std::move( heap.front() ) );
+    T key = std::move( heap.back() );
+    heap.pop_back();
+    if ( !heap.empty() ) {
+      siftDownExtract( 0, std::move( key ), heap.size() );
+    }
+  }
+  checkInvariants();
+  return result;
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+T MaxHeap<T, Arity, Layout, Stats>::heapReplaceMax( const T& key ) {
+  return heapReplaceMax( T( key ) );
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+T MaxHeap<T, Arity, Layout, Stats>::heapReplaceMax( T&& key ) {
+  if ( empty() ) {
+    throw std::underflow_error( "MaxHeap is empty!" );
+  }
+
+  stats().extracted();
+  stats().inserted();
+  T result = std::move( heap.front() );
+  siftDown( 0, std::move( key ), heap.size() );
+  checkInvariants();
+  return result;
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+void MaxHeap<T, Arity, Layout, Stats>::heapIncreaseKey( size_t index, T key ) {
+  if ( less( key, at( index ) ) ) {
     throw std::invalid_argument( "New key is smaller than current key!" );
   }
-  heap.at( index ) = key;
-  while ( index > 0 && at( parentIndex( index ) ) < at( index ) ) {
-    heapSwap( index, parentIndex( index ) );
-    index = parentIndex( index );
+  siftUp( index, std::move( key ) );
+  checkInvariants();
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+void MaxHeap<T, Arity, Layout, Stats>::increaseKey( size_t index, T key ) {
+  heapIncreaseKey( index, std::move( key ) );
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+void MaxHeap<T, Arity, Layout, Stats>::decreaseKey( size_t index, T key ) {
+  if ( less( at( index ), key ) ) {
+    throw std::invalid_argument( "New key is larger than current key!" );
   }
+  elementAt( index ) = std::move( key );
+  propagateDown( index );
+  checkInvariants();
 }
 
-template<typename T>
-void MaxHeap<T>::heapSwap( size_t i, size_t j ) {
-  if ( i < getSize() && j < getSize() ) {
-    std::swap( heap.at( i ), heap.at( j ) );
+template<typename T, size_t Arity, typename Layout, typename Stats>
+void MaxHeap<T, Arity, Layout, Stats>::updateKey( size_t index, T key ) {
+  if ( less( at( index ), key ) ) {
+    heapIncreaseKey( index, std::move( key ) );
+  } else {
+    decreaseKey( index, std::move( key ) );
   }
 }
 
-template<typename T>
-void MaxHeap<T>::propagateDown( size_t index ) {
-  size_t n;
-  size_t j;
-  while ( !isLeaf( index ) ) {
-    n = getSize();
-    j = leftChildIndex( index );
-    if ( ( j < ( n - 1 ) ) && ( at( j ) < at( j + 1 ) ) ){
-      j++;
+template<typename T, size_t Arity, typename Layout, typename Stats>
+template<typename InputIterator>
+void MaxHeap<T, Arity, Layout, Stats>::updateKeys( InputIterator first, InputIterator last ) {
+  std::vector<size_t> changed;
+  try {
+    for ( ; first != last; ++first ) {
+      // Exception will be thrown if index is out of range
+      heap.at( ( *first ).first ) = ( *first ).second;
+      changed.push_back( ( *first ).first );
     }
-    if ( at( index ) >= at( j ) ) {
-      return;
-    }
-    heapSwap( index, j );
-    index = j;
+  } catch ( ... ) {
+    buildMaxHeapChanged( changed );
+    throw;
   }
+  buildMaxHeapChanged( changed );
+  checkInvariants();
 }
 
-template<typename T>
-void MaxHeap<T>::maxHeapInsert( T key ) {
+template<typename T, size_t Arity, typename Layout, typename Stats>
+void MaxHeap<T, Arity, Layout, Stats>::siftUp( size_t hole, T&& key ) {
+  Sifter sifter( *this, std::move( key ) );
+  Sift::up( sifter, hole );
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+void MaxHeap<T, Arity, Layout, Stats>::siftUp( size_t index ) {
+  if ( index > 0 && less( elementAt( parentOf( index ) ), elementAt( index ) ) ) {
+    T key = std::move( elementAt( index ) );
+    siftUp( index, std::move( key ) );
+  }
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+void MaxHeap<T, Arity, Layout, Stats>::siftDown( size_t hole, T&& key, size_t size ) {
+  Sifter sifter( *this, std::move( key ) );
+  Sift::down( sifter, hole, size );
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+void MaxHeap<T, Arity, Layout, Stats>::siftDownBottomUp( size_t hole, T&& key, size_t size ) {
+  Sifter sifter( *this, std::move( key ) );
+  Sift::downBottomUp( sifter, hole, size );
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+void MaxHeap<T, Arity, Layout, Stats>::siftDownExtract( size_t hole, T&& key, size_t size ) {
+  if ( extraction_type == BOTTOM_UP ) {
+    siftDownBottomUp( hole, std::move( key ), size );
+  } else {
+    Sifter sifter( *this, std::move( key ) );
+    maxHeapifyRecursive( sifter, hole, size );
+  }
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+void MaxHeap<T, Arity, Layout, Stats>::propagateDown( size_t index ) {
+  if ( firstChildOf( index ) < heap.size() ) {
+    T key = std::move( elementAt( index ) );
+    siftDown( index, std::move( key ), heap.size() );
+  }
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+void MaxHeap<T, Arity, Layout, Stats>::maxHeapInsert( const T& key ) {
+  size_t before = heap.capacity();
   heap.push_back( key );
-  MaxHeap<T>::heapIncreaseKey( heap.size() - 1, key );
+  stats().reallocated( before, heap.capacity() );
+  stats().inserted();
+  siftUp( heap.size() - 1 );
+  checkInvariants();
 }
 
-template<typename T>
-bool MaxHeap<T>::isLeaf( const size_t index ) const {
-  return ( ( index < heap.size() ) && ( index >= heap.size() / 2 ) );
+template<typename T, size_t Arity, typename Layout, typename Stats>
+void MaxHeap<T, Arity, Layout, Stats>::maxHeapInsert( T&& key ) {
+  size_t before = heap.capacity();
+  heap.push_back( std::move( key ) );
+  stats().reallocated( before, heap.capacity() );
+  stats().inserted();
+  siftUp( heap.size() - 1 );
+  checkInvariants();
 }
 
-template<typename T>
-bool MaxHeap<T>::isMaxHeap() {
+template<typename T, size_t Arity, typename Layout, typename Stats>
+template<typename... Args>
+void MaxHeap<T, Arity, Layout, Stats>::emplace( Args&&... args ) {
+  size_t before = heap.capacity();
+  heap.emplace_back( std::forward<Args>( args )... );
+  stats().reallocated( before, heap.capacity() );
+  stats().inserted();
+  siftUp( heap.size() - 1 );
+  checkInvariants();
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+template<typename InputIterator>
+void MaxHeap<T, Arity, Layout, Stats>::insertRange( InputIterator first, InputIterator last ) {
+  size_t begin = heap.size();
+  size_t before = heap.capacity();
+  heap.insert( heap.end(), first, last );
+  stats().reallocated( before, heap.capacity() );
+  size_t end = heap.size();
+  size_t count = end - begin;
+  stats().inserted( count );
+  // A sift-up costs O(1) on average but up to O(log n), while the rebuild
+  // costs O(count) plus O(log n) per level above the batch. Sifting wins
+  // only for batches that are small compared to the height of the heap.
+  size_t height = 1;
+  for ( size_t n = end; n >= Arity; n /= Arity ) {
+    height++;
+  }
+  if ( count <= height ) {
+    for ( size_t i = begin; i < end; i++ ) {
+      siftUp( i );
+    }
+  } else {
+    buildMaxHeapAppended( begin, end );
+  }
+  checkInvariants();
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+MaxHeapExtractionType MaxHeap<T, Arity, Layout, Stats>::getExtractionType() const {
+  return extraction_type;
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+void MaxHeap<T, Arity, Layout, Stats>::setExtractionType( MaxHeapExtractionType type ) {
+  extraction_type = type;
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+MaxHeapStats MaxHeap<T, Arity, Layout, Stats>::getStats() const {
+  return stats().snapshot();
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+void MaxHeap<T, Arity, Layout, Stats>::resetStats() {
+  stats().reset();
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+bool MaxHeap<T, Arity, Layout, Stats>::isLeaf( const size_t index ) const {
+  return ( ( index < heap.size() ) && ( firstChildOf( index ) >= heap.size() ) );
+}
+
+template<typename T, size_t Arity, typename Layout, typename Stats>
+bool MaxHeap<T, Arity, Layout, Stats>::isMaxHeap() {
   size_t number_of_elements;
-  size_t left_child_index;
-  size_t right_child_index;
   number_of_elements = getSize();
-  for ( size_t i = 0; i < number_of_elements; i++ ) {
-    left_child_index = leftChildIndex( i );
-    right_child_index = rightChildIndex( i );
-    if ( ( left_child_index < number_of_elements ) && ( at( left_child_index ) > at( i ) ) ) {
-      return false;
-    }
-    if ( ( right_child_index < number_of_elements ) && ( at( right_child_index ) > at( i ) ) ) {
+  for ( size_t i = 1; i < number_of_elements; i++ ) {
+    if ( elementAt( parentOf( i ) ) < elementAt( i ) ) {
       return false;
     }
   }
   return true;
 }
 
-template<typename T>
-T MaxHeap<T>::removeAt( size_t index ) {
-  size_t result;
-  size_t n;
-  n = getSize();
-  if ( index == ( n - 1 ) ) {
-    n--;
-  } else {
-    heapSwap( index, --n );
-    while ( ( index > 0 ) && ( at( index ) > at( parentIndex( index ) ) ) ) {
-      heapSwap( index, parentIndex( index ) );
-      index = parentIndex( index );
-    }
-    if ( n != 0 ) {
-      propagateDown( index );
+template<typename T, size_t Arity, typename Layout, typename Stats>
+T MaxHeap<T, Arity, Layout, Stats>::removeAt( size_t index ) {
+  // Exception will be thrown if index is out of range
+  T result = std::move( heap.at( index ) );
+  stats().removed();
+  T key = std::move( heap.back() );
+  heap.pop_back();
+  if ( index < heap.size() ) {
+    // The last element fills the hole left at index, and may have to
+    // move either up or down from there.
+    if ( index > 0 && less( elementAt( parentOf( index ) ), key ) ) {
+      siftUp( index, std::move( key ) );
+    } else {
+      siftDownExtract( index, std::move( key ), heap.size() );
     }
   }
-  result = at( n );
-  heap.erase( std::remove( heap.begin(), heap.end(), result ), heap.end() );
+  checkInvariants();
   return result;
 }
 
-template<typename F>
-bool operator == ( const MaxHeap<F>& lhs, const MaxHeap<F>& rhs ) {
+template<typename F, size_t A, typename L, typename S>
+bool operator == ( const MaxHeap<F, A, L, S>& lhs, const MaxHeap<F, A, L, S>& rhs ) {
   return lhs.heap == rhs.heap;
 }
 
-template<typename F>
-bool operator != ( const MaxHeap<F>& lhs, const MaxHeap<F>& rhs ) {
+template<typename F, size_t A, typename L, typename S>
+bool operator != ( const MaxHeap<F, A, L, S>& lhs, const MaxHeap<F, A, L, S>& rhs ) {
   return !( lhs.heap == rhs.heap );
 }
 
-template<typename T>
-std::ostream& operator << ( std::ostream& s, const MaxHeap<T>& other ) {
+template<typename T, size_t Arity, typename Layout, typename Stats>
+std::ostream& operator << ( std::ostream& s, const MaxHeap<T, Arity, Layout, Stats>& other ) {
 
   s << "<";
   if ( other.empty() ) {
@@ -649,10 +1647,12 @@ std::ostream& operator << ( std::ostream& s, const MaxHeap<T>& other ) {
 }
 
 template<typename T>
-std::ostream & operator << ( std::ostream & s, std::vector<T> vec ) {
+std::ostream & operator << ( std::ostream & s, const std::vector<T>& vec ) {
   s << "{ ";
-  std::copy( vec.begin(), vec.end() - 1, std::ostream_iterator<T>( s, ", " ) );
-  std::copy( vec.end() - 1, vec.end(), std::ostream_iterator<T>( s, " " ) );
+  if ( !vec.empty() ) {
+    std::copy( vec.begin(), vec.end() - 1, std::ostream_iterator<T>( s, ", " ) );
+    std::copy( vec.end() - 1, vec.end(), std::ostream_iterator<T>( s, " " ) );
+  }
   s << "}";
   return s;
 }
@@ -0,0 +1,154 @@
+#ifndef MAXHEAPLAYOUT_H
+#define MAXHEAPLAYOUT_H
+
+/*
+ * The MIT Licese (MIT)
+ *
+ * Copyright (C) 2016 by Brian Horn, trycatchhorn@gmail.com.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+*/
+
+#include <cstddef>
+
+/*
+ * Layout policies place the nodes of a d-ary max-heap in its backing
+ * vector. MaxHeap takes a layout as its third template parameter and asks
+ * its nested Index<T, Arity> for the parent and children of an index.
+ *
+ * Every layout keeps the elements of a heap of n elements in the first n
+ * slots of the vector, with every parent at a smaller index than its
+ * children, so insertion appends and extraction removes the last slot
+ * exactly as in the implicit layout.
+ *
+ * Index<T, Arity> provides:
+ *   LEVEL_ORDER    true if the nodes of every level are contiguous and in
+ *                  order, which the level-based bulk algorithms rely on.
+ *   parent( i )    the index of the parent of index i > 0.
+ *   child( i, k )  the index of child k < Arity of index i; the children of
+ *                  an index are increasing in k.
+ *   internalEnd( n ) an index such that no index at or past it has children
+ *                  in a heap of n elements.
+ */
+
+/**
+ * The classic implicit layout, storing the heap level by level, where the
+ * children of index i are Arity * i + 1 to Arity * i + Arity.
+ */
+struct ImplicitLayout {
+
+  template<typename T, size_t Arity>
+  struct Index {
+
+    static const bool LEVEL_ORDER = true;
+
+    static size_t parent( size_t index ) {
+      return ( index - 1 ) / Arity;
+    }
+
+    static size_t child( size_t index, size_t k ) {
+      return Arity * index + 1 + k;
+    }
+
+    static size_t internalEnd( size_t size ) {
+      return ( size + Arity - 2 ) / Arity;
+    }
+  };
+
+};
+
+/**
+ * A B-heap layout, which packs the heap into pages of PageBytes bytes. Each
+ * page holds a complete subtree of the height that fits in the page, laid
+ * out level by level, and the children of the leaves of that subtree are
+ * the roots of other pages. A path from the root to a leaf thus touches a
+ * new page only every page-height levels, instead of on every level below
+ * the first few, which saves cache and TLB misses on heaps far larger than
+ * the caches.
+ *
+ * The pages are numbered level by level in the tree of pages, where every
+ * page has Arity children per subtree leaf. PageBytes of 4096 targets
+ * virtual memory pages, and 64 targets cache lines.
+ *
+ * NOTE: finding a parent or child costs a division by the page size, which
+ * is rarely a power of two, so the layout is slower than ImplicitLayout
+ * while the heap fits in the caches. It only pays off once cache and TLB
+ * misses dominate; measure with bench/layout_bench before switching.
+ */
+template<size_t PageBytes = 4096>
+struct BHeapLayout {
+
+  /**
+   * Returns the number of nodes in a complete subtree of the specified
+   * arity and height.
+   */
+  static constexpr size_t subtreeSize( size_t arity, size_t height ) {
+    return height == 0 ? 0 : 1 + arity * subtreeSize( arity, height - 1 );
+  }
+
+  /**
+   * Returns the height of the tallest complete subtree, of at least one
+   * level, holding at most the specified number of nodes.
+   */
+  static constexpr size_t subtreeHeight( size_t arity, size_t capacity, size_t height = 1 ) {
+    return subtreeSize( arity, height + 1 ) > capacity ? height : subtreeHeight( arity, capacity, height + 1 );
+  }
+
+  template<typename T, size_t Arity>
+  struct Index {
+
+    static const bool LEVEL_ORDER = false;
+    static const size_t HEIGHT = subtreeHeight( Arity, PageBytes / sizeof( T ) );
+    static const size_t PAGE_SIZE = subtreeSize( Arity, HEIGHT );
+    static const size_t FIRST_LEAF = subtreeSize( Arity, HEIGHT - 1 );
+    static const size_t FANOUT = Arity * ( PAGE_SIZE - FIRST_LEAF );
+
+    static size_t parent( size_t index ) {
+      size_t page = index / PAGE_SIZE;
+      size_t offset = index % PAGE_SIZE;
+      if ( offset > 0 ) {
+        return page * PAGE_SIZE + ( offset - 1 ) / Arity;
+      }
+      size_t parent_page = ( page - 1 ) / FANOUT;
+      size_t leaf = ( ( page - 1 ) % FANOUT ) / Arity;
+      return parent_page * PAGE_SIZE + FIRST_LEAF + leaf;
+    }
+
+    static size_t child( size_t index, size_t k ) {
+      size_t page = index / PAGE_SIZE;
+      size_t offset = index % PAGE_SIZE;
+      if ( offset < FIRST_LEAF ) {
+        return page * PAGE_SIZE + Arity * offset + 1 + k;
+      }
+      return ( page * FANOUT + 1 + Arity * ( offset - FIRST_LEAF ) + k ) * PAGE_SIZE;
+    }
+
+    static size_t internalEnd( size_t size ) {
+      if ( size < 2 ) {
+        return 0;
+      }
+      size_t page = ( size - 1 ) / PAGE_SIZE;
+      size_t offset = ( size - 1 ) % PAGE_SIZE;
+      return page * PAGE_SIZE + ( offset > 0 ? ( offset - 1 ) / Arity + 1 : 0 );
+    }
+  };
+
+};
+
+#endif
@@ -0,0 +1,516 @@
+#ifndef MAXHEAPSERIALIZATION_H
+#define MAXHEAPSERIALIZATION_H
+
+/*
+ * The MIT Licese (MIT)
+ *
+ * Copyright (C) 2016 by Brian Horn, trycatchhorn@gmail.com.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "MaxHeap.h"
+
+/*
+ * Binary wire format of serializeMaxHeap(). A stream starts with a
+ * preamble of 32 bytes and is followed by chunks, each made of an element
+ * count and a byte length, both 32-bit, and then the encoded elements. A
+ * chunk with no elements ends the stream. The elements are in heap order,
+ * so the receiver adopts the array without rebuilding the heap.
+ *
+ * Integers are written in the byte order of the machine, which the
+ * preamble records; a stream is refused where it differs. Elements are
+ * encoded by MaxHeapCodec<T>.
+ */
+
+#define MAXHEAP_STREAM_VERSION 1
+
+/**
+ * The largest payload of a chunk, in bytes. The element count in the
+ * preamble and the chunk headers come from the peer, so a reader never
+ * allocates more than one chunk ahead of the payload it has received,
+ * and refuses larger chunks. May be defined before including this header.
+ */
+#ifndef MAXHEAP_STREAM_MAX_CHUNK_BYTES
+#define MAXHEAP_STREAM_MAX_CHUNK_BYTES ( 64u << 20 )
+#endif
+
+/**
+ * Encodes elements of type T for the wire format. Trivially copyable types
+ * are stored as their raw bytes, which are read straight into the array
+ * of the receiving heap. std::string is stored as a 32-bit length and its
+ * characters. Other types need a specialization with the same members.
+ */
+template<typename T, typename Enable = void>
+struct MaxHeapCodec;
+
+template<typename T>
+struct MaxHeapCodec<T, typename std::enable_if<std::is_trivially_copyable<T>::value>::type> {
+  /**
+   * True if an element is stored as its sizeof( T ) raw bytes.
+   */
+  static const bool RAW = true;
+
+  static void encode( const T& value, std::string& out ) {
+    out.append( reinterpret_cast<const char*>( &value ), sizeof( T ) );
+  }
+
+  /**
+   * Decodes one element from the front of the specified bytes.
+   *
+   * @param  begin the first byte.
+   * @param  end one past the last byte.
+   * @param  value the decoded element.
+   * @return one past the last byte of the element, or null if the bytes
+   *         do not hold a whole element.
+   */
+  static const char* decode( const char* begin, const char* end, T& value ) {
+    if ( static_cast<size_t>( end - begin ) < sizeof( T ) ) {
+      return 0;
+    }
+    std::memcpy( static_cast<void*>( &value ), begin, sizeof( T ) );
+    return begin + sizeof( T );
+  }
+};
+
+template<>
+struct MaxHeapCodec<std::string> {
+  static const bool RAW = false;
+
+  static void encode( const std::string& value, std::string& out ) {
+    uint32_t length = static_cast<uint32_t>( value.size() );
+    out.append( reinterpret_cast<const char*>( &length ), sizeof( length ) );
+    out.append( value );
+  }
+
+  static const char* decode( const char* begin, const char* end, std::string& value ) {
+    uint32_t length;
+    if ( static_cast<size_t>( end - begin ) < sizeof( length ) ) {
+      return 0;
+    }
+    std::memcpy( &length, begin, sizeof( length ) );
+    begin += sizeof( length );
+    if ( static_cast<size_t>( end - begin ) < length ) {
+      return 0;
+    }
+    value.assign( begin, length );
+    return begin + length;
+  }
+};
+
+/**
+ * The preamble of a serialized max-heap.
+ */
+struct MaxHeapStreamHeader {
+  char magic[ 8 ];
+  uint32_t version;
+  uint32_t byte_order;
+  uint32_t arity;
+  uint32_t element_bytes;
+  uint64_t size;
+
+  /**
+   * Creates the preamble of a stream of the current version.
+   *
+   * @param arity the arity of the heap.
+   * @param element_bytes the size of a raw element, or zero if the
+   *        elements are not raw.
+   * @param size the number of elements in the heap.
+   */
+  MaxHeapStreamHeader( uint32_t arity, uint32_t element_bytes, uint64_t size )
+    : version( MAXHEAP_STREAM_VERSION ), byte_order( BYTE_ORDER_MARK ), arity( arity ), element_bytes( element_bytes ), size( size ) {
+    std::memcpy( magic, magicBytes(), sizeof( magic ) );
+  }
+
+  /**
+   * Throws std::runtime_error unless this preamble is of the current
+   * version and describes heaps of the specified arity and element size.
+   *
+   * @param arity the expected arity of the heap.
+   * @param element_bytes the expected size of a raw element, or zero.
+   */
+  void validate( uint32_t arity, uint32_t element_bytes ) const {
+    if ( std::memcmp( magic, magicBytes(), sizeof( magic ) ) != 0 ) {
+      throw std::runtime_error( "Not a serialized max-heap!" );
+    }
+    if ( version != MAXHEAP_STREAM_VERSION || byte_order != BYTE_ORDER_MARK ) {
+      throw std::runtime_error( "Unsupported max-heap stream version or byte order!" );
+    }
+    if ( this->arity != arity || this->element_bytes != element_bytes ) {
+      throw std::runtime_error( "Serialized max-heap does not match the element type or arity!" );
+    }
+  }
+
+  static const uint32_t BYTE_ORDER_MARK = 0x01020304U;
+
+  /**
+   * Returns the eight bytes identifying a serialized max-heap.
+   */
+  static const char* magicBytes() {
+    return "MAXHEAPS";
+  }
+};
+
+/**
+ * The header of a chunk of a serialized max-heap.
+ */
+struct MaxHeapChunkHeader {
+  uint32_t count;
+  uint32_t bytes;
+};
+
+/**
+ * Reads a serialized max-heap incrementally, as its bytes arrive. The
+ * reader hands out the buffer where the next bytes belong through
+ * buffer(), and the caller reports how many it has filled with commit(),
+ * so the payload of raw elements is written straight into the array of
+ * the heap, with no intermediate copy. feed() does the same for bytes
+ * that are already in memory.
+ *
+ * Malformed input throws std::runtime_error. Memory is only allocated for
+ * chunks as they arrive, each at most MAXHEAP_STREAM_MAX_CHUNK_BYTES, so
+ * a corrupt header cannot make the reader allocate more than the stream
+ * actually holds. Once done() is true, deserializeMaxHeap( reader, heap )
+ * adopts the elements.
+ */
+template<typename T>
+class MaxHeapReader {
+
+ public:
+
+  /**
+   * Creates a reader expecting a max-heap of the specified arity.
+   *
+   * @param arity the arity of the heap.
+   */
+  explicit MaxHeapReader( size_t arity );
+
+  /**
+   * Returns where the next bytes of the stream belong, and at most how
+   * many of them. The buffer is empty once the stream is done.
+   *
+   * @return the buffer and its length.
+   */
+  std::pair<char*, size_t> buffer();
+
+  /**
+   * Accepts the specified number of bytes written into the last buffer().
+   *
+   * @param bytes the number of bytes written.
+   */
+  void commit( size_t bytes );
+
+  /**
+   * Copies the specified bytes into the reader, and returns how many were
+   * used; bytes past the end of the stream are not used.
+   *
+   * @param  data the bytes of the stream.
+   * @param  bytes the number of bytes.
+   * @return the number of bytes used.
+   */
+  size_t feed( const char* data, size_t bytes );
+
+  /**
+   * Returns if the whole stream has been read.
+   *
+   * @return true if the end of the stream has been read.
+   */
+  bool done() const;
+
+  /**
+   * Returns the elements read so far, in heap order.
+   *
+   * @return the elements read so far.
+   */
+  std::vector<T>& elements();
+
+ private:
+
+  enum State {
+    PREAMBLE,
+    CHUNK_HEADER,
+    RAW_PAYLOAD,
+    ENCODED_PAYLOAD,
+    DONE
+  };
+
+  size_t arity;
+  State state;
+  std::vector<char> pending;
+  size_t filled;
+  MaxHeapChunkHeader chunk;
+  uint64_t expected_size;
+  std::vector<T> result;
+
+  /**
+   * Starts collecting the specified number of bytes in pending.
+   *
+   * @param bytes the number of bytes to collect.
+   */
+  void expect( size_t bytes );
+
+  /**
+   * Processes a completed preamble, chunk header or payload.
+   */
+  void advance();
+
+};
+
+template<typename T>
+MaxHeapReader<T>::MaxHeapReader( size_t arity ) : arity( arity ), state( PREAMBLE ), filled( 0 ), expected_size( 0 ) {
+  expect( sizeof( MaxHeapStreamHeader ) );
+}
+
+template<typename T>
+std::pair<char*, size_t> MaxHeapReader<T>::buffer() {
+  if ( state == DONE ) {
+    return std::pair<char*, size_t>( static_cast<char*>( 0 ), 0 );
+  }
+  if ( state == RAW_PAYLOAD ) {
+    char* payload = reinterpret_cast<char*>( result.data() + ( result.size() - chunk.count ) );
+    return std::pair<char*, size_t>( payload + filled, chunk.bytes - filled );
+  }
+  return std::pair<char*, size_t>( pending.data() + filled, pending.size() - filled );
+}
+
+template<typename T>
+void MaxHeapReader<T>::commit( size_t bytes ) {
+  filled += bytes;
+  size_t needed = state == RAW_PAYLOAD ? chunk.bytes : pending.size();
+  if ( state != DONE && filled == needed ) {
+    advance();
+  }
+}
+
+template<typename T>
+size_t MaxHeapReader<T>::feed( const char* data, size_t bytes ) {
+  size_t used = 0;
+  while ( used < bytes && state != DONE ) {
+    std::pair<char*, size_t> target = buffer();
+    size_t count = std::min( target.second, bytes - used );
+    std::memcpy( target.first, data + used, count );
+    used += count;
+    commit( count );
+  }
+  return used;
+}
+
+template<typename T>
+bool MaxHeapReader<T>::done() const {
+  return state == DONE;
+}
+
+template<typename T>
+std::vector<T>& MaxHeapReader<T>::elements() {
+  return result;
+}
+
+template<typename T>
+void MaxHeapReader<T>::expect( size_t bytes ) {
+  pending.resize( bytes );
+  filled = 0;
+}
+
+template<typename T>
+void MaxHeapReader<T>::advance() {
+  if ( state == PREAMBLE ) {
+    MaxHeapStreamHeader header( 0, 0, 0 );
+    std::memcpy( &header, pending.data(), sizeof( header ) );
+    header.validate( static_cast<uint32_t>( arity ), MaxHeapCodec<T>::RAW ? static_cast<uint32_t>( sizeof( T ) ) : 0 );
+    expected_size = header.size;
+    if ( MaxHeapCodec<T>::RAW ) {
+      result.reserve( static_cast<size_t>( std::min<uint64_t>( expected_size, MAXHEAP_STREAM_MAX_CHUNK_BYTES / sizeof( T ) ) ) );
+    }
+    state = CHUNK_HEADER;
+    expect( sizeof( MaxHeapChunkHeader ) );
+  } else if ( state == CHUNK_HEADER ) {
+    std::memcpy( &chunk, pending.data(), sizeof( chunk ) );
+    if ( chunk.count == 0 ) {
+      if ( chunk.bytes != 0 || result.size() != expected_size ) {
+        throw std::runtime_error( "Serialized max-heap is truncated or corrupt!" );
+      }
+      state = DONE;
+      std::vector<char>().swap( pending );
+      return;
+    }
+    bool raw_mismatch = MaxHeapCodec<T>::RAW && chunk.bytes != chunk.count * sizeof( T );
+    if ( result.size() + chunk.count > expected_size || raw_mismatch || chunk.bytes == 0
+         || chunk.bytes > MAXHEAP_STREAM_MAX_CHUNK_BYTES ) {
+      throw std::runtime_error( "Serialized max-heap is truncated or corrupt!" );
+    }
+    if ( MaxHeapCodec<T>::RAW ) {
+      result.resize( result.size() + chunk.count );
+      state = RAW_PAYLOAD;
+      filled = 0;
+    } else {
+      state = ENCODED_PAYLOAD;
+      expect( chunk.bytes );
+    }
+  } else {
+    if ( state == ENCODED_PAYLOAD ) {
+      const char* begin = pending.data();
+      const char* end = begin + pending.size();
+      for ( uint32_t i = 0; i < chunk.count; i++ ) {
+        T value;
+        begin = MaxHeapCodec<T>::decode( begin, end, value );
+        if ( begin == 0 ) {
+          throw std::runtime_error( "Serialized max-heap is truncated or corrupt!" );
+        }
+        result.push_back( std::move( value ) );
+      }
+      if ( begin != end ) {
+        throw std::runtime_error( "Serialized max-heap is truncated or corrupt!" );
+      }
+    }
+    state = CHUNK_HEADER;
+    expect( sizeof( MaxHeapChunkHeader ) );
+  }
+}
+
+/**
+ * Writes the specified max-heap to the specified stream in the binary
+ * format described above: the elements in heap order, in length-prefixed
+ * chunks of at most the specified number of elements. Requires the
+ * implicit layout, and throws std::runtime_error if the stream fails.
+ *
+ * @param heap the max-heap to write.
+ * @param out the stream to write to.
+ * @param chunk_elements the largest number of elements in a chunk.
+ */
+template<typename T, size_t Arity, typename Layout, typename Stats>
+void serializeMaxHeap( const MaxHeap<T, Arity, Layout, Stats>& heap, std::ostream& out, size_t chunk_elements = 65536 ) {
+  static_assert( std::is_same<Layout, ImplicitLayout>::value, "Serialization requires the implicit layout" );
+  typedef MaxHeapCodec<T> Codec;
+  const T* elements = heap.data();
+  size_t size = heap.getSize();
+  MaxHeapStreamHeader header( static_cast<uint32_t>( Arity ), Codec::RAW ? static_cast<uint32_t>( sizeof( T ) ) : 0, size );
+  out.write( reinterpret_cast<const char*>( &header ), sizeof( header ) );
+  chunk_elements = std::max<size_t>( 1, std::min<size_t>( chunk_elements, MAXHEAP_STREAM_MAX_CHUNK_BYTES / sizeof( T ) ) );
+  std::string encoded;
+  size_t begin = 0;
+  while ( begin < size ) {
+    size_t end = std::min( begin + chunk_elements, size );
+    const char* payload = reinterpret_cast<const char*>( elements + begin );
+    size_t bytes = ( end - begin ) * sizeof( T );
+    if ( !Codec::RAW ) {
+      // Ends the chunk early rather than exceed the largest chunk a
+      // reader accepts.
+      encoded.clear();
+      for ( size_t i = begin; i < end; i++ ) {
+        size_t before = encoded.size();
+        Codec::encode( elements[ i ], encoded );
+        if ( encoded.size() > MAXHEAP_STREAM_MAX_CHUNK_BYTES ) {
+          if ( i == begin ) {
+            throw std::runtime_error( "Element of the max-heap is too large to serialize!" );
+          }
+          encoded.resize( before );
+          end = i;
+        }
+      }
+      payload = encoded.data();
+      bytes = encoded.size();
+    }
+    MaxHeapChunkHeader chunk = { static_cast<uint32_t>( end - begin ), static_cast<uint32_t>( bytes ) };
+    out.write( reinterpret_cast<const char*>( &chunk ), sizeof( chunk ) );
+    out.write( payload, bytes );
+    begin = end;
+  }
+  MaxHeapChunkHeader last = { 0, 0 };
+  out.write( reinterpret_cast<const char*>( &last ), sizeof( last ) );
+  if ( !out ) {
+    throw std::runtime_error( "Cannot write the max-heap to the stream!" );
+  }
+}
+
+/**
+ * Replaces the contents of the specified max-heap with the elements of the
+ * specified reader, which must be done. The elements are adopted in the
+ * order they were written, and checked with isMaxHeap() instead of being
+ * rebuilt. Throws std::runtime_error if the reader is not done or does not
+ * hold a max-heap, leaving the max-heap unchanged; otherwise the reader is
+ * left empty.
+ *
+ * @param reader a reader that has read a whole serialized max-heap.
+ * @param heap the max-heap to replace.
+ */
+template<typename T, size_t Arity, typename Layout, typename Stats>
+void deserializeMaxHeap( MaxHeapReader<T>& reader, MaxHeap<T, Arity, Layout, Stats>& heap ) {
+  static_assert( std::is_same<Layout, ImplicitLayout>::value, "Serialization requires the implicit layout" );
+  if ( !reader.done() ) {
+    throw std::runtime_error( "Serialized max-heap is truncated or corrupt!" );
+  }
+  heap.adopt( reader.elements() );
+}
+
+/**
+ * Replaces the contents of the specified max-heap with a max-heap read
+ * from the specified stream chunk by chunk, without reading past its end,
+ * like deserializeMaxHeap( MaxHeapReader<T>&, MaxHeap& ). Throws
+ * std::runtime_error if the stream is malformed or does not hold a
+ * max-heap, leaving the max-heap unchanged.
+ *
+ * @param in the stream to read from.
+ * @param heap the max-heap to replace.
+ */
+template<typename T, size_t Arity, typename Layout, typename Stats>
+void deserializeMaxHeap( std::istream& in, MaxHeap<T, Arity, Layout, Stats>& heap ) {
+  MaxHeapReader<T> reader( Arity );
+  while ( !reader.done() ) {
+    std::pair<char*, size_t> target = reader.buffer();
+    in.read( target.first, static_cast<std::streamsize>( target.second ) );
+    if ( in.gcount() == 0 ) {
+      throw std::runtime_error( "Serialized max-heap is truncated or corrupt!" );
+    }
+    reader.commit( static_cast<size_t>( in.gcount() ) );
+  }
+  deserializeMaxHeap( reader, heap );
+}
+
+/**
+ * Replaces the contents of the specified max-heap with the max-heap
+ * serialized in the specified bytes, like deserializeMaxHeap( std::istream&,
+ * MaxHeap& ).
+ *
+ * @param data the serialized max-heap.
+ * @param bytes the number of bytes, which must hold exactly one serialized
+ *        max-heap.
+ * @param heap the max-heap to replace.
+ */
+template<typename T, size_t Arity, typename Layout, typename Stats>
+void deserializeMaxHeap( const char* data, size_t bytes, MaxHeap<T, Arity, Layout, Stats>& heap ) {
+  MaxHeapReader<T> reader( Arity );
+  if ( reader.feed( data, bytes ) != bytes ) {
+    throw std::runtime_error( "Serialized max-heap is followed by extra bytes!" );
+  }
+  deserializeMaxHeap( reader, heap );
+}
+
+#endif
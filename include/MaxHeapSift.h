@@ -0,0 +1,209 @@
+#ifndef MAXHEAPSIFT_H
+#define MAXHEAPSIFT_H
+
+/*
+ * The MIT Licese (MIT)
+ *
+ * Copyright (C) 2016 by Brian Horn, trycatchhorn@gmail.com.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+*/
+
+#include <cstddef>
+#include <cstdint>
+
+#include "MaxHeapLayout.h"
+
+/**
+ * Finds the largest of Arity contiguous children with SIMD instructions.
+ * ENABLED is a compile-time check of the key type and arity; available()
+ * is the run-time check of the CPU, which must pass before select() is
+ * called. This primary template keeps every sift scalar, and including
+ * MaxHeapSimd.h specializes it for arithmetic keys.
+ *
+ * NOTE: a translation unit that includes MaxHeapSimd.h must do so before
+ * it uses a heap, and every translation unit that uses the same heap type
+ * must agree on including it.
+ */
+template<typename T, size_t Arity, typename Enable = void>
+struct SimdMaxChild {
+
+  static const bool ENABLED = false;
+
+  static bool available() {
+    return false;
+  }
+
+  static size_t select( const T* ) {
+    return 0;
+  }
+
+};
+
+/*
+ * The sift loops of a d-ary max-heap, shared by MaxHeap and the containers
+ * laid out like it. A sift holds one element outside the heap, moves the
+ * hole it leaves one level per step, and places the element once at its
+ * final position. The loops find parents and children through the Layout,
+ * and select the largest child with SimdMaxChild when the keys allow it
+ * and MaxHeapSimd.h is included.
+ *
+ * The container is reached through an accessor, which owns the held
+ * element and decides how elements are stored and moved:
+ *
+ *   KeyType            the type of the keys as stored; SimdMaxChild is used
+ *                      only when KeyType is vectorizable and the keys are
+ *                      dense.
+ *   keys( i )          the address of the key at index i.
+ *   less( i, j )       true if the key at index i is less than the one at j.
+ *   heldLess( i )      true if the held key is less than the one at i.
+ *   lessHeld( i )      true if the key at index i is less than the held one.
+ *   compared( n )      n comparisons were made by SimdMaxChild.
+ *   move( hole, i )    moves the element at index i into the hole, one level
+ *                      away.
+ *   place( hole )      moves the held element into the hole, ending the
+ *                      sift.
+ *
+ * move() and place() are where a container counts moves or records the new
+ * position of an element.
+ */
+template<typename Value, size_t Arity, typename Layout = ImplicitLayout>
+struct MaxHeapSift {
+
+  typedef typename Layout::template Index<Value, Arity> Index;
+
+  /**
+   * Returns the index of the largest child of the element at the specified
+   * index, which must not be a leaf.
+   *
+   * @param  access the accessor of the heap.
+   * @param  index of an element with at least one child.
+   * @param  size the number of elements in the heap.
+   * @return the index of the largest child.
+   */
+  template<typename Access>
+  static size_t maxChild( Access& access, size_t index, size_t size ) {
+    typedef SimdMaxChild<typename Access::KeyType, Arity> Simd;
+    size_t largest = Index::child( index, 0 );
+    if ( Simd::ENABLED && largest + Arity <= size
+         && Index::child( index, Arity - 1 ) == largest + Arity - 1 && Simd::available() ) {
+      access.compared( Arity - 1 );
+      return largest + Simd::select( access.keys( largest ) );
+    }
+    for ( size_t k = 1; k < Arity; ++k ) {
+      size_t child_index = Index::child( index, k );
+      if ( child_index >= size ) {
+        break;
+      }
+      if ( access.less( largest, child_index ) ) {
+        largest = child_index;
+      }
+    }
+    return largest;
+  }
+
+  /**
+   * Moves the held element up from the hole at the specified index.
+   *
+   * @param access the accessor of the heap.
+   * @param hole index of the empty slot.
+   */
+  template<typename Access>
+  static void up( Access& access, size_t hole ) {
+    while ( hole > 0 ) {
+      size_t parent_index = Index::parent( hole );
+      if ( !access.lessHeld( parent_index ) ) {
+        break;
+      }
+      access.move( hole, parent_index );
+      hole = parent_index;
+    }
+    access.place( hole );
+  }
+
+  /**
+   * Moves the held element down from the hole at the specified index,
+   * comparing it with the largest child on every level.
+   *
+   * @param access the accessor of the heap.
+   * @param hole index of the empty slot.
+   * @param size the number of elements in the heap.
+   */
+  template<typename Access>
+  static void down( Access& access, size_t hole, size_t size ) {
+    while ( Index::child( hole, 0 ) < size ) {
+      size_t child_index = maxChild( access, hole, size );
+      if ( !access.heldLess( child_index ) ) {
+        break;
+      }
+      access.move( hole, child_index );
+      hole = child_index;
+    }
+    access.place( hole );
+  }
+
+  /**
+   * Moves the hole at the specified index down to a leaf along the largest
+   * children, then moves the held element up from there, but not above the
+   * starting index. This saves about half of the comparisons when the held
+   * element came from a leaf.
+   *
+   * @param access the accessor of the heap.
+   * @param hole index of the empty slot.
+   * @param size the number of elements in the heap.
+   */
+  template<typename Access>
+  static void downBottomUp( Access& access, size_t hole, size_t size ) {
+    size_t start = hole;
+    while ( Index::child( hole, 0 ) < size ) {
+      size_t child_index = maxChild( access, hole, size );
+      access.move( hole, child_index );
+      hole = child_index;
+    }
+    while ( hole > start ) {
+      size_t parent_index = Index::parent( hole );
+      if ( !access.lessHeld( parent_index ) ) {
+        break;
+      }
+      access.move( hole, parent_index );
+      hole = parent_index;
+    }
+    access.place( hole );
+  }
+
+  /**
+   * Moves the held element up or down from the hole at the specified index,
+   * as required to restore the max-heap property.
+   *
+   * @param access the accessor of the heap.
+   * @param hole index of the empty slot.
+   * @param size the number of elements in the heap.
+   */
+  template<typename Access>
+  static void restore( Access& access, size_t hole, size_t size ) {
+    if ( hole > 0 && access.lessHeld( Index::parent( hole ) ) ) {
+      up( access, hole );
+    } else {
+      down( access, hole, size );
+    }
+  }
+
+};
+
+#endif
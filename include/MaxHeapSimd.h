@@ -0,0 +1,369 @@
+#ifndef MAXHEAPSIMD_H
+#define MAXHEAPSIMD_H
+
+/*
+ * The MIT Licese (MIT)
+ *
+ * Copyright (C) 2016 by Brian Horn, trycatchhorn@gmail.com.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "MaxHeapSift.h"
+
+/*
+ * Vectorized selection of the largest child for d-ary max-heaps of
+ * arithmetic keys. With an arity of 4, 8 or 16 the children of a node are
+ * loaded into one or more SIMD registers, reduced to their maximum, and the
+ * position of the first child equal to the maximum is found with a compare
+ * and a movemask. This replaces a chain of data-dependent branches with a
+ * fixed sequence of instructions.
+ *
+ * 32-bit keys use SSE4.1, and AVX2 for arities of 8 and 16; 64-bit keys
+ * need AVX2. The instruction set is detected at run time with CPUID, unless
+ * the compiler already targets AVX2, and MaxHeap falls back to its scalar
+ * loop on other CPUs, compilers and architectures. The kernels are only
+ * used where this header is included, before the heaps are used; define
+ * MAXHEAP_NO_SIMD to always use the scalar loop.
+ *
+ * The reduction has a longer latency than a scalar loop over a few
+ * children, and the position of the largest child is on the critical path
+ * of a sift-down, so the kernels only pay off when the children fill a
+ * cache line: by default they are used for 32-bit keys with an arity of 16,
+ * where holds on large heaps are about a third faster. For 64-bit keys,
+ * which lack a vector max in AVX2, and for smaller arities the scalar loop
+ * was faster in bench/simd_bench.cpp. Define MAXHEAP_SIMD_ALWAYS to use the
+ * kernels for every supported key type and arity.
+ *
+ * NOTE: the first largest child is selected, exactly like the scalar loop,
+ * as long as no key is NaN.
+ */
+
+#if !defined( MAXHEAP_NO_SIMD ) && defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#define MAXHEAP_SIMD 1
+#include <immintrin.h>
+#endif
+
+#ifdef MAXHEAP_SIMD
+
+#define MAXHEAP_TARGET_SSE41 __attribute__( ( target( "sse4.1" ) ) )
+#define MAXHEAP_TARGET_AVX2 __attribute__( ( target( "avx2" ) ) )
+
+/**
+ * SSE4.1 operations on four 32-bit lanes. Broadcasting the maximum leaves
+ * the maximum of all lanes in every lane.
+ */
+struct SimdSse41Int32 {
+  typedef __m128i Vector;
+  static const size_t LANES = 4;
+  MAXHEAP_TARGET_SSE41 static Vector load( const void* p ) {
+    return _mm_loadu_si128( static_cast<const __m128i*>( p ) );
+  }
+  MAXHEAP_TARGET_SSE41 static Vector max( Vector a, Vector b ) {
+    return _mm_max_epi32( a, b );
+  }
+  MAXHEAP_TARGET_SSE41 static Vector broadcastMax( Vector m ) {
+    m = _mm_max_epi32( m, _mm_shuffle_epi32( m, 0x4E ) );
+    return _mm_max_epi32( m, _mm_shuffle_epi32( m, 0xB1 ) );
+  }
+  MAXHEAP_TARGET_SSE41 static int equalMask( Vector a, Vector b ) {
+    return _mm_movemask_ps( _mm_castsi128_ps( _mm_cmpeq_epi32( a, b ) ) );
+  }
+};
+
+struct SimdSse41UInt32 : SimdSse41Int32 {
+  MAXHEAP_TARGET_SSE41 static Vector max( Vector a, Vector b ) {
+    return _mm_max_epu32( a, b );
+  }
+  MAXHEAP_TARGET_SSE41 static Vector broadcastMax( Vector m ) {
+    m = _mm_max_epu32( m, _mm_shuffle_epi32( m, 0x4E ) );
+    return _mm_max_epu32( m, _mm_shuffle_epi32( m, 0xB1 ) );
+  }
+};
+
+struct SimdSse41Float {
+  typedef __m128 Vector;
+  static const size_t LANES = 4;
+  MAXHEAP_TARGET_SSE41 static Vector load( const void* p ) {
+    return _mm_loadu_ps( static_cast<const float*>( p ) );
+  }
+  MAXHEAP_TARGET_SSE41 static Vector max( Vector a, Vector b ) {
+    return _mm_max_ps( a, b );
+  }
+  MAXHEAP_TARGET_SSE41 static Vector broadcastMax( Vector m ) {
+    m = _mm_max_ps( m, _mm_shuffle_ps( m, m, 0x4E ) );
+    return _mm_max_ps( m, _mm_shuffle_ps( m, m, 0xB1 ) );
+  }
+  MAXHEAP_TARGET_SSE41 static int equalMask( Vector a, Vector b ) {
+    return _mm_movemask_ps( _mm_cmpeq_ps( a, b ) );
+  }
+};
+
+/**
+ * AVX2 operations on eight 32-bit or four 64-bit lanes.
+ */
+struct SimdAvx2Int32 {
+  typedef __m256i Vector;
+  static const size_t LANES = 8;
+  MAXHEAP_TARGET_AVX2 static Vector load( const void* p ) {
+    return _mm256_loadu_si256( static_cast<const __m256i*>( p ) );
+  }
+  MAXHEAP_TARGET_AVX2 static Vector max( Vector a, Vector b ) {
+    return _mm256_max_epi32( a, b );
+  }
+  MAXHEAP_TARGET_AVX2 static Vector broadcastMax( Vector m ) {
+    m = max( m, _mm256_permute2x128_si256( m, m, 1 ) );
+    m = max( m, _mm256_shuffle_epi32( m, 0x4E ) );
+    return max( m, _mm256_shuffle_epi32( m, 0xB1 ) );
+  }
+  MAXHEAP_TARGET_AVX2 static int equalMask( Vector a, Vector b ) {
+    return _mm256_movemask_ps( _mm256_castsi256_ps( _mm256_cmpeq_epi32( a, b ) ) );
+  }
+};
+
+struct SimdAvx2UInt32 : SimdAvx2Int32 {
+  MAXHEAP_TARGET_AVX2 static Vector max( Vector a, Vector b ) {
+    return _mm256_max_epu32( a, b );
+  }
+  MAXHEAP_TARGET_AVX2 static Vector broadcastMax( Vector m ) {
+    m = max( m, _mm256_permute2x128_si256( m, m, 1 ) );
+    m = max( m, _mm256_shuffle_epi32( m, 0x4E ) );
+    return max( m, _mm256_shuffle_epi32( m, 0xB1 ) );
+  }
+};
+
+struct SimdAvx2Float {
+  typedef __m256 Vector;
+  static const size_t LANES = 8;
+  MAXHEAP_TARGET_AVX2 static Vector load( const void* p ) {
+    return _mm256_loadu_ps( static_cast<const float*>( p ) );
+  }
+  MAXHEAP_TARGET_AVX2 static Vector max( Vector a, Vector b ) {
+    return _mm256_max_ps( a, b );
+  }
+  MAXHEAP_TARGET_AVX2 static Vector broadcastMax( Vector m ) {
+    m = max( m, _mm256_permute2f128_ps( m, m, 1 ) );
+    m = max( m, _mm256_permute_ps( m, 0x4E ) );
+    return max( m, _mm256_permute_ps( m, 0xB1 ) );
+  }
+  MAXHEAP_TARGET_AVX2 static int equalMask( Vector a, Vector b ) {
+    return _mm256_movemask_ps( _mm256_cmp_ps( a, b, _CMP_EQ_OQ ) );
+  }
+};
+
+struct SimdAvx2Int64 {
+  typedef __m256i Vector;
+  static const size_t LANES = 4;
+  MAXHEAP_TARGET_AVX2 static Vector load( const void* p ) {
+    return _mm256_loadu_si256( static_cast<const __m256i*>( p ) );
+  }
+  MAXHEAP_TARGET_AVX2 static Vector max( Vector a, Vector b ) {
+    return _mm256_blendv_epi8( a, b, _mm256_cmpgt_epi64( b, a ) );
+  }
+  MAXHEAP_TARGET_AVX2 static Vector broadcastMax( Vector m ) {
+    m = max( m, _mm256_permute2x128_si256( m, m, 1 ) );
+    return max( m, _mm256_shuffle_epi32( m, 0x4E ) );
+  }
+  MAXHEAP_TARGET_AVX2 static int equalMask( Vector a, Vector b ) {
+    return _mm256_movemask_pd( _mm256_castsi256_pd( _mm256_cmpeq_epi64( a, b ) ) );
+  }
+};
+
+/**
+ * Unsigned 64-bit keys are loaded with their sign bit flipped, which maps
+ * their order onto the signed order of AVX2.
+ */
+struct SimdAvx2UInt64 : SimdAvx2Int64 {
+  MAXHEAP_TARGET_AVX2 static Vector load( const void* p ) {
+    return _mm256_xor_si256( _mm256_loadu_si256( static_cast<const __m256i*>( p ) ), _mm256_set1_epi64x( INT64_MIN ) );
+  }
+};
+
+struct SimdAvx2Double {
+  typedef __m256d Vector;
+  static const size_t LANES = 4;
+  MAXHEAP_TARGET_AVX2 static Vector load( const void* p ) {
+    return _mm256_loadu_pd( static_cast<const double*>( p ) );
+  }
+  MAXHEAP_TARGET_AVX2 static Vector max( Vector a, Vector b ) {
+    return _mm256_max_pd( a, b );
+  }
+  MAXHEAP_TARGET_AVX2 static Vector broadcastMax( Vector m ) {
+    m = max( m, _mm256_permute2f128_pd( m, m, 1 ) );
+    return max( m, _mm256_permute_pd( m, 0x5 ) );
+  }
+  MAXHEAP_TARGET_AVX2 static int equalMask( Vector a, Vector b ) {
+    return _mm256_movemask_pd( _mm256_cmp_pd( a, b, _CMP_EQ_OQ ) );
+  }
+};
+
+/**
+ * Returns the position of the first of the specified number of keys equal
+ * to their maximum. The number of keys is a multiple of Ops::LANES, and at
+ * most 16.
+ */
+template<typename Ops>
+MAXHEAP_TARGET_SSE41 size_t simdMaxIndexSse41( const char* keys, size_t count ) {
+  const size_t bytes = sizeof( typename Ops::Vector );
+  size_t vectors = count / Ops::LANES;
+  typename Ops::Vector m = Ops::load( keys );
+  for ( size_t i = 1; i < vectors; i++ ) {
+    m = Ops::max( m, Ops::load( keys + i * bytes ) );
+  }
+  m = Ops::broadcastMax( m );
+  unsigned int mask = 0;
+  for ( size_t i = 0; i < vectors; i++ ) {
+    mask |= static_cast<unsigned int>( Ops::equalMask( Ops::load( keys + i * bytes ), m ) ) << ( i * Ops::LANES );
+  }
+  return __builtin_ctz( mask );
+}
+
+template<typename Ops>
+MAXHEAP_TARGET_AVX2 size_t simdMaxIndexAvx2( const char* keys, size_t count ) {
+  const size_t bytes = sizeof( typename Ops::Vector );
+  size_t vectors = count / Ops::LANES;
+  typename Ops::Vector m = Ops::load( keys );
+  for ( size_t i = 1; i < vectors; i++ ) {
+    m = Ops::max( m, Ops::load( keys + i * bytes ) );
+  }
+  m = Ops::broadcastMax( m );
+  unsigned int mask = 0;
+  for ( size_t i = 0; i < vectors; i++ ) {
+    mask |= static_cast<unsigned int>( Ops::equalMask( Ops::load( keys + i * bytes ), m ) ) << ( i * Ops::LANES );
+  }
+  return __builtin_ctz( mask );
+}
+
+/**
+ * Reports the instruction sets of the running CPU.
+ */
+struct SimdCpu {
+  static bool hasSse41() {
+#ifdef __SSE4_1__
+    return true;
+#else
+    static const bool supported = ( __builtin_cpu_init(), __builtin_cpu_supports( "sse4.1" ) != 0 );
+    return supported;
+#endif
+  }
+
+  static bool hasAvx2() {
+#ifdef __AVX2__
+    return true;
+#else
+    static const bool supported = ( __builtin_cpu_init(), __builtin_cpu_supports( "avx2" ) != 0 );
+    return supported;
+#endif
+  }
+};
+
+/**
+ * Selects the kernels for a key type by its size, and whether it is
+ * integral and signed. Other key types are not vectorized.
+ */
+template<typename T, size_t Size = sizeof( T ), bool Integral = std::is_integral<T>::value, bool Signed = std::is_signed<T>::value>
+struct SimdKey {
+  static const bool SUPPORTED = false;
+  static bool available( size_t ) {
+    return false;
+  }
+  static size_t select( const char*, size_t ) {
+    return 0;
+  }
+};
+
+template<typename Sse41Ops, typename Avx2Ops>
+struct SimdKey32 {
+  static const bool SUPPORTED = true;
+  static bool available( size_t ) {
+    return SimdCpu::hasSse41();
+  }
+  static size_t select( const char* keys, size_t count ) {
+    if ( count >= Avx2Ops::LANES && SimdCpu::hasAvx2() ) {
+      return simdMaxIndexAvx2<Avx2Ops>( keys, count );
+    }
+    return simdMaxIndexSse41<Sse41Ops>( keys, count );
+  }
+};
+
+template<typename Avx2Ops>
+struct SimdKey64 {
+  static const bool SUPPORTED = true;
+  static bool available( size_t ) {
+    return SimdCpu::hasAvx2();
+  }
+  static size_t select( const char* keys, size_t count ) {
+    return simdMaxIndexAvx2<Avx2Ops>( keys, count );
+  }
+};
+
+template<typename T>
+struct SimdKey<T, 4, true, true> : SimdKey32<SimdSse41Int32, SimdAvx2Int32> {
+};
+
+template<typename T>
+struct SimdKey<T, 4, true, false> : SimdKey32<SimdSse41UInt32, SimdAvx2UInt32> {
+};
+
+template<typename T>
+struct SimdKey<T, 4, false, true> : SimdKey32<SimdSse41Float, SimdAvx2Float> {
+};
+
+template<typename T>
+struct SimdKey<T, 8, true, true> : SimdKey64<SimdAvx2Int64> {
+};
+
+template<typename T>
+struct SimdKey<T, 8, true, false> : SimdKey64<SimdAvx2UInt64> {
+};
+
+template<typename T>
+struct SimdKey<T, 8, false, true> : SimdKey64<SimdAvx2Double> {
+};
+
+/**
+ * Specializes the SimdMaxChild hook of MaxHeapSift.h for the key types
+ * with kernels.
+ */
+template<typename T, size_t Arity>
+struct SimdMaxChild<T, Arity, typename std::enable_if<SimdKey<T>::SUPPORTED>::type> {
+
+#ifdef MAXHEAP_SIMD_ALWAYS
+  static const bool ENABLED = Arity == 4 || Arity == 8 || Arity == 16;
+#else
+  static const bool ENABLED = sizeof( T ) == 4 && Arity == 16;
+#endif
+
+  static bool available() {
+    return SimdKey<T>::available( Arity );
+  }
+
+  static size_t select( const T* children ) {
+    return SimdKey<T>::select( reinterpret_cast<const char*>( children ), Arity );
+  }
+
+};
+
+#endif
+
+#endif
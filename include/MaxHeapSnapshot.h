@@ -0,0 +1,194 @@
+#ifndef MAXHEAPSNAPSHOT_H
+#define MAXHEAPSNAPSHOT_H
+
+/*
+ * The MIT Licese (MIT)
+ *
+ * Copyright (C) 2016 by Brian Horn, trycatchhorn@gmail.com.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#if defined( __unix__ ) || defined( __APPLE__ )
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "MaxHeapLayout.h"
+
+/*
+ * File format of max-heap snapshots, written by saveMaxHeapSnapshot()
+ * and opened by MappedMaxHeap. A snapshot is a fixed header of 64 bytes
+ * followed by the array backing the heap, stored as raw bytes with room
+ * for capacity elements. The format is specific to the machine: the
+ * header records the byte order and the size of an element, and a
+ * snapshot is refused where they differ.
+ */
+
+#define MAXHEAP_SNAPSHOT_VERSION 1
+
+// Defined in MaxHeap.h, which must be included to save a snapshot.
+template<typename T, size_t Arity, typename Layout, typename Stats> class MaxHeap;
+
+/**
+ * The header at the start of a snapshot file.
+ */
+struct MaxHeapSnapshotHeader {
+  char magic[ 8 ];
+  uint32_t version;
+  uint32_t header_bytes;
+  uint64_t byte_order;
+  uint64_t element_bytes;
+  uint64_t arity;
+  uint64_t size;
+  uint64_t capacity;
+  uint64_t reserved;
+
+  /**
+   * Creates the header of a snapshot of the current version.
+   *
+   * @param element_bytes the size of an element.
+   * @param arity the arity of the heap.
+   * @param size the number of elements in the heap.
+   * @param capacity the number of elements the file has room for.
+   */
+  MaxHeapSnapshotHeader( uint64_t element_bytes, uint64_t arity, uint64_t size, uint64_t capacity )
+    : version( MAXHEAP_SNAPSHOT_VERSION ), header_bytes( sizeof( MaxHeapSnapshotHeader ) ), byte_order( BYTE_ORDER_MARK ),
+      element_bytes( element_bytes ), arity( arity ), size( size ), capacity( capacity ), reserved( 0 ) {
+    std::memcpy( magic, magicBytes(), sizeof( magic ) );
+  }
+
+  /**
+   * Throws std::runtime_error unless this header is of the current version
+   * and describes heaps of the specified element size and arity.
+   *
+   * @param element_bytes the expected size of an element.
+   * @param arity the expected arity of the heap.
+   */
+  void validate( uint64_t element_bytes, uint64_t arity ) const {
+    if ( std::memcmp( magic, magicBytes(), sizeof( magic ) ) != 0 ) {
+      throw std::runtime_error( "Not a max-heap snapshot!" );
+    }
+    if ( version != MAXHEAP_SNAPSHOT_VERSION || header_bytes != sizeof( MaxHeapSnapshotHeader ) ) {
+      throw std::runtime_error( "Unsupported max-heap snapshot version!" );
+    }
+    if ( byte_order != BYTE_ORDER_MARK || this->element_bytes != element_bytes || this->arity != arity ) {
+      throw std::runtime_error( "Max-heap snapshot does not match the element type or arity!" );
+    }
+    if ( size > capacity ) {
+      throw std::runtime_error( "Max-heap snapshot is corrupt!" );
+    }
+  }
+
+  static const uint64_t BYTE_ORDER_MARK = 0x0102030405060708ULL;
+
+  /**
+   * Returns the eight bytes identifying a snapshot file.
+   */
+  static const char* magicBytes() {
+    return "MAXHEAP";
+  }
+};
+
+/**
+ * Thrown when a snapshot has replaced the previous file but the rename
+ * could not be flushed to disk. The new snapshot is readable, but a crash
+ * before the directory reaches the disk may still bring back the previous
+ * one.
+ */
+class MaxHeapSnapshotDurabilityError : public std::runtime_error {
+
+ public:
+
+  explicit MaxHeapSnapshotDurabilityError( const std::string& message ) : std::runtime_error( message ) {
+  }
+};
+
+/**
+ * Writes a snapshot of the specified heap array to the specified file and
+ * flushes it to disk. The snapshot is written to path + ".tmp" and renamed
+ * over the file, and the rename is flushed too, so a crash leaves either
+ * the previous snapshot or the new one, never a partial file. Throws
+ * std::runtime_error if the snapshot cannot be written, leaving the
+ * previous snapshot in place, and MaxHeapSnapshotDurabilityError if the
+ * file has already been replaced but its directory cannot be flushed.
+ *
+ * @param path of the snapshot file.
+ * @param data the array backing the heap.
+ * @param element_bytes the size of an element.
+ * @param arity the arity of the heap.
+ * @param size the number of elements in the heap.
+ */
+inline void writeMaxHeapSnapshot( const std::string& path, const void* data, size_t element_bytes, size_t arity, size_t size ) {
+  std::string temporary = path + ".tmp";
+  std::FILE* file = std::fopen( temporary.c_str(), "wb" );
+  if ( file == 0 ) {
+    throw std::runtime_error( "Cannot create snapshot " + temporary + "!" );
+  }
+  MaxHeapSnapshotHeader header( element_bytes, arity, size, size );
+  bool written = std::fwrite( &header, sizeof( header ), 1, file ) == 1
+                 && ( size == 0 || std::fwrite( data, element_bytes, size, file ) == size )
+                 && std::fflush( file ) == 0;
+#if defined( __unix__ ) || defined( __APPLE__ )
+  written = written && fsync( fileno( file ) ) == 0;
+#endif
+  written = std::fclose( file ) == 0 && written;
+  if ( !written || std::rename( temporary.c_str(), path.c_str() ) != 0 ) {
+    std::remove( temporary.c_str() );
+    throw std::runtime_error( "Cannot write snapshot " + path + "!" );
+  }
+#if defined( __unix__ ) || defined( __APPLE__ )
+  size_t slash = path.find_last_of( '/' );
+  std::string directory = slash == std::string::npos ? "." : ( slash == 0 ? "/" : path.substr( 0, slash ) );
+  int descriptor = open( directory.c_str(), O_RDONLY );
+  bool synced = descriptor >= 0 && fsync( descriptor ) == 0;
+  if ( descriptor >= 0 ) {
+    close( descriptor );
+  }
+  if ( !synced ) {
+    throw MaxHeapSnapshotDurabilityError( "Snapshot " + path + " was replaced but its directory cannot be flushed!" );
+  }
+#endif
+}
+
+/**
+ * Saves the array backing the specified max-heap to the specified file,
+ * like writeMaxHeapSnapshot(), so that it can be reopened with
+ * MappedMaxHeap without parsing or rebuilding. Requires a trivially
+ * copyable T and the implicit layout.
+ *
+ * @param heap the max-heap to save.
+ * @param path of the snapshot file, which is replaced atomically.
+ */
+template<typename T, size_t Arity, typename Layout, typename Stats>
+void saveMaxHeapSnapshot( const MaxHeap<T, Arity, Layout, Stats>& heap, const std::string& path ) {
+  static_assert( std::is_trivially_copyable<T>::value, "Snapshots require a trivially copyable type" );
+  static_assert( std::is_same<Layout, ImplicitLayout>::value, "Snapshots require the implicit layout" );
+  writeMaxHeapSnapshot( path, heap.data(), sizeof( T ), Arity, heap.getSize() );
+}
+
+#endif
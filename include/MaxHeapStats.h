@@ -0,0 +1,419 @@
+#ifndef MAXHEAPSTATS_H
+#define MAXHEAPSTATS_H
+
+/*
+ * The MIT Licese (MIT)
+ *
+ * Copyright (C) 2016 by Brian Horn, trycatchhorn@gmail.com.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Instrumentation policies count what a MaxHeap does, to explain where its
+ * time goes. MaxHeap takes a policy as its fourth template parameter and
+ * calls its hooks from the hot paths. The default, NoMaxHeapStats, has
+ * empty inline hooks and no state, so an uninstrumented heap compiles to
+ * the same code as before. InstanceMaxHeapStats counts per heap, and
+ * ThreadLocalMaxHeapStats counts per thread over every heap using it.
+ *
+ * A policy provides:
+ *   PARALLEL_SAFE      true if the hooks may be called from several threads
+ *                      working on the same heap, as a PARALLEL build does.
+ *   compared( n )      n comparisons of elements were done.
+ *   moved()            an element was written into the backing vector by a
+ *                      sift routine.
+ *   descended()        a sift moved one level.
+ *   sifted()           a sift ended.
+ *   reallocated( before, after )  the capacity of the backing vector may
+ *                      have changed from before to after.
+ *   inserted( n ), extracted( n ), removed(), sorted()  an operation was
+ *                      done on n elements.
+ *   merge( other )     adds the counts of another heap that worked on
+ *                      behalf of this one.
+ *   snapshot()         returns the counts as a MaxHeapStats.
+ *   reset()            sets the counts to zero.
+ */
+
+/**
+ * The counts of an instrumented max-heap. A snapshot is a plain value that
+ * can be exported, and two snapshots can be subtracted to get the counts
+ * of the interval between them.
+ */
+struct MaxHeapStats {
+  /** Calls of operator< on elements. */
+  uint64_t comparisons;
+  /**
+   * Elements written into the backing vector by the sift routines. The
+   * sifts move elements through a hole instead of swapping them, at one
+   * move per level plus one for the sifted element.
+   */
+  uint64_t moves;
+  /** Sifts up or down, including those of heap construction. */
+  uint64_t sifts;
+  /** Levels moved by all sifts; sift_levels / sifts is the mean depth. */
+  uint64_t sift_levels;
+  /** Levels moved by the deepest sift. */
+  uint64_t max_sift_depth;
+  /** Changes of the capacity of the backing vector. */
+  uint64_t reallocations;
+  /** Elements inserted by maxHeapInsert(), emplace() and insertRange(). */
+  uint64_t inserts;
+  /** Elements extracted by heapExtractMax() and extractBatch(). */
+  uint64_t extracts;
+  /** Calls of removeAt(). */
+  uint64_t removes;
+  /** Calls of heapSort(), sortInPlace() and sortInto(). */
+  uint64_t sorts;
+
+  MaxHeapStats() {
+    reset();
+  }
+
+  /**
+   * Sets every count to zero.
+   */
+  void reset() {
+    comparisons = 0;
+    moves = 0;
+    sifts = 0;
+    sift_levels = 0;
+    max_sift_depth = 0;
+    reallocations = 0;
+    inserts = 0;
+    extracts = 0;
+    removes = 0;
+    sorts = 0;
+  }
+
+  /**
+   * Adds the counts of the specified stats to these; the deepest sift is
+   * the deeper of the two.
+   *
+   * @param  other the stats to add.
+   * @return a reference to these stats.
+   */
+  MaxHeapStats& operator += ( const MaxHeapStats& other ) {
+    comparisons += other.comparisons;
+    moves += other.moves;
+    sifts += other.sifts;
+    sift_levels += other.sift_levels;
+    max_sift_depth = std::max( max_sift_depth, other.max_sift_depth );
+    reallocations += other.reallocations;
+    inserts += other.inserts;
+    extracts += other.extracts;
+    removes += other.removes;
+    sorts += other.sorts;
+    return *this;
+  }
+
+  /**
+   * Returns the counts of the interval between an earlier snapshot and
+   * this one. The deepest sift is that of this snapshot, since it cannot
+   * be attributed to an interval.
+   *
+   * @param  earlier a snapshot of the same counts taken before this one.
+   * @return the difference of the counts.
+   */
+  MaxHeapStats since( const MaxHeapStats& earlier ) const {
+    MaxHeapStats delta( *this );
+    delta.comparisons -= earlier.comparisons;
+    delta.moves -= earlier.moves;
+    delta.sifts -= earlier.sifts;
+    delta.sift_levels -= earlier.sift_levels;
+    delta.reallocations -= earlier.reallocations;
+    delta.inserts -= earlier.inserts;
+    delta.extracts -= earlier.extracts;
+    delta.removes -= earlier.removes;
+    delta.sorts -= earlier.sorts;
+    return delta;
+  }
+};
+
+/**
+ * Records the counts of one heap or thread, keeping the depth of the sift
+ * in progress apart from the snapshot.
+ */
+class MaxHeapStatsRecorder {
+
+ public:
+
+  MaxHeapStatsRecorder() : depth( 0 ) {
+  }
+
+  void compared( uint64_t n ) {
+    counts.comparisons += n;
+  }
+
+  void moved() {
+    counts.moves++;
+  }
+
+  void descended() {
+    depth++;
+  }
+
+  void sifted() {
+    counts.sifts++;
+    counts.sift_levels += depth;
+    counts.max_sift_depth = std::max( counts.max_sift_depth, depth );
+    depth = 0;
+  }
+
+  void reallocated( size_t before, size_t after ) {
+    counts.reallocations += before != after ? 1 : 0;
+  }
+
+  void inserted( uint64_t n ) {
+    counts.inserts += n;
+  }
+
+  void extracted( uint64_t n ) {
+    counts.extracts += n;
+  }
+
+  void removed() {
+    counts.removes++;
+  }
+
+  void sorted() {
+    counts.sorts++;
+  }
+
+  const MaxHeapStats& snapshot() const {
+    return counts;
+  }
+
+  void merge( const MaxHeapStats& other ) {
+    counts += other;
+  }
+
+  void reset() {
+    counts.reset();
+    depth = 0;
+  }
+
+ private:
+  MaxHeapStats counts;
+  uint64_t depth;
+
+};
+
+/**
+ * The default policy, which counts nothing. Its hooks are empty and it has
+ * no state, and MaxHeap derives from its policy instead of holding it as a
+ * member, so it costs neither time nor space.
+ */
+struct NoMaxHeapStats {
+
+  static const bool PARALLEL_SAFE = true;
+
+  void compared( uint64_t = 1 ) {
+  }
+
+  void moved() {
+  }
+
+  void descended() {
+  }
+
+  void sifted() {
+  }
+
+  void reallocated( size_t, size_t ) {
+  }
+
+  void inserted( uint64_t = 1 ) {
+  }
+
+  void extracted( uint64_t = 1 ) {
+  }
+
+  void removed() {
+  }
+
+  void sorted() {
+  }
+
+  void merge( const NoMaxHeapStats& ) {
+  }
+
+  MaxHeapStats snapshot() const {
+    return MaxHeapStats();
+  }
+
+  void reset() {
+  }
+
+};
+
+/**
+ * Counts per heap. Copies and moves of a heap carry its counts along. The
+ * hooks are not synchronized, so a PARALLEL build of an instrumented heap
+ * runs on the calling thread only.
+ */
+class InstanceMaxHeapStats {
+
+ public:
+
+  static const bool PARALLEL_SAFE = false;
+
+  void compared( uint64_t n = 1 ) {
+    recorder.compared( n );
+  }
+
+  void moved() {
+    recorder.moved();
+  }
+
+  void descended() {
+    recorder.descended();
+  }
+
+  void sifted() {
+    recorder.sifted();
+  }
+
+  void reallocated( size_t before, size_t after ) {
+    recorder.reallocated( before, after );
+  }
+
+  void inserted( uint64_t n = 1 ) {
+    recorder.inserted( n );
+  }
+
+  void extracted( uint64_t n = 1 ) {
+    recorder.extracted( n );
+  }
+
+  void removed() {
+    recorder.removed();
+  }
+
+  void sorted() {
+    recorder.sorted();
+  }
+
+  void merge( const InstanceMaxHeapStats& other ) {
+    recorder.merge( other.snapshot() );
+  }
+
+  MaxHeapStats snapshot() const {
+    return recorder.snapshot();
+  }
+
+  void reset() {
+    recorder.reset();
+  }
+
+ private:
+  MaxHeapStatsRecorder recorder;
+
+};
+
+/**
+ * Counts per thread, over every heap instrumented with this policy. The
+ * policy has no state of its own: snapshot() and reset() of any such heap,
+ * or the static current() and clear(), see the counts of the calling
+ * thread. Work done by the worker threads of a PARALLEL build is counted
+ * on those threads, and is lost when they exit.
+ */
+class ThreadLocalMaxHeapStats {
+
+ public:
+
+  static const bool PARALLEL_SAFE = true;
+
+  /**
+   * Returns the counts of the calling thread.
+   *
+   * @return a snapshot of the counts of the calling thread.
+   */
+  static MaxHeapStats current() {
+    return local().snapshot();
+  }
+
+  /**
+   * Sets the counts of the calling thread to zero.
+   */
+  static void clear() {
+    local().reset();
+  }
+
+  void compared( uint64_t n = 1 ) {
+    local().compared( n );
+  }
+
+  void moved() {
+    local().moved();
+  }
+
+  void descended() {
+    local().descended();
+  }
+
+  void sifted() {
+    local().sifted();
+  }
+
+  void reallocated( size_t before, size_t after ) {
+    local().reallocated( before, after );
+  }
+
+  void inserted( uint64_t n = 1 ) {
+    local().inserted( n );
+  }
+
+  void extracted( uint64_t n = 1 ) {
+    local().extracted( n );
+  }
+
+  void removed() {
+    local().removed();
+  }
+
+  void sorted() {
+    local().sorted();
+  }
+
+  void merge( const ThreadLocalMaxHeapStats& ) {
+  }
+
+  MaxHeapStats snapshot() const {
+    return current();
+  }
+
+  void reset() {
+    clear();
+  }
+
+ private:
+
+  static MaxHeapStatsRecorder& local() {
+    static thread_local MaxHeapStatsRecorder recorder;
+    return recorder;
+  }
+
+};
+
+#endif
@@ -0,0 +1,267 @@
+#ifndef MULTIQUEUE_H
+#define MULTIQUEUE_H
+
+/*
+ * The MIT Licese (MIT)
+ *
+ * Copyright (C) 2016 by Brian Horn, trycatchhorn@gmail.com.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "MaxHeap.h"
+
+/**
+ * A relaxed concurrent max-priority queue in the style of the MultiQueue of
+ * Rihani, Sanders and Dementiev.
+ *
+ * The elements are spread over factor * threads shards. Each shard is a
+ * MaxHeap guarded by its own mutex, which is only ever try-locked. A push
+ * goes to a random shard. A pop samples two random shards and extracts the
+ * larger of their two maxima. Threads rarely meet on the same shard, so
+ * throughput scales with the number of threads. The price is that a pop
+ * returns one of the largest elements, not necessarily the largest: the
+ * expected rank error grows linearly with the number of shards.
+ *
+ * NOTE: getSize() and empty() are exact only while no other thread pushes
+ * or pops.
+ */
+template<typename T, size_t Arity = 2>
+class MultiQueue {
+
+ public:
+
+  /**
+   * Creates an empty queue with factor * threads shards.
+   *
+   * @param  threads the number of threads expected to use the queue, where
+   *         zero selects std::thread::hardware_concurrency().
+   * @param  factor the number of shards per thread.
+   */
+  explicit MultiQueue( size_t threads = 0, size_t factor = 2 );
+
+  MultiQueue( const MultiQueue& ) = delete;
+
+  MultiQueue& operator=( const MultiQueue& ) = delete;
+
+  /**
+   * Returns the number of shards of the queue.
+   *
+   * @return the number of shards.
+   */
+  size_t getShardCount() const;
+
+  /**
+   * Returns the number of elements in the queue.
+   *
+   * @return the size of the queue.
+   */
+  size_t getSize() const;
+
+  /**
+   * Returns if the queue is empty.
+   *
+   * @return true if the queue is empty, otherwise false.
+   */
+  bool empty() const;
+
+  /**
+   * Inserts the specified key into a random shard.
+   *
+   * @param  key the key to be inserted.
+   */
+  void push( const T& key );
+
+  /**
+   * Moves the specified key into a random shard.
+   *
+   * @param  key the key to be inserted.
+   */
+  void push( T&& key );
+
+  /**
+   * Removes the larger of the maxima of two randomly sampled shards. When
+   * the samples keep hitting empty shards, every shard is scanned in turn,
+   * so an element is found as long as the queue is not empty.
+   *
+   * @param  result receives the removed element.
+   * @return true if an element was removed, false if the queue is empty.
+   */
+  bool tryPop( T& result );
+
+ private:
+
+  /**
+   * A MaxHeap together with the mutex guarding it.
+   */
+  struct Shard {
+    std::mutex mutex;
+    MaxHeap<T, Arity> heap;
+  };
+
+  std::vector<Shard> shards;
+  std::atomic<size_t> size;
+
+  /**
+   * Returns the index of a random shard, drawn from a generator owned by
+   * the calling thread.
+   *
+   * @return the index of a shard.
+   */
+  size_t randomShard() const;
+
+  /**
+   * Extracts the maximum of the first non-empty shard, try-locking the
+   * shards one at a time. Busy shards are skipped, and the scan repeats
+   * until it finds an element or the queue is empty.
+   *
+   * @param  result receives the removed element.
+   * @return true if an element was removed, false if every shard is empty.
+   */
+  bool scanPop( T& result );
+
+};
+
+template<typename T, size_t Arity>
+MultiQueue<T, Arity>::MultiQueue( size_t threads, size_t factor ) : size( 0 ) {
+  if ( threads == 0 ) {
+    threads = std::thread::hardware_concurrency();
+  }
+  size_t count = std::max<size_t>( 1, threads * factor );
+  std::vector<Shard> created( count );
+  shards.swap( created );
+}
+
+template<typename T, size_t Arity>
+size_t MultiQueue<T, Arity>::getShardCount() const {
+  return shards.size();
+}
+
+template<typename T, size_t Arity>
+size_t MultiQueue<T, Arity>::getSize() const {
+  return size.load();
+}
+
+template<typename T, size_t Arity>
+bool MultiQueue<T, Arity>::empty() const {
+  return size.load() == 0;
+}
+
+template<typename T, size_t Arity>
+void MultiQueue<T, Arity>::push( const T& key ) {
+  push( T( key ) );
+}
+
+template<typename T, size_t Arity>
+void MultiQueue<T, Arity>::push( T&& key ) {
+  while ( true ) {
+    Shard& shard = shards[ randomShard() ];
+    std::unique_lock<std::mutex> lock( shard.mutex, std::try_to_lock );
+    if ( lock.owns_lock() ) {
+      shard.heap.maxHeapInsert( std::move( key ) );
+      size.fetch_add( 1 );
+      return;
+    }
+  }
+}
+
+template<typename T, size_t Arity>
+bool MultiQueue<T, Arity>::tryPop( T& result ) {
+  size_t misses = 0;
+  while ( size.load() > 0 ) {
+    if ( misses > 2 * shards.size() ) {
+      return scanPop( result );
+    }
+    size_t first = randomShard();
+    size_t second = randomShard();
+    std::unique_lock<std::mutex> first_lock( shards[ first ].mutex, std::try_to_lock );
+    if ( !first_lock.owns_lock() ) {
+      continue;
+    }
+    std::unique_lock<std::mutex> second_lock;
+    if ( second != first ) {
+      second_lock = std::unique_lock<std::mutex>( shards[ second ].mutex, std::try_to_lock );
+      if ( !second_lock.owns_lock() ) {
+        continue;
+      }
+    }
+    MaxHeap<T, Arity>* best = 0;
+    if ( !shards[ first ].heap.empty() ) {
+      best = &shards[ first ].heap;
+    }
+    MaxHeap<T, Arity>& other = shards[ second ].heap;
+    if ( !other.empty() && ( best == 0 || best->heapMaximum() < other.heapMaximum() ) ) {
+      best = &other;
+    }
+    if ( best == 0 ) {
+      misses++;
+      continue;
+    }
+    result = best->heapExtractMax();
+    size.fetch_sub( 1 );
+    return true;
+  }
+  return false;
+}
+
+template<typename T, size_t Arity>
+bool MultiQueue<T, Arity>::scanPop( T& result ) {
+  while ( size.load() > 0 ) {
+    size_t start = randomShard();
+    bool skipped = false;
+    for ( size_t i = 0; i < shards.size(); i++ ) {
+      Shard& shard = shards[ ( start + i ) % shards.size() ];
+      std::unique_lock<std::mutex> lock( shard.mutex, std::try_to_lock );
+      if ( !lock.owns_lock() ) {
+        skipped = true;
+        continue;
+      }
+      if ( !shard.heap.empty() ) {
+        result = shard.heap.heapExtractMax();
+        size.fetch_sub( 1 );
+        return true;
+      }
+    }
+    if ( !skipped ) {
+      return false;
+    }
+  }
+  return false;
+}
+
+template<typename T, size_t Arity>
+size_t MultiQueue<T, Arity>::randomShard() const {
+  static thread_local uint64_t state = std::hash<std::thread::id>()( std::this_thread::get_id() ) | 1;
+  state ^= state >> 12;
+  state ^= state << 25;
+  state ^= state >> 27;
+  return static_cast<size_t>( ( state * 0x2545F4914F6CDD1DULL ) >> 32 ) % shards.size();
+}
+
+#endif
@@ -0,0 +1,249 @@
+#ifndef NODEPOOL_H
+#define NODEPOOL_H
+
+/*
+ * The MIT Licese (MIT)
+ *
+ * Copyright (C) 2016 by Brian Horn, trycatchhorn@gmail.com.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+*/
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/**
+ * A pool allocator for the nodes of linked heaps. Nodes are carved out of
+ * chunks that double in size up to a limit, and freed nodes are kept in a
+ * free list for reuse, so a steady stream of insertions and removals does
+ * not call malloc at all.
+ *
+ * The memory of one pool can be spliced into another in O(1), which lets
+ * two heaps meld without copying their nodes.
+ *
+ * NOTE: the pool releases its memory on destruction without running the
+ * destructors of live nodes; the owner must destroy them first.
+ */
+template<typename T>
+class NodePool {
+
+ public:
+
+  /**
+   * Creates an empty pool, which allocates its first chunk on demand.
+   */
+  NodePool();
+
+  /**
+   * Releases the memory of the pool.
+   */
+  ~NodePool();
+
+  /**
+   * Constructs a node in the pool from the specified arguments.
+   *
+   * @param  args the arguments passed to the constructor of T.
+   * @return the constructed node.
+   */
+  template<typename... Args>
+  T* create( Args&&... args );
+
+  /**
+   * Destroys the specified node and returns its memory to the free list.
+   *
+   * @param node a node created by this pool, or by a pool spliced into it.
+   */
+  void destroy( T* node );
+
+  /**
+   * Takes over the memory of the specified pool in O(1). Nodes created by
+   * the other pool stay valid and are destroyed through this pool from
+   * now on; the other pool is left empty.
+   *
+   * @param other the pool to be spliced into this pool.
+   */
+  void splice( NodePool<T>& other );
+
+  /**
+   * Exchanges the memory of this pool with the specified pool.
+   *
+   * @param other the pool to swap with.
+   */
+  void swap( NodePool<T>& other );
+
+  /**
+   * Returns the number of chunks allocated by the pool, to measure how
+   * often it calls the system allocator.
+   *
+   * @return the number of chunks allocated by the pool.
+   */
+  size_t getChunkCount() const;
+
+ private:
+
+  union Slot {
+    Slot* next;
+    typename std::aligned_storage<sizeof( T ), alignof( T )>::type storage;
+  };
+
+  struct Chunk {
+    Chunk* next;
+    Slot* slots;
+  };
+
+  static const size_t FIRST_CHUNK_SIZE = 32;
+  static const size_t MAX_CHUNK_SIZE = 4096;
+
+  Chunk* chunks;
+  Chunk* last_chunk;
+  size_t chunk_count;
+  size_t next_chunk_size;
+  Slot* free_slots;
+  Slot* last_free_slot;
+
+  NodePool( const NodePool<T>& other );
+  NodePool<T>& operator = ( const NodePool<T>& other );
+
+  /**
+   * Allocates a new chunk and adds its slots to the free list.
+   */
+  void grow();
+
+};
+
+template<typename T>
+const size_t NodePool<T>::FIRST_CHUNK_SIZE;
+
+template<typename T>
+const size_t NodePool<T>::MAX_CHUNK_SIZE;
+
+template<typename T>
+NodePool<T>::NodePool()
+  : chunks( 0 ), last_chunk( 0 ), chunk_count( 0 ), next_chunk_size( FIRST_CHUNK_SIZE ), free_slots( 0 ), last_free_slot( 0 ) {
+}
+
+template<typename T>
+NodePool<T>::~NodePool() {
+  while ( chunks != 0 ) {
+    Chunk* next = chunks->next;
+    delete[] chunks->slots;
+    delete chunks;
+    chunks = next;
+  }
+}
+
+template<typename T>
+template<typename... Args>
+T* NodePool<T>::create( Args&&... args ) {
+  if ( free_slots == 0 ) {
+    grow();
+  }
+  Slot* slot = free_slots;
+  free_slots = slot->next;
+  if ( free_slots == 0 ) {
+    last_free_slot = 0;
+  }
+  return new ( &slot->storage ) T( std::forward<Args>( args )... );
+}
+
+template<typename T>
+void NodePool<T>::destroy( T* node ) {
+  node->~T();
+  Slot* slot = reinterpret_cast<Slot*>( node );
+  slot->next = free_slots;
+  if ( free_slots == 0 ) {
+    last_free_slot = slot;
+  }
+  free_slots = slot;
+}
+
+template<typename T>
+void NodePool<T>::splice( NodePool<T>& other ) {
+  if ( this == &other ) {
+    return;
+  }
+  if ( other.chunks != 0 ) {
+    if ( chunks == 0 ) {
+      chunks = other.chunks;
+    } else {
+      last_chunk->next = other.chunks;
+    }
+    last_chunk = other.last_chunk;
+  }
+  if ( other.free_slots != 0 ) {
+    if ( free_slots == 0 ) {
+      free_slots = other.free_slots;
+    } else {
+      last_free_slot->next = other.free_slots;
+    }
+    last_free_slot = other.last_free_slot;
+  }
+  chunk_count += other.chunk_count;
+  if ( next_chunk_size < other.next_chunk_size ) {
+    next_chunk_size = other.next_chunk_size;
+  }
+  other.chunks = 0;
+  other.last_chunk = 0;
+  other.chunk_count = 0;
+  other.next_chunk_size = FIRST_CHUNK_SIZE;
+  other.free_slots = 0;
+  other.last_free_slot = 0;
+}
+
+template<typename T>
+void NodePool<T>::swap( NodePool<T>& other ) {
+  std::swap( chunks, other.chunks );
+  std::swap( last_chunk, other.last_chunk );
+  std::swap( chunk_count, other.chunk_count );
+  std::swap( next_chunk_size, other.next_chunk_size );
+  std::swap( free_slots, other.free_slots );
+  std::swap( last_free_slot, other.last_free_slot );
+}
+
+template<typename T>
+size_t NodePool<T>::getChunkCount() const {
+  return chunk_count;
+}
+
+template<typename T>
+void NodePool<T>::grow() {
+  Chunk* chunk = new Chunk();
+  chunk->next = 0;
+  chunk->slots = new Slot[ next_chunk_size ];
+  for ( size_t i = 0; i + 1 < next_chunk_size; i++ ) {
+    chunk->slots[ i ].next = &chunk->slots[ i + 1 ];
+  }
+  chunk->slots[ next_chunk_size - 1 ].next = 0;
+  free_slots = chunk->slots;
+  last_free_slot = &chunk->slots[ next_chunk_size - 1 ];
+  if ( chunks == 0 ) {
+    chunks = chunk;
+  } else {
+    last_chunk->next = chunk;
+  }
+  last_chunk = chunk;
+  chunk_count++;
+  if ( next_chunk_size < MAX_CHUNK_SIZE ) {
+    next_chunk_size *= 2;
+  }
+}
+
+#endif
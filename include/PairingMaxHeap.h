@@ -0,0 +1,492 @@
+#ifndef PAIRINGMAXHEAP_H
+#define PAIRINGMAXHEAP_H
+
+/*
+ * The MIT Licese (MIT)
+ *
+ * Copyright (C) 2016 by Brian Horn, trycatchhorn@gmail.com.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+*/
+
+#include "NodePool.h"
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/**
+ * A mergeable max-heap implemented as a pairing heap. Two heaps meld in
+ * O(1) by linking their roots and splicing their node pools, instead of
+ * the O(n + m) rebuild needed to merge two MaxHeaps. Insertion and
+ * increaseKey take O(1), and extracting or erasing an element takes
+ * O(log n) amortized.
+ *
+ * Every inserted element is identified by a handle, which stays valid
+ * while the element is in the heap, including after the heap has been
+ * melded into another one. The nodes are allocated from a NodePool.
+ *
+ * NOTE: a handle becomes invalid when its element leaves the heap, and
+ * using it afterwards is undefined behaviour.
+ *
+ * NOTE: following child and sibling pointers misses the cache far more
+ * than the implicit layout of MaxHeap, which remains the better choice
+ * when heaps are not melded: see bench/pairing_bench.cpp.
+ */
+template<typename T>
+class PairingMaxHeap {
+
+  struct Node;
+
+ public:
+
+  /**
+   * Identifies an element in the max-heap.
+   */
+  typedef Node* Handle;
+
+  /**
+   * Creates an empty max-heap.
+   */
+  PairingMaxHeap();
+
+  /**
+   * Move constructor, leaving the other max-heap empty.
+   *
+   * @param other the max-heap to be moved.
+   */
+  PairingMaxHeap( PairingMaxHeap<T>&& other );
+
+  /**
+   * Destroys the elements of the max-heap.
+   */
+  ~PairingMaxHeap();
+
+  /**
+   * Move assignment operator, leaving the other max-heap empty.
+   *
+   * @param  other the max-heap to be moved.
+   * @return this max-heap.
+   */
+  PairingMaxHeap<T>& operator = ( PairingMaxHeap<T>&& other );
+
+  /**
+   * Returns the size of the max-heap.
+   *
+   * @return the size of the max-heap.
+   */
+  size_t getSize() const;
+
+  /**
+   * Returns if the max-heap is empty.
+   *
+   * @return true if the max-heap is empty, otherwise false.
+   */
+  bool empty() const;
+
+  /**
+   * Returns the element referred to by the specified handle.
+   *
+   * @param  handle of an element in the max-heap.
+   * @return the element referred to by the handle.
+   */
+  const T& get( Handle handle ) const;
+
+  /**
+   * Returns the element with the maximum key in the max-heap.
+   *
+   * @return the element with the maximum key in the max-heap.
+   */
+  const T& heapMaximum() const;
+
+  /**
+   * Returns the handle of the element with the maximum key in the max-heap.
+   *
+   * @return the handle of the element with the maximum key.
+   */
+  Handle maximumHandle() const;
+
+  /**
+   * Removes and returns the element with the maximum key in the max-heap
+   * in O(log n) amortized. The handle of the element becomes invalid.
+   *
+   * @return the element with the maximum key in the max-heap.
+   */
+  T heapExtractMax();
+
+  /**
+   * Inserts the specified key into the max-heap in O(1).
+   *
+   * @param  key the key to be inserted into the max-heap.
+   * @return the handle of the inserted element.
+   */
+  Handle maxHeapInsert( const T& key );
+
+  /**
+   * Inserts the specified key into the max-heap by moving it, in O(1).
+   *
+   * @param  key the key to be moved into the max-heap.
+   * @return the handle of the inserted element.
+   */
+  Handle maxHeapInsert( T&& key );
+
+  /**
+   * Removes and returns the element referred to by the specified handle in
+   * O(log n) amortized. The handle becomes invalid.
+   *
+   * @param  handle of the element to be removed.
+   * @return the element being removed.
+   */
+  T erase( Handle handle );
+
+  /**
+   * Replaces the element referred to by the specified handle with a key
+   * that is not smaller, in O(1).
+   *
+   * @param  handle of the element to be changed.
+   * @param  key the new key, which must not be smaller than the current key.
+   */
+  void increaseKey( Handle handle, T key );
+
+  /**
+   * Moves all elements of the specified max-heap into this max-heap in
+   * O(1). The handles of the moved elements stay valid, and the other
+   * max-heap is left empty.
+   *
+   * @param other the max-heap to be melded into this max-heap.
+   */
+  void meld( PairingMaxHeap<T>& other );
+
+  /**
+   * Removes all elements from the max-heap. The memory of the nodes is
+   * kept for reuse.
+   */
+  void clear();
+
+  /**
+   * Determines if every node is not larger than its parent, and if the
+   * links of the tree and the size are consistent. Takes O(n).
+   *
+   * @return true if the heap is consistent, false otherwise.
+   */
+  bool isMaxHeap() const;
+
+ private:
+
+  /**
+   * A node of the pairing heap. The children of a node form a list
+   * starting at child and linked through sibling; prev points to the left
+   * sibling, or to the parent for the first child.
+   */
+  struct Node {
+    T key;
+    Node* child;
+    Node* sibling;
+    Node* prev;
+
+    template<typename... Args>
+    explicit Node( Args&&... args ) : key( std::forward<Args>( args )... ), child( 0 ), sibling( 0 ), prev( 0 ) {
+    }
+  };
+
+  Node* root;
+  size_t size;
+  NodePool<Node> pool;
+  std::vector<Node*> pairs;
+
+  PairingMaxHeap( const PairingMaxHeap<T>& other );
+  PairingMaxHeap<T>& operator = ( const PairingMaxHeap<T>& other );
+
+  /**
+   * Creates a node for the specified key and links it with the root.
+   *
+   * @param  key the key to be inserted.
+   * @return the handle of the inserted element.
+   */
+  Handle insertKey( T&& key );
+
+  /**
+   * Makes the root with the smaller key the first child of the other.
+   *
+   * @param  first root of a tree.
+   * @param  second root of another tree.
+   * @return the root of the linked tree.
+   */
+  static Node* link( Node* first, Node* second );
+
+  /**
+   * Cuts the subtree rooted at the specified node from its parent.
+   *
+   * @param node a node other than the root.
+   */
+  static void detach( Node* node );
+
+  /**
+   * Melds a list of sibling trees into one, linking them in pairs from left
+   * to right and then the pairs from right to left.
+   *
+   * @param  first the first tree of the list, or null.
+   * @return the root of the melded tree, or null if the list is empty.
+   */
+  Node* mergePairs( Node* first );
+
+  /**
+   * Destroys every node of the heap.
+   */
+  void destroyNodes();
+
+};
+
+template<typename T>
+PairingMaxHeap<T>::PairingMaxHeap() : root( 0 ), size( 0 ) {
+}
+
+template<typename T>
+PairingMaxHeap<T>::PairingMaxHeap( PairingMaxHeap<T>&& other ) : root( other.root ), size( other.size ) {
+  pool.swap( other.pool );
+  other.root = 0;
+  other.size = 0;
+}
+
+template<typename T>
+PairingMaxHeap<T>::~PairingMaxHeap() {
+  destroyNodes();
+}
+
+template<typename T>
+PairingMaxHeap<T>& PairingMaxHeap<T>::operator = ( PairingMaxHeap<T>&& other ) {
+  if ( this != &other ) {
+    clear();
+    root = other.root;
+    size = other.size;
+    pool.swap( other.pool );
+    other.root = 0;
+    other.size = 0;
+  }
+  return *this;
+}
+
+template<typename T>
+size_t PairingMaxHeap<T>::getSize() const {
+  return size;
+}
+
+template<typename T>
+bool PairingMaxHeap<T>::empty() const {
+  return size == 0;
+}
+
+template<typename T>
+const T& PairingMaxHeap<T>::get( Handle handle ) const {
+  return handle->key;
+}
+
+template<typename T>
+const T& PairingMaxHeap<T>::heapMaximum() const {
+  if ( empty() ) {
+    throw std::underflow_error( "PairingMaxHeap is empty!" );
+  }
+  return root->key;
+}
+
+template<typename T>
+typename PairingMaxHeap<T>::Handle PairingMaxHeap<T>::maximumHandle() const {
+  if ( empty() ) {
+    throw std::underflow_error( "PairingMaxHeap is empty!" );
+  }
+  return root;
+}
+
+template<typename T>
+T PairingMaxHeap<T>::heapExtractMax() {
+  if ( empty() ) {
+    throw std::underflow_error( "PairingMaxHeap is empty!" );
+  }
+  Node* node = root;
+  T result = std::move( node->key );
+  root = mergePairs( node->child );
+  pool.destroy( node );
+  size--;
+  return result;
+}
+
+template<typename T>
+typename PairingMaxHeap<T>::Handle PairingMaxHeap<T>::maxHeapInsert( const T& key ) {
+  T copy( key );
+  return insertKey( std::move( copy ) );
+}
+
+template<typename T>
+typename PairingMaxHeap<T>::Handle PairingMaxHeap<T>::maxHeapInsert( T&& key ) {
+  return insertKey( std::move( key ) );
+}
+
+template<typename T>
+T PairingMaxHeap<T>::erase( Handle handle ) {
+  if ( handle == root ) {
+    return heapExtractMax();
+  }
+  detach( handle );
+  T result = std::move( handle->key );
+  Node* subtree = mergePairs( handle->child );
+  if ( subtree != 0 ) {
+    root = link( root, subtree );
+  }
+  pool.destroy( handle );
+  size--;
+  return result;
+}
+
+template<typename T>
+void PairingMaxHeap<T>::increaseKey( Handle handle, T key ) {
+  if ( key < handle->key ) {
+    throw std::invalid_argument( "New key is smaller than current key!" );
+  }
+  handle->key = std::move( key );
+  if ( handle != root ) {
+    detach( handle );
+    root = link( root, handle );
+  }
+}
+
+template<typename T>
+void PairingMaxHeap<T>::meld( PairingMaxHeap<T>& other ) {
+  if ( this == &other || other.root == 0 ) {
+    pool.splice( other.pool );
+    return;
+  }
+  root = root == 0 ? other.root : link( root, other.root );
+  size += other.size;
+  pool.splice( other.pool );
+  other.root = 0;
+  other.size = 0;
+}
+
+template<typename T>
+void PairingMaxHeap<T>::clear() {
+  destroyNodes();
+  root = 0;
+  size = 0;
+}
+
+template<typename T>
+bool PairingMaxHeap<T>::isMaxHeap() const {
+  if ( root == 0 ) {
+    return size == 0;
+  }
+  if ( root->sibling != 0 || root->prev != 0 ) {
+    return false;
+  }
+  size_t count = 0;
+  std::vector<const Node*> stack( 1, root );
+  while ( !stack.empty() ) {
+    const Node* node = stack.back();
+    stack.pop_back();
+    count++;
+    const Node* prev = node;
+    for ( const Node* c = node->child; c != 0; c = c->sibling ) {
+      if ( node->key < c->key || c->prev != prev ) {
+        return false;
+      }
+      prev = c;
+      stack.push_back( c );
+    }
+  }
+  return count == size;
+}
+
+template<typename T>
+typename PairingMaxHeap<T>::Handle PairingMaxHeap<T>::insertKey( T&& key ) {
+  Node* node = pool.create( std::move( key ) );
+  root = root == 0 ? node : link( root, node );
+  size++;
+  return node;
+}
+
+template<typename T>
+typename PairingMaxHeap<T>::Node* PairingMaxHeap<T>::link( Node* first, Node* second ) {
+  if ( first->key < second->key ) {
+    std::swap( first, second );
+  }
+  second->sibling = first->child;
+  if ( first->child != 0 ) {
+    first->child->prev = second;
+  }
+  second->prev = first;
+  first->child = second;
+  return first;
+}
+
+template<typename T>
+void PairingMaxHeap<T>::detach( Node* node ) {
+  if ( node->prev->child == node ) {
+    node->prev->child = node->sibling;
+  } else {
+    node->prev->sibling = node->sibling;
+  }
+  if ( node->sibling != 0 ) {
+    node->sibling->prev = node->prev;
+  }
+  node->prev = 0;
+  node->sibling = 0;
+}
+
+template<typename T>
+typename PairingMaxHeap<T>::Node* PairingMaxHeap<T>::mergePairs( Node* first ) {
+  if ( first == 0 ) {
+    return 0;
+  }
+  while ( first != 0 ) {
+    Node* a = first;
+    Node* b = a->sibling;
+    first = b == 0 ? 0 : b->sibling;
+    a->sibling = 0;
+    a->prev = 0;
+    if ( b != 0 ) {
+      b->sibling = 0;
+      b->prev = 0;
+      a = link( a, b );
+    }
+    pairs.push_back( a );
+  }
+  Node* result = pairs.back();
+  for ( size_t i = pairs.size() - 1; i > 0; i-- ) {
+    result = link( pairs[ i - 1 ], result );
+  }
+  pairs.clear();
+  return result;
+}
+
+template<typename T>
+void PairingMaxHeap<T>::destroyNodes() {
+  if ( root == 0 ) {
+    return;
+  }
+  std::vector<Node*> stack( 1, root );
+  while ( !stack.empty() ) {
+    Node* node = stack.back();
+    stack.pop_back();
+    for ( Node* c = node->child; c != 0; c = c->sibling ) {
+      stack.push_back( c );
+    }
+    pool.destroy( node );
+  }
+}
+
+#endif
@@ -0,0 +1,361 @@
+#ifndef RADIXMAXHEAP_H
+#define RADIXMAXHEAP_H
+
+/*
+ * The MIT Licese (MIT)
+ *
+ * Copyright (C) 2016 by Brian Horn, trycatchhorn@gmail.com.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * A max-oriented radix heap of values with integer keys, for monotone
+ * workloads such as Dijkstra-style searches, where no key inserted is
+ * larger than the last key extracted.
+ *
+ * Every key is kept in a bucket chosen by the highest bit in which it
+ * differs from the last extracted key. Extraction takes from bucket zero,
+ * and when that bucket is empty redistributes the next non-empty bucket,
+ * whose keys then fall into strictly lower buckets. Each element moves at
+ * most once per bit of the key, so an operation takes O(log C) amortized
+ * for keys spanning a range of C, without comparing elements with each
+ * other.
+ *
+ * Key may be any signed or unsigned integer type of up to 64 bits, so both
+ * 32-bit and 64-bit keys are supported.
+ *
+ * NOTE: inserting a key larger than the last extracted key throws
+ * std::invalid_argument. Elements with equal keys are extracted in an
+ * unspecified order.
+ */
+template<typename Key, typename Value>
+class RadixMaxHeap {
+
+  static_assert( std::is_integral<Key>::value && sizeof( Key ) <= 8, "RadixMaxHeap requires an integer key of at most 64 bits" );
+
+ public:
+
+  /**
+   * An element of the max-heap, as returned when it is removed.
+   */
+  typedef std::pair<Key, Value> Element;
+
+  /**
+   * Creates an empty max-heap, accepting any key.
+   */
+  RadixMaxHeap();
+
+  /**
+   * Returns the size of the max-heap.
+   *
+   * @return the size of the max-heap.
+   */
+  size_t getSize() const;
+
+  /**
+   * Returns if the max-heap is empty.
+   *
+   * @return true if the max-heap is empty, otherwise false.
+   */
+  bool empty() const;
+
+  /**
+   * Returns the largest key that may still be inserted: the last maximum
+   * that was extracted or examined, or the largest value of Key before
+   * that.
+   *
+   * @return the largest key that may be inserted.
+   */
+  Key getLimit() const;
+
+  /**
+   * Returns the maximum key in the max-heap, which becomes the limit for
+   * later insertions.
+   *
+   * @return the maximum key in the max-heap.
+   */
+  Key heapMaximum();
+
+  /**
+   * Returns the value of the maximum key in the max-heap.
+   *
+   * @return the value of the maximum key in the max-heap.
+   */
+  const Value& maximumValue();
+
+  /**
+   * Removes and returns the maximum key and its value in O(log C)
+   * amortized. The key becomes the limit for later insertions.
+   *
+   * @return the maximum key and its value.
+   */
+  Element heapExtractMax();
+
+  /**
+   * Inserts the specified key and value into the max-heap in O(1).
+   *
+   * @param key the key, which must not be larger than getLimit().
+   * @param value the value ordered by the key.
+   */
+  void maxHeapInsert( Key key, const Value& value );
+
+  /**
+   * Inserts the specified key and value into the max-heap by moving the
+   * value, in O(1).
+   *
+   * @param key the key, which must not be larger than getLimit().
+   * @param value the value to be moved into the max-heap.
+   */
+  void maxHeapInsert( Key key, Value&& value );
+
+  /**
+   * Removes all elements from the max-heap and accepts any key again.
+   */
+  void clear();
+
+  /**
+   * Determines if every element is in the bucket of its key. Takes O(n).
+   *
+   * @return true if the heap is consistent, false otherwise.
+   */
+  bool isMaxHeap() const;
+
+ private:
+
+  typedef typename std::make_unsigned<Key>::type Bits;
+
+  static const size_t BITS = std::numeric_limits<Bits>::digits;
+
+  /**
+   * An element stored with its key mapped to bits, which are smaller for
+   * larger keys.
+   */
+  struct Entry {
+    Bits bits;
+    Value value;
+
+    Entry( Bits b, Value&& v ) : bits( b ), value( std::move( v ) ) {
+    }
+  };
+
+  std::vector<Entry> buckets[ BITS + 1 ];
+  Bits last;
+  size_t size;
+
+  /**
+   * Maps a key to bits whose unsigned order is the reverse of the order of
+   * the keys, turning the max-heap into a min-heap on bits.
+   *
+   * @param  key the key to be mapped.
+   * @return the bits of the key.
+   */
+  static Bits toBits( Key key );
+
+  /**
+   * Maps bits back to their key.
+   *
+   * @param  bits the bits of a key.
+   * @return the key.
+   */
+  static Key fromBits( Bits bits );
+
+  /**
+   * Returns the bucket for the specified bits: zero if they equal the last
+   * extracted bits, otherwise one more than the highest differing bit.
+   *
+   * @param  bits the bits of a key.
+   * @return the index of the bucket.
+   */
+  size_t bucketOf( Bits bits ) const;
+
+  /**
+   * Stores the specified bits and value after checking the limit.
+   *
+   * @param bits the bits of the key.
+   * @param value the value to be stored.
+   */
+  void insertEntry( Bits bits, Value&& value );
+
+  /**
+   * Makes bucket zero non-empty by redistributing the first non-empty
+   * bucket around its smallest bits, and throws std::underflow_error if
+   * the max-heap is empty.
+   */
+  void refill();
+
+};
+
+template<typename Key, typename Value>
+const size_t RadixMaxHeap<Key, Value>::BITS;
+
+template<typename Key, typename Value>
+RadixMaxHeap<Key, Value>::RadixMaxHeap() : last( 0 ), size( 0 ) {
+}
+
+template<typename Key, typename Value>
+size_t RadixMaxHeap<Key, Value>::getSize() const {
+  return size;
+}
+
+template<typename Key, typename Value>
+bool RadixMaxHeap<Key, Value>::empty() const {
+  return size == 0;
+}
+
+template<typename Key, typename Value>
+Key RadixMaxHeap<Key, Value>::getLimit() const {
+  return fromBits( last );
+}
+
+template<typename Key, typename Value>
+Key RadixMaxHeap<Key, Value>::heapMaximum() {
+  refill();
+  return fromBits( buckets[ 0 ].back().bits );
+}
+
+template<typename Key, typename Value>
+const Value& RadixMaxHeap<Key, Value>::maximumValue() {
+  refill();
+  return buckets[ 0 ].back().value;
+}
+
+template<typename Key, typename Value>
+typename RadixMaxHeap<Key, Value>::Element RadixMaxHeap<Key, Value>::heapExtractMax() {
+  refill();
+  Element result( fromBits( buckets[ 0 ].back().bits ), std::move( buckets[ 0 ].back().value ) );
+  buckets[ 0 ].pop_back();
+  size--;
+  return result;
+}
+
+template<typename Key, typename Value>
+void RadixMaxHeap<Key, Value>::maxHeapInsert( Key key, const Value& value ) {
+  Value copy( value );
+  insertEntry( toBits( key ), std::move( copy ) );
+}
+
+template<typename Key, typename Value>
+void RadixMaxHeap<Key, Value>::maxHeapInsert( Key key, Value&& value ) {
+  insertEntry( toBits( key ), std::move( value ) );
+}
+
+template<typename Key, typename Value>
+void RadixMaxHeap<Key, Value>::clear() {
+  for ( size_t i = 0; i <= BITS; i++ ) {
+    buckets[ i ].clear();
+  }
+  last = 0;
+  size = 0;
+}
+
+template<typename Key, typename Value>
+bool RadixMaxHeap<Key, Value>::isMaxHeap() const {
+  size_t count = 0;
+  for ( size_t i = 0; i <= BITS; i++ ) {
+    for ( size_t j = 0; j < buckets[ i ].size(); j++ ) {
+      if ( buckets[ i ][ j ].bits < last || bucketOf( buckets[ i ][ j ].bits ) != i ) {
+        return false;
+      }
+    }
+    count += buckets[ i ].size();
+  }
+  return count == size;
+}
+
+template<typename Key, typename Value>
+typename RadixMaxHeap<Key, Value>::Bits RadixMaxHeap<Key, Value>::toBits( Key key ) {
+  Bits bits = static_cast<Bits>( key );
+  if ( std::is_signed<Key>::value ) {
+    bits ^= static_cast<Bits>( Bits( 1 ) << ( BITS - 1 ) );
+  }
+  return static_cast<Bits>( ~bits );
+}
+
+template<typename Key, typename Value>
+Key RadixMaxHeap<Key, Value>::fromBits( Bits bits ) {
+  bits = static_cast<Bits>( ~bits );
+  if ( std::is_signed<Key>::value ) {
+    bits ^= static_cast<Bits>( Bits( 1 ) << ( BITS - 1 ) );
+  }
+  return static_cast<Key>( bits );
+}
+
+template<typename Key, typename Value>
+size_t RadixMaxHeap<Key, Value>::bucketOf( Bits bits ) const {
+  uint64_t difference = static_cast<uint64_t>( bits ^ last );
+  if ( difference == 0 ) {
+    return 0;
+  }
+#if defined( __GNUC__ )
+  return 64 - __builtin_clzll( difference );
+#else
+  size_t length = 0;
+  while ( difference != 0 ) {
+    difference >>= 1;
+    length++;
+  }
+  return length;
+#endif
+}
+
+template<typename Key, typename Value>
+void RadixMaxHeap<Key, Value>::insertEntry( Bits bits, Value&& value ) {
+  if ( bits < last ) {
+    throw std::invalid_argument( "Key is larger than the last extracted key!" );
+  }
+  buckets[ bucketOf( bits ) ].push_back( Entry( bits, std::move( value ) ) );
+  size++;
+}
+
+template<typename Key, typename Value>
+void RadixMaxHeap<Key, Value>::refill() {
+  if ( size == 0 ) {
+    throw std::underflow_error( "RadixMaxHeap is empty!" );
+  }
+  if ( !buckets[ 0 ].empty() ) {
+    return;
+  }
+  size_t i = 1;
+  while ( buckets[ i ].empty() ) {
+    i++;
+  }
+  std::vector<Entry>& bucket = buckets[ i ];
+  Bits smallest = bucket[ 0 ].bits;
+  for ( size_t j = 1; j < bucket.size(); j++ ) {
+    if ( bucket[ j ].bits < smallest ) {
+      smallest = bucket[ j ].bits;
+    }
+  }
+  last = smallest;
+  for ( size_t j = 0; j < bucket.size(); j++ ) {
+    buckets[ bucketOf( bucket[ j ].bits ) ].push_back( std::move( bucket[ j ] ) );
+  }
+  bucket.clear();
+}
+
+#endif
@@ -0,0 +1,239 @@
+#ifndef TOPKSELECTOR_H
+#define TOPKSELECTOR_H
+
+/*
+ * The MIT Licese (MIT)
+ *
+ * Copyright (C) 2016 by Brian Horn, trycatchhorn@gmail.com.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+*/
+
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "MaxHeap.h"
+
+/**
+ * Keeps the K largest elements seen in a stream, in O(K) memory.
+ *
+ * The kept elements are stored in a MaxHeap of fixed capacity K, ordered so
+ * that its root is the smallest kept element: the threshold an offered
+ * element must beat. Once the selector is full, an element not above the
+ * threshold is rejected after a single comparison, and an element above it
+ * replaces the threshold with one sift-down, in O(log K).
+ *
+ * Selectors filled independently, e.g. one per thread, are combined with
+ * merge() into the top K of their union.
+ */
+template<typename T, size_t Arity = 2>
+class TopKSelector {
+
+ public:
+
+  /**
+   * Creates an empty selector keeping at most the specified number of
+   * elements. Storage for all of them is reserved up front.
+   *
+   * @param  capacity the number K of largest elements to keep.
+   */
+  explicit TopKSelector( size_t capacity );
+
+  /**
+   * Returns the maximum number of elements kept by the selector.
+   *
+   * @return the capacity K of the selector.
+   */
+  size_t getCapacity() const;
+
+  /**
+   * Returns the number of elements currently kept by the selector.
+   *
+   * @return the size of the selector.
+   */
+  size_t getSize();
+
+  /**
+   * Returns if the selector keeps no elements.
+   *
+   * @return true if the selector is empty, otherwise false.
+   */
+  bool empty() const;
+
+  /**
+   * Returns if the selector keeps as many elements as its capacity.
+   *
+   * @return true if the selector is full, otherwise false.
+   */
+  bool full();
+
+  /**
+   * Returns the smallest element kept by the selector. Once the selector is
+   * full, only elements larger than this one are accepted.
+   *
+   * NOTE: std::underflow_error is thrown if the selector is empty.
+   *
+   * @return the smallest element kept by the selector.
+   */
+  const T& threshold();
+
+  /**
+   * Offers the specified element to the selector. The element is kept if
+   * the selector is not full, or if it is larger than the threshold, in
+   * which case it replaces the threshold.
+   *
+   * @param  key the element offered.
+   * @return true if the element is kept, otherwise false.
+   */
+  bool offer( const T& key );
+
+  /**
+   * Offers the specified element to the selector, moving it in if kept.
+   *
+   * @param  key the element offered.
+   * @return true if the element is kept, otherwise false.
+   */
+  bool offer( T&& key );
+
+  /**
+   * Offers every element kept by the specified selector to this selector,
+   * leaving this selector with the K largest elements of both. The other
+   * selector is consumed; pass it with std::move() to avoid a copy.
+   *
+   * The elements are offered largest first, so the merge stops at the
+   * first rejected element.
+   *
+   * @param  other the selector whose elements are merged.
+   */
+  void merge( TopKSelector other );
+
+  /**
+   * Returns the kept elements sorted in descending order, and empties the
+   * selector.
+   *
+   * @return vector<T> the kept elements, largest first.
+   */
+  std::vector<T> extractSorted();
+
+ private:
+
+  /**
+   * A kept element, ordered in reverse so that the MaxHeap holding the
+   * entries has the smallest kept element at its root.
+   */
+  struct Entry {
+    T key;
+
+    explicit Entry( T&& k ) : key( std::move( k ) ) {
+    }
+
+    bool operator<( const Entry& other ) const {
+      return other.key < key;
+    }
+  };
+
+  MaxHeap<Entry, Arity> heap;
+  size_t capacity;
+
+};
+
+template<typename T, size_t Arity>
+TopKSelector<T, Arity>::TopKSelector( size_t capacity ) : capacity( capacity ) {
+  heap.reserve( capacity );
+}
+
+template<typename T, size_t Arity>
+size_t TopKSelector<T, Arity>::getCapacity() const {
+  return capacity;
+}
+
+template<typename T, size_t Arity>
+size_t TopKSelector<T, Arity>::getSize() {
+  return heap.getSize();
+}
+
+template<typename T, size_t Arity>
+bool TopKSelector<T, Arity>::empty() const {
+  return heap.empty();
+}
+
+template<typename T, size_t Arity>
+bool TopKSelector<T, Arity>::full() {
+  return heap.getSize() == capacity;
+}
+
+template<typename T, size_t Arity>
+const T& TopKSelector<T, Arity>::threshold() {
+  if ( empty() ) {
+    throw std::underflow_error( "TopKSelector is empty!" );
+  }
+  return heap.heapMaximum().key;
+}
+
+template<typename T, size_t Arity>
+bool TopKSelector<T, Arity>::offer( const T& key ) {
+  if ( !full() ) {
+    heap.maxHeapInsert( Entry( T( key ) ) );
+    return true;
+  }
+  if ( capacity == 0 || !( heap.heapMaximum().key < key ) ) {
+    return false;
+  }
+  heap.heapReplaceMax( Entry( T( key ) ) );
+  return true;
+}
+
+template<typename T, size_t Arity>
+bool TopKSelector<T, Arity>::offer( T&& key ) {
+  if ( !full() ) {
+    heap.maxHeapInsert( Entry( std::move( key ) ) );
+    return true;
+  }
+  if ( capacity == 0 || !( heap.heapMaximum().key < key ) ) {
+    return false;
+  }
+  heap.heapReplaceMax( Entry( std::move( key ) ) );
+  return true;
+}
+
+template<typename T, size_t Arity>
+void TopKSelector<T, Arity>::merge( TopKSelector other ) {
+  std::vector<Entry> entries = other.heap.sortInPlace();
+  for ( size_t i = entries.size(); i > 0; --i ) {
+    if ( !offer( std::move( entries[ i - 1 ].key ) ) ) {
+      break;
+    }
+  }
+}
+
+template<typename T, size_t Arity>
+std::vector<T> TopKSelector<T, Arity>::extractSorted() {
+  std::vector<Entry> entries = heap.sortInPlace();
+  std::vector<T> result;
+  result.reserve( entries.size() );
+  for ( size_t i = entries.size(); i > 0; --i ) {
+    result.push_back( std::move( entries[ i - 1 ].key ) );
+  }
+  heap.reserve( capacity );
+  return result;
+}
+
+#endif
@@ -0,0 +1,290 @@
+#ifndef WORKSTEALINGSCHEDULER_H
+#define WORKSTEALINGSCHEDULER_H
+
+/*
+ * The MIT Licese (MIT)
+ *
+ * Copyright (C) 2016 by Brian Horn, trycatchhorn@gmail.com.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "MaxHeap.h"
+
+/**
+ * Per-worker max-heaps of tasks, where a worker that runs out of tasks
+ * steals a batch of the highest-priority tasks from the most backlogged
+ * worker.
+ *
+ * Every worker owns a MaxHeap guarded by its own mutex. The owner pushes
+ * and pops on its own heap, so the mutex is uncontended on the fast path
+ * and is only ever contended by a thief. An idle worker picks the victim
+ * with the most tasks, from a size hint read without locking, and moves
+ * the larger half of the victim's tasks, up to the steal batch, into its
+ * own heap with MaxHeap::extractBatch() and MaxHeap::insertRange(). If the
+ * hint was stale and the victim has run dry, the other workers are tried
+ * in turn from a random one, so a steal only fails when every other heap
+ * is empty.
+ *
+ * NOTE: worker indices are in [0, getWorkerCount()), and each index must
+ * be used by one thread at a time.
+ */
+template<typename T, size_t Arity = 2>
+class WorkStealingScheduler {
+
+ public:
+
+  /**
+   * Creates a scheduler with the specified number of empty worker heaps.
+   *
+   * @param  workers the number of workers.
+   * @param  steal_batch the maximum number of tasks moved by one steal,
+   *         where zero disables stealing.
+   */
+  explicit WorkStealingScheduler( size_t workers, size_t steal_batch = 64 );
+
+  WorkStealingScheduler( const WorkStealingScheduler& ) = delete;
+
+  WorkStealingScheduler& operator=( const WorkStealingScheduler& ) = delete;
+
+  /**
+   * Returns the number of workers of the scheduler.
+   *
+   * @return the number of workers.
+   */
+  size_t getWorkerCount() const;
+
+  /**
+   * Returns the number of tasks queued for the specified worker.
+   *
+   * @param  worker index of the worker.
+   * @return the number of tasks in the heap of the worker.
+   */
+  size_t getSize( size_t worker ) const;
+
+  /**
+   * Returns the number of tasks queued for all workers.
+   *
+   * @return the total number of tasks.
+   */
+  size_t getSize() const;
+
+  /**
+   * Queues the specified task on the heap of the specified worker.
+   *
+   * @param  worker index of the worker.
+   * @param  task the task to be queued.
+   */
+  void push( size_t worker, const T& task );
+
+  /**
+   * Moves the specified task onto the heap of the specified worker.
+   *
+   * @param  worker index of the worker.
+   * @param  task the task to be queued.
+   */
+  void push( size_t worker, T&& task );
+
+  /**
+   * Removes the highest-priority task of the specified worker. If its heap
+   * is empty, the worker first steals a batch from the most backlogged
+   * worker.
+   *
+   * @param  worker index of the worker.
+   * @param  result receives the removed task.
+   * @return true if a task was removed, false if no task could be found.
+   */
+  bool tryPop( size_t worker, T& result );
+
+  /**
+   * Moves a batch of the highest-priority tasks of the most backlogged
+   * other worker onto the heap of the specified worker. If that worker
+   * has no tasks left, the first other worker with tasks is robbed,
+   * starting from a random one.
+   *
+   * @param  worker index of the stealing worker.
+   * @return the number of tasks stolen.
+   */
+  size_t steal( size_t worker );
+
+ private:
+
+  /**
+   * The heap of one worker, its mutex, and a size hint that thieves read
+   * without locking.
+   */
+  struct Worker {
+    std::mutex mutex;
+    MaxHeap<T, Arity> heap;
+    std::atomic<size_t> size;
+
+    Worker() : size( 0 ) {
+    }
+  };
+
+  std::vector<Worker> workers;
+  size_t steal_batch;
+
+  /**
+   * Moves a batch of the highest-priority tasks of the specified victim
+   * onto the heap of the specified worker.
+   *
+   * @param  worker index of the stealing worker.
+   * @param  victim index of the worker to steal from.
+   * @return the number of tasks stolen.
+   */
+  size_t stealFrom( size_t worker, size_t victim );
+
+  /**
+   * Returns the index of a random worker, drawn from a generator owned by
+   * the calling thread.
+   *
+   * @return the index of a worker.
+   */
+  size_t randomWorker() const;
+
+};
+
+template<typename T, size_t Arity>
+WorkStealingScheduler<T, Arity>::WorkStealingScheduler( size_t workers, size_t steal_batch ) : workers( workers ), steal_batch( steal_batch ) {
+}
+
+template<typename T, size_t Arity>
+size_t WorkStealingScheduler<T, Arity>::getWorkerCount() const {
+  return workers.size();
+}
+
+template<typename T, size_t Arity>
+size_t WorkStealingScheduler<T, Arity>::getSize( size_t worker ) const {
+  return workers[ worker ].size.load();
+}
+
+template<typename T, size_t Arity>
+size_t WorkStealingScheduler<T, Arity>::getSize() const {
+  size_t total = 0;
+  for ( size_t i = 0; i < workers.size(); i++ ) {
+    total += workers[ i ].size.load();
+  }
+  return total;
+}
+
+template<typename T, size_t Arity>
+void WorkStealingScheduler<T, Arity>::push( size_t worker, const T& task ) {
+  push( worker, T( task ) );
+}
+
+template<typename T, size_t Arity>
+void WorkStealingScheduler<T, Arity>::push( size_t worker, T&& task ) {
+  Worker& owner = workers[ worker ];
+  std::lock_guard<std::mutex> lock( owner.mutex );
+  owner.heap.maxHeapInsert( std::move( task ) );
+  owner.size.store( owner.heap.getSize() );
+}
+
+template<typename T, size_t Arity>
+bool WorkStealingScheduler<T, Arity>::tryPop( size_t worker, T& result ) {
+  Worker& owner = workers[ worker ];
+  do {
+    std::lock_guard<std::mutex> lock( owner.mutex );
+    if ( !owner.heap.empty() ) {
+      result = owner.heap.heapExtractMax();
+      owner.size.store( owner.heap.getSize() );
+      return true;
+    }
+  } while ( steal( worker ) > 0 );
+  return false;
+}
+
+template<typename T, size_t Arity>
+size_t WorkStealingScheduler<T, Arity>::steal( size_t worker ) {
+  if ( steal_batch == 0 || workers.size() < 2 ) {
+    return 0;
+  }
+  size_t victim = worker;
+  size_t victim_size = 0;
+  for ( size_t i = 1; i < workers.size(); i++ ) {
+    size_t candidate = ( worker + i ) % workers.size();
+    size_t candidate_size = workers[ candidate ].size.load();
+    if ( candidate_size > victim_size ) {
+      victim = candidate;
+      victim_size = candidate_size;
+    }
+  }
+  if ( victim != worker ) {
+    size_t stolen = stealFrom( worker, victim );
+    if ( stolen > 0 ) {
+      return stolen;
+    }
+  }
+  // The hints may lag behind the heaps, so look at every other worker
+  // before giving up.
+  size_t start = randomWorker();
+  for ( size_t i = 0; i < workers.size(); i++ ) {
+    size_t candidate = ( start + i ) % workers.size();
+    if ( candidate == worker || candidate == victim ) {
+      continue;
+    }
+    size_t stolen = stealFrom( worker, candidate );
+    if ( stolen > 0 ) {
+      return stolen;
+    }
+  }
+  return 0;
+}
+
+template<typename T, size_t Arity>
+size_t WorkStealingScheduler<T, Arity>::stealFrom( size_t worker, size_t victim ) {
+  std::vector<T> batch;
+  {
+    Worker& target = workers[ victim ];
+    std::lock_guard<std::mutex> lock( target.mutex );
+    size_t half = ( target.heap.getSize() + 1 ) / 2;
+    batch = target.heap.extractBatch( std::min( half, steal_batch ) );
+    target.size.store( target.heap.getSize() );
+  }
+  if ( !batch.empty() ) {
+    Worker& owner = workers[ worker ];
+    std::lock_guard<std::mutex> lock( owner.mutex );
+    owner.heap.insertRange( std::make_move_iterator( batch.begin() ), std::make_move_iterator( batch.end() ) );
+    owner.size.store( owner.heap.getSize() );
+  }
+  return batch.size();
+}
+
+template<typename T, size_t Arity>
+size_t WorkStealingScheduler<T, Arity>::randomWorker() const {
+  static thread_local uint64_t state = std::hash<std::thread::id>()( std::this_thread::get_id() ) | 1;
+  state ^= state >> 12;
+  state ^= state << 25;
+  state ^= state >> 27;
+  return static_cast<size_t>( ( state * 0x2545F4914F6CDD1DULL ) >> 32 ) % workers.size();
+}
+
+#endif
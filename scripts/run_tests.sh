@@ -13,3 +13,83 @@ fi
 if [ -f "../test/build/release/maxheap_test" ]; then
      ./../test/build/release/maxheap_test
 fi
+
+if [ -f "../test/build/debug/addressable_maxheap_testd" ]; then
+     ./../test/build/debug/addressable_maxheap_testd
+fi
+
+if [ -f "../test/build/release/addressable_maxheap_test" ]; then
+     ./../test/build/release/addressable_maxheap_test
+fi
+
+if [ -f "../test/build/debug/topk_selector_testd" ]; then
+     ./../test/build/debug/topk_selector_testd
+fi
+
+if [ -f "../test/build/release/topk_selector_test" ]; then
+     ./../test/build/release/topk_selector_test
+fi
+
+if [ -f "../test/build/debug/concurrent_maxheap_testd" ]; then
+     ./../test/build/debug/concurrent_maxheap_testd
+fi
+
+if [ -f "../test/build/release/concurrent_maxheap_test" ]; then
+     ./../test/build/release/concurrent_maxheap_test
+fi
+
+if [ -f "../test/build/debug/multiqueue_testd" ]; then
+     ./../test/build/debug/multiqueue_testd
+fi
+
+if [ -f "../test/build/release/multiqueue_test" ]; then
+     ./../test/build/release/multiqueue_test
+fi
+
+if [ -f "../test/build/debug/work_stealing_scheduler_testd" ]; then
+     ./../test/build/debug/work_stealing_scheduler_testd
+fi
+
+if [ -f "../test/build/release/work_stealing_scheduler_test" ]; then
+     ./../test/build/release/work_stealing_scheduler_test
+fi
+
+if [ -f "../test/build/debug/keyed_maxheap_testd" ]; then
+     ./../test/build/debug/keyed_maxheap_testd
+fi
+
+if [ -f "../test/build/release/keyed_maxheap_test" ]; then
+     ./../test/build/release/keyed_maxheap_test
+fi
+
+if [ -f "../test/build/debug/pairing_maxheap_testd" ]; then
+     ./../test/build/debug/pairing_maxheap_testd
+fi
+
+if [ -f "../test/build/release/pairing_maxheap_test" ]; then
+     ./../test/build/release/pairing_maxheap_test
+fi
+
+if [ -f "../test/build/debug/radix_maxheap_testd" ]; then
+     ./../test/build/debug/radix_maxheap_testd
+fi
+
+if [ -f "../test/build/release/radix_maxheap_test" ]; then
+     ./../test/build/release/radix_maxheap_test
+fi
+
+if [ -f "../test/build/debug/external_maxheap_testd" ]; then
+     ./../test/build/debug/external_maxheap_testd
+fi
+
+if [ -f "../test/build/release/external_maxheap_test" ]; then
+     ./../test/build/release/external_maxheap_test
+fi
+
+if [ -f "../test/build/debug/mapped_maxheap_testd" ]; then
+     ./../test/build/debug/mapped_maxheap_testd
+fi
+
+if [ -f "../test/build/release/mapped_maxheap_test" ]; then
+     ./../test/build/release/mapped_maxheap_test
+fi
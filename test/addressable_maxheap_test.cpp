@@ -0,0 +1,253 @@
+#include "AddressableMaxHeap.h"
+#include "MaxHeapSimd.h"
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+bool test_addressable_max_heap_insert_extract() {
+  bool result = false;
+  int array_h[10] = { 4, 1, 3, 2, 16, 9, 10, 14, 8, 7 };
+  AddressableMaxHeap<int> h;
+  for ( int i = 0; i < 10; i++ ) {
+    h.maxHeapInsert( array_h[ i ] );
+  }
+  int array_ref[10] = { 16, 14, 10, 9, 8, 7, 4, 3, 2, 1 };
+  bool t1 = h.getSize() == 10 && h.isMaxHeap();
+  bool t2 = true;
+  for ( int i = 0; i < 10; i++ ) {
+    t2 = t2 && h.heapMaximum() == array_ref[ i ] && h.heapExtractMax() == array_ref[ i ] && h.isMaxHeap();
+  }
+  bool t = t1 && t2 && h.empty();
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "h.heapExtractMax() ordered = " << t2 << "\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_addressable_max_heap_handles_follow_elements() {
+  bool result = false;
+  int array_h[10] = { 4, 1, 3, 2, 16, 9, 10, 14, 8, 7 };
+  AddressableMaxHeap<int, 4> h;
+  std::vector<AddressableMaxHeap<int, 4>::Handle> handles;
+  for ( int i = 0; i < 10; i++ ) {
+    handles.push_back( h.maxHeapInsert( array_h[ i ] ) );
+  }
+  h.heapExtractMax();
+  bool t1 = !h.contains( handles[ 4 ] );
+  bool t2 = true;
+  for ( int i = 0; i < 10; i++ ) {
+    if ( i != 4 ) {
+      t2 = t2 && h.contains( handles[ i ] ) && h.get( handles[ i ] ) == array_h[ i ];
+    }
+  }
+  bool t3 = h.maximumHandle() == handles[ 7 ];
+  bool t = t1 && t2 && t3;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "h.get(handle) = " << t2 << "\t\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_addressable_max_heap_erase_duplicates() {
+  bool result = false;
+  AddressableMaxHeap<int> h;
+  AddressableMaxHeap<int>::Handle first = h.maxHeapInsert( 5 );
+  h.maxHeapInsert( 7 );
+  AddressableMaxHeap<int>::Handle second = h.maxHeapInsert( 5 );
+  h.maxHeapInsert( 1 );
+  int removed = h.erase( first );
+  bool t1 = removed == 5 && h.getSize() == 3 && h.isMaxHeap();
+  bool t2 = !h.contains( first ) && h.contains( second ) && h.get( second ) == 5;
+  bool thrown = false;
+  try {
+    h.erase( first );
+  }
+  catch ( const std::invalid_argument& ) {
+    thrown = true;
+  }
+  bool t = t1 && t2 && thrown;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "h.erase(handle) = " << removed << "\t\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_addressable_max_heap_increase_decrease_key() {
+  bool result = false;
+  int array_h[10] = { 4, 1, 3, 2, 16, 9, 10, 14, 8, 7 };
+  AddressableMaxHeap<int> h;
+  std::vector<AddressableMaxHeap<int>::Handle> handles;
+  for ( int i = 0; i < 10; i++ ) {
+    handles.push_back( h.maxHeapInsert( array_h[ i ] ) );
+  }
+  h.increaseKey( handles[ 1 ], 20 );
+  bool t1 = h.maximumHandle() == handles[ 1 ] && h.isMaxHeap();
+  h.decreaseKey( handles[ 1 ], 0 );
+  bool t2 = h.maximumHandle() == handles[ 4 ] && h.get( handles[ 1 ] ) == 0 && h.isMaxHeap();
+  h.updateKey( handles[ 0 ], 17 );
+  bool t3 = h.maximumHandle() == handles[ 0 ] && h.isMaxHeap();
+  h.updateKey( handles[ 0 ], -1 );
+  bool t4 = h.maximumHandle() == handles[ 4 ] && h.isMaxHeap();
+  bool thrown = false;
+  try {
+    h.increaseKey( handles[ 2 ], 2 );
+  }
+  catch ( const std::invalid_argument& ) {
+    thrown = true;
+  }
+  bool t = t1 && t2 && t3 && t4 && thrown;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "h.increaseKey/decreaseKey = " << t << "\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_addressable_max_heap_handle_reuse() {
+  bool result = false;
+  AddressableMaxHeap<std::string> h;
+  AddressableMaxHeap<std::string>::Handle a = h.maxHeapInsert( std::string( "alpha" ) );
+  h.maxHeapInsert( std::string( "beta" ) );
+  h.erase( a );
+  AddressableMaxHeap<std::string>::Handle c = h.maxHeapInsert( std::string( "gamma" ) );
+  bool t1 = c != a && !h.contains( a ) && h.get( c ) == "gamma";
+  bool t2 = h.heapExtractMax() == "gamma" && h.heapExtractMax() == "beta" && h.empty();
+  bool t = t1 && t2;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "h.maxHeapInsert after erase = " << t1 << "\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_addressable_max_heap_stale_handle() {
+  bool result = false;
+  AddressableMaxHeap<int> h;
+  std::vector<AddressableMaxHeap<int>::Handle> handles;
+  for ( int i = 0; i < 8; i++ ) {
+    handles.push_back( h.maxHeapInsert( i ) );
+  }
+  h.erase( handles[ 3 ] );
+  // The next insertion takes over the slot of the erased element.
+  AddressableMaxHeap<int>::Handle reused = h.maxHeapInsert( 42 );
+  size_t rejected = 0;
+  try {
+    h.erase( handles[ 3 ] );
+  }
+  catch ( const std::invalid_argument& ) {
+    rejected++;
+  }
+  try {
+    h.increaseKey( handles[ 3 ], 100 );
+  }
+  catch ( const std::invalid_argument& ) {
+    rejected++;
+  }
+  bool t1 = rejected == 2 && h.contains( reused ) && h.get( reused ) == 42 && h.getSize() == 8;
+  h.erase( reused );
+  AddressableMaxHeap<int>::Handle again = h.maxHeapInsert( 43 );
+  bool t2 = !h.contains( reused ) && !h.contains( handles[ 3 ] ) && h.get( again ) == 43 && h.isMaxHeap();
+  bool t = t1 && t2;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "stale handles rejected = " << rejected << "\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+// Inserts pseudo-random keys, changes and erases some through their handles,
+// and checks that the rest come out sorted.
+template<typename Heap>
+bool checkAddressableOrder() {
+  Heap h;
+  std::vector<typename Heap::Handle> handles;
+  for ( int i = 0; i < 3000; i++ ) {
+    handles.push_back( h.maxHeapInsert( ( i * 7919 ) % 1009 ) );
+  }
+  std::vector<int> reference;
+  bool consistent = h.isMaxHeap();
+  for ( size_t i = 0; consistent && i < handles.size(); i++ ) {
+    if ( i % 3 == 0 ) {
+      h.erase( handles[ i ] );
+    } else {
+      int key = static_cast<int>( ( i * 104729 ) % 2003 );
+      h.updateKey( handles[ i ], key );
+      reference.push_back( key );
+    }
+    consistent = h.isMaxHeap();
+  }
+  std::sort( reference.rbegin(), reference.rend() );
+  for ( size_t i = 0; consistent && i < reference.size(); i++ ) {
+    consistent = h.heapExtractMax() == reference[ i ];
+  }
+  return consistent && h.empty();
+}
+
+bool test_addressable_max_heap_layouts() {
+  bool result = false;
+  bool t1 = checkAddressableOrder<AddressableMaxHeap<int, 16> >();
+  bool t2 = checkAddressableOrder<AddressableMaxHeap<int, 4, BHeapLayout<256> > >();
+  bool t = t1 && t2;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "arity 16, BHeapLayout = " << t1 << ", " << t2 << "\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+int main( int argc, const char * argv[] ) {
+  if ( test_addressable_max_heap_insert_extract() ) {
+    std::cout << "test_addressable_max_heap_insert_extract -> OK" << std::endl;
+  } else {
+    std::cout << "test_addressable_max_heap_insert_extract -> FAIL" << std::endl;
+  }
+  if ( test_addressable_max_heap_handles_follow_elements() ) {
+    std::cout << "test_addressable_max_heap_handles_follow_elements -> OK" << std::endl;
+  } else {
+    std::cout << "test_addressable_max_heap_handles_follow_elements -> FAIL" << std::endl;
+  }
+  if ( test_addressable_max_heap_erase_duplicates() ) {
+    std::cout << "test_addressable_max_heap_erase_duplicates -> OK" << std::endl;
+  } else {
+    std::cout << "test_addressable_max_heap_erase_duplicates -> FAIL" << std::endl;
+  }
+  if ( test_addressable_max_heap_increase_decrease_key() ) {
+    std::cout << "test_addressable_max_heap_increase_decrease_key -> OK" << std::endl;
+  } else {
+    std::cout << "test_addressable_max_heap_increase_decrease_key -> FAIL" << std::endl;
+  }
+  if ( test_addressable_max_heap_handle_reuse() ) {
+    std::cout << "test_addressable_max_heap_handle_reuse -> OK" << std::endl;
+  } else {
+    std::cout << "test_addressable_max_heap_handle_reuse -> FAIL" << std::endl;
+  }
+  if ( test_addressable_max_heap_stale_handle() ) {
+    std::cout << "test_addressable_max_heap_stale_handle -> OK" << std::endl;
+  } else {
+    std::cout << "test_addressable_max_heap_stale_handle -> FAIL" << std::endl;
+  }
+  if ( test_addressable_max_heap_layouts() ) {
+    std::cout << "test_addressable_max_heap_layouts -> OK" << std::endl;
+  } else {
+    std::cout << "test_addressable_max_heap_layouts -> FAIL" << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,166 @@
+#include "ConcurrentMaxHeap.h"
+#include <algorithm>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+bool test_concurrent_max_heap_push_pop() {
+  bool result = false;
+  int array_h[10] = { 4, 1, 3, 2, 16, 9, 10, 14, 8, 7 };
+  int array_ref[10] = { 16, 14, 10, 9, 8, 7, 4, 3, 2, 1 };
+  ConcurrentMaxHeap<int> h;
+  for ( int i = 0; i < 10; i++ ) {
+    h.push( array_h[ i ] );
+  }
+  bool t1 = h.getSize() == 10;
+  bool t2 = true;
+  for ( int i = 0; i < 10; i++ ) {
+    int value = 0;
+    t2 = t2 && h.tryPop( value ) && value == array_ref[ i ];
+  }
+  int value = 0;
+  bool t3 = !h.tryPop( value ) && h.empty();
+  bool t = t1 && t2 && t3;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "h.tryPop() ordered = " << t2 << "\t\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_concurrent_max_heap_batches() {
+  bool result = false;
+  int array_h[10] = { 4, 1, 3, 2, 16, 9, 10, 14, 8, 7 };
+  ConcurrentMaxHeap<int, 4> h;
+  h.pushBatch( array_h, array_h + 10 );
+  std::vector<int> first = h.popBatch( 4 );
+  std::vector<int> rest = h.popBatch( 100 );
+  bool t1 = first.size() == 4 && first[ 0 ] == 16 && first[ 3 ] == 9;
+  bool t2 = rest.size() == 6 && rest[ 0 ] == 8 && rest[ 5 ] == 1 && h.empty();
+  bool t3 = h.popBatch( 0 ).empty();
+  bool t = t1 && t2 && t3;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "h.popBatch() = " << t << "\t\t\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_concurrent_max_heap_close_releases_consumers() {
+  bool result = false;
+  ConcurrentMaxHeap<int> h;
+  bool popped = true;
+  std::vector<int> batch( 1, 0 );
+  std::thread waiter( [&]() { int value; popped = h.pop( value ); } );
+  std::thread batch_waiter( [&]() { batch = h.popBatch( 8 ); } );
+  h.close();
+  waiter.join();
+  batch_waiter.join();
+  int value = 0;
+  h.push( 3 );
+  bool t1 = !popped && batch.empty() && h.isClosed();
+  bool t2 = h.pop( value ) && value == 3 && !h.pop( value );
+  bool t = t1 && t2;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "h.close() = " << t << "\t\t\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_concurrent_max_heap_producers_consumers() {
+  bool result = false;
+  const int producers = 4;
+  const int consumers = 4;
+  const int per_producer = 10000;
+  ConcurrentMaxHeap<int> h;
+  std::vector<std::vector<int> > received( consumers );
+  std::vector<std::thread> consumer_threads;
+  for ( int c = 0; c < consumers; c++ ) {
+    consumer_threads.push_back( std::thread( [&, c]() {
+      if ( c % 2 == 0 ) {
+        int value;
+        while ( h.pop( value ) ) {
+          received[ c ].push_back( value );
+        }
+      } else {
+        std::vector<int> batch;
+        while ( !( batch = h.popBatch( 32 ) ).empty() ) {
+          received[ c ].insert( received[ c ].end(), batch.begin(), batch.end() );
+        }
+      }
+    } ) );
+  }
+  std::vector<std::thread> producer_threads;
+  for ( int p = 0; p < producers; p++ ) {
+    producer_threads.push_back( std::thread( [&, p]() {
+      std::vector<int> batch;
+      for ( int i = 0; i < per_producer; i++ ) {
+        int value = p * per_producer + i;
+        if ( p % 2 == 0 ) {
+          h.push( value );
+        } else {
+          batch.push_back( value );
+          if ( batch.size() == 64 ) {
+            h.pushBatch( batch.begin(), batch.end() );
+            batch.clear();
+          }
+        }
+      }
+      h.pushBatch( batch.begin(), batch.end() );
+    } ) );
+  }
+  for ( size_t i = 0; i < producer_threads.size(); i++ ) {
+    producer_threads[ i ].join();
+  }
+  h.close();
+  for ( size_t i = 0; i < consumer_threads.size(); i++ ) {
+    consumer_threads[ i ].join();
+  }
+  std::vector<int> all;
+  for ( int c = 0; c < consumers; c++ ) {
+    all.insert( all.end(), received[ c ].begin(), received[ c ].end() );
+  }
+  std::sort( all.begin(), all.end() );
+  bool t = all.size() == static_cast<size_t>( producers * per_producer );
+  for ( size_t i = 0; t && i < all.size(); i++ ) {
+    t = all[ i ] == static_cast<int>( i );
+  }
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "producers/consumers = " << t << "\t\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+int main( int argc, const char * argv[] ) {
+  if ( test_concurrent_max_heap_push_pop() ) {
+    std::cout << "test_concurrent_max_heap_push_pop -> OK" << std::endl;
+  } else {
+    std::cout << "test_concurrent_max_heap_push_pop -> FAIL" << std::endl;
+  }
+  if ( test_concurrent_max_heap_batches() ) {
+    std::cout << "test_concurrent_max_heap_batches -> OK" << std::endl;
+  } else {
+    std::cout << "test_concurrent_max_heap_batches -> FAIL" << std::endl;
+  }
+  if ( test_concurrent_max_heap_close_releases_consumers() ) {
+    std::cout << "test_concurrent_max_heap_close_releases_consumers -> OK" << std::endl;
+  } else {
+    std::cout << "test_concurrent_max_heap_close_releases_consumers -> FAIL" << std::endl;
+  }
+  if ( test_concurrent_max_heap_producers_consumers() ) {
+    std::cout << "test_concurrent_max_heap_producers_consumers -> OK" << std::endl;
+  } else {
+    std::cout << "test_concurrent_max_heap_producers_consumers -> FAIL" << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,266 @@
+#include "ExternalMaxHeap.h"
+#include "MaxHeap.h"
+#include <algorithm>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <new>
+#include <vector>
+
+// Live and peak bytes allocated through operator new. Each block carries its
+// size in a header, so that operator delete can subtract it again.
+static size_t live_bytes = 0;
+static size_t peak_bytes = 0;
+
+static const size_t ALLOCATION_HEADER = 16;
+
+void* operator new( size_t bytes ) {
+  char* block = static_cast<char*>( std::malloc( bytes + ALLOCATION_HEADER ) );
+  if ( block == 0 ) {
+    throw std::bad_alloc();
+  }
+  *reinterpret_cast<size_t*>( block ) = bytes;
+  live_bytes += bytes;
+  peak_bytes = std::max( peak_bytes, live_bytes );
+  return block + ALLOCATION_HEADER;
+}
+
+void operator delete( void* pointer ) noexcept {
+  if ( pointer == 0 ) {
+    return;
+  }
+  char* block = static_cast<char*>( pointer ) - ALLOCATION_HEADER;
+  live_bytes -= *reinterpret_cast<size_t*>( block );
+  std::free( block );
+}
+
+bool test_external_max_heap_insert_extract() {
+  bool result = false;
+  int array_h[10] = { 4, 1, 3, 2, 16, 9, 10, 14, 8, 7 };
+  ExternalMaxHeap<int> h( 1 << 16 );
+  for ( int i = 0; i < 10; i++ ) {
+    h.maxHeapInsert( array_h[ i ] );
+  }
+  int array_ref[10] = { 16, 14, 10, 9, 8, 7, 4, 3, 2, 1 };
+  bool t1 = h.getSize() == 10 && h.getRunCount() == 0;
+  bool t2 = true;
+  for ( int i = 0; i < 10; i++ ) {
+    t2 = t2 && h.heapMaximum() == array_ref[ i ] && h.heapExtractMax() == array_ref[ i ];
+  }
+  bool thrown = false;
+  try {
+    h.heapExtractMax();
+  }
+  catch ( const std::underflow_error& ) {
+    thrown = true;
+  }
+  bool t = t1 && t2 && h.empty() && thrown;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "h.heapExtractMax() ordered = " << t2 << "\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_external_max_heap_spills_runs() {
+  bool result = false;
+  ExternalMaxHeap<uint64_t> h( 8192, "/tmp", 256 );
+  MaxHeap<uint64_t> reference;
+  uint64_t state = 88172645463325252ULL;
+  size_t most_runs = 0;
+  bool t1 = true;
+  for ( size_t i = 0; t1 && i < 20000; i++ ) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    if ( state % 4 != 0 || reference.empty() ) {
+      h.maxHeapInsert( state % 100000 );
+      reference.maxHeapInsert( state % 100000 );
+    } else {
+      t1 = h.heapExtractMax() == reference.heapExtractMax();
+    }
+    most_runs = std::max( most_runs, h.getRunCount() );
+  }
+  bool t2 = h.getSize() == reference.getSize() && h.getBytesWritten() > h.getSize() * sizeof( uint64_t );
+  while ( t2 && !reference.empty() ) {
+    t2 = h.heapMaximum() == reference.heapMaximum() && h.heapExtractMax() == reference.heapExtractMax();
+  }
+  bool t3 = h.empty() && h.getRunCount() == 0 && most_runs > 1 && h.getBytesRead() > 0;
+  bool t = t1 && t2 && t3;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "h.getRunCount() max = " << most_runs << "\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_external_max_heap_invalid_arguments() {
+  bool result = false;
+  bool budget_thrown = false;
+  try {
+    ExternalMaxHeap<uint64_t> h( 16 );
+  }
+  catch ( const std::invalid_argument& ) {
+    budget_thrown = true;
+  }
+  bool directory_thrown = false;
+  try {
+    ExternalMaxHeap<int> h( 4096, "/nonexistent/maxheap", 64 );
+    for ( int i = 0; i < 10000; i++ ) {
+      h.maxHeapInsert( i );
+    }
+  }
+  catch ( const std::runtime_error& ) {
+    directory_thrown = true;
+  }
+  bool t = budget_thrown && directory_thrown;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "ExternalMaxHeap(16) throws = " << budget_thrown << "\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_external_max_heap_write_failure() {
+  bool result = false;
+  char directory[] = "/tmp/maxheap-external-XXXXXX";
+  if ( mkdtemp( directory ) == 0 ) {
+    return false;
+  }
+  // Writes past the file size limit fail with EFBIG instead of a signal.
+  std::signal( SIGXFSZ, SIG_IGN );
+  struct rlimit unlimited;
+  getrlimit( RLIMIT_FSIZE, &unlimited );
+  struct rlimit limited = unlimited;
+  limited.rlim_cur = 3 * 512 * sizeof( uint64_t );
+  ExternalMaxHeap<uint64_t> h( 8192, directory, 256 );
+  MaxHeap<uint64_t> reference;
+  uint64_t state = 88172645463325252ULL;
+  size_t spill_failures = 0;
+  size_t merge_failures = 0;
+  bool t1 = true;
+  for ( size_t i = 0; t1 && i < 20000; i++ ) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    uint64_t value = state % 100000;
+    uint64_t before = h.getSize();
+    if ( before > 0 && before % 512 == 0 ) {
+      // The insertion buffer of 512 elements is full, so this insert spills.
+      rmdir( directory );
+      try {
+        h.maxHeapInsert( value );
+      } catch ( const std::runtime_error& ) {
+        spill_failures++;
+      }
+      mkdir( directory, 0700 );
+      t1 = h.getSize() == before;
+      // A single run fits below the limit, but a merge of several does not.
+      setrlimit( RLIMIT_FSIZE, &limited );
+      try {
+        h.maxHeapInsert( value );
+      } catch ( const std::runtime_error& ) {
+        merge_failures++;
+      }
+      setrlimit( RLIMIT_FSIZE, &unlimited );
+      if ( h.getSize() == before ) {
+        h.maxHeapInsert( value );
+      }
+    } else {
+      h.maxHeapInsert( value );
+    }
+    reference.maxHeapInsert( value );
+    t1 = t1 && h.getSize() == reference.getSize();
+  }
+  bool t2 = t1;
+  while ( t2 && !reference.empty() ) {
+    t2 = h.heapExtractMax() == reference.heapExtractMax();
+  }
+  rmdir( directory );
+  bool t = t1 && t2 && h.empty() && spill_failures > 0 && merge_failures > 0;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "failed spills, merges = " << spill_failures << ", " << merge_failures << "\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_external_max_heap_memory_budget() {
+  bool result = false;
+  const size_t budget = 1 << 16;
+  std::string directory = "/tmp";
+  size_t baseline = live_bytes;
+  peak_bytes = live_bytes;
+  size_t merges = 0;
+  bool t1 = true;
+  {
+    ExternalMaxHeap<uint64_t> h( budget, directory, 1024 );
+    size_t runs = 0;
+    for ( uint64_t i = 0; i < 300000; i++ ) {
+      h.maxHeapInsert( ( i * 2654435761ULL ) % 1000003 );
+      if ( h.getRunCount() < runs ) {
+        merges++;
+      }
+      runs = h.getRunCount();
+    }
+    uint64_t previous = h.heapMaximum();
+    while ( t1 && !h.empty() ) {
+      uint64_t current = h.heapExtractMax();
+      t1 = current <= previous;
+      previous = current;
+    }
+  }
+  size_t used = peak_bytes - baseline;
+  bool t2 = used <= budget;
+  bool t = t1 && t2 && merges > 0;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "peak bytes = " << used << " of " << budget << "\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+int main( int argc, const char * argv[] ) {
+  if ( test_external_max_heap_insert_extract() ) {
+    std::cout << "test_external_max_heap_insert_extract -> OK" << std::endl;
+  } else {
+    std::cout << "test_external_max_heap_insert_extract -> FAIL" << std::endl;
+  }
+  if ( test_external_max_heap_spills_runs() ) {
+    std::cout << "test_external_max_heap_spills_runs -> OK" << std::endl;
+  } else {
+    std::cout << "test_external_max_heap_spills_runs -> FAIL" << std::endl;
+  }
+  if ( test_external_max_heap_invalid_arguments() ) {
+    std::cout << "test_external_max_heap_invalid_arguments -> OK" << std::endl;
+  } else {
+    std::cout << "test_external_max_heap_invalid_arguments -> FAIL" << std::endl;
+  }
+  if ( test_external_max_heap_write_failure() ) {
+    std::cout << "test_external_max_heap_write_failure -> OK" << std::endl;
+  } else {
+    std::cout << "test_external_max_heap_write_failure -> FAIL" << std::endl;
+  }
+  if ( test_external_max_heap_memory_budget() ) {
+    std::cout << "test_external_max_heap_memory_budget -> OK" << std::endl;
+  } else {
+    std::cout << "test_external_max_heap_memory_budget -> FAIL" << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,173 @@
+#include "KeyedMaxHeap.h"
+#include "MaxHeapSimd.h"
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+bool test_keyed_max_heap_insert_extract() {
+  bool result = false;
+  int array_h[10] = { 4, 1, 3, 2, 16, 9, 10, 14, 8, 7 };
+  KeyedMaxHeap<int, std::string> h;
+  for ( int i = 0; i < 10; i++ ) {
+    h.maxHeapInsert( array_h[ i ], std::to_string( array_h[ i ] ) );
+  }
+  int array_ref[10] = { 16, 14, 10, 9, 8, 7, 4, 3, 2, 1 };
+  bool t1 = h.getSize() == 10 && h.isMaxHeap();
+  bool t2 = true;
+  for ( int i = 0; i < 10; i++ ) {
+    bool top = h.heapMaximum() == array_ref[ i ] && h.maximumValue() == std::to_string( array_ref[ i ] );
+    KeyedMaxHeap<int, std::string>::Element element = h.heapExtractMax();
+    t2 = t2 && top && element.first == array_ref[ i ] && element.second == std::to_string( array_ref[ i ] ) && h.isMaxHeap();
+  }
+  bool thrown = false;
+  try {
+    h.heapExtractMax();
+  }
+  catch ( const std::underflow_error& ) {
+    thrown = true;
+  }
+  bool t = t1 && t2 && h.empty() && thrown;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "h.heapExtractMax() ordered = " << t2 << "\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_keyed_max_heap_values_follow_keys() {
+  bool result = false;
+  KeyedMaxHeap<int, std::vector<int>, 4> h;
+  for ( int i = 0; i < 1000; i++ ) {
+    int key = ( i * 7919 ) % 1009;
+    h.maxHeapInsert( key, std::vector<int>( 3, key ) );
+  }
+  bool t1 = h.isMaxHeap();
+  for ( size_t i = 0; t1 && i < h.getSize(); i++ ) {
+    t1 = h.valueAt( i ) == std::vector<int>( 3, h.keyAt( i ) );
+  }
+  bool t2 = true;
+  int previous = h.heapMaximum();
+  while ( t2 && !h.empty() ) {
+    KeyedMaxHeap<int, std::vector<int>, 4>::Element element = h.heapExtractMax();
+    t2 = element.first <= previous && element.second == std::vector<int>( 3, element.first );
+    previous = element.first;
+  }
+  bool t = t1 && t2;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "h.valueAt(i) = " << t1 << "\t\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_keyed_max_heap_remove_at() {
+  bool result = false;
+  KeyedMaxHeap<int, std::string> h;
+  std::vector<int> reference;
+  for ( int i = 0; i < 200; i++ ) {
+    int key = ( i * 37 ) % 101;
+    h.maxHeapInsert( key, std::to_string( key ) );
+    reference.push_back( key );
+  }
+  bool t1 = true;
+  for ( size_t i = 0; t1 && h.getSize() > 100; i++ ) {
+    size_t index = ( i * 13 ) % h.getSize();
+    KeyedMaxHeap<int, std::string>::Element element = h.removeAt( index );
+    reference.erase( std::find( reference.begin(), reference.end(), element.first ) );
+    t1 = element.second == std::to_string( element.first ) && h.isMaxHeap();
+  }
+  for ( int i = 0; i < 50; i++ ) {
+    h.maxHeapInsert( 1000 + i, std::to_string( 1000 + i ) );
+    reference.push_back( 1000 + i );
+  }
+  std::sort( reference.rbegin(), reference.rend() );
+  bool t2 = h.getSize() == reference.size() && h.isMaxHeap();
+  for ( size_t i = 0; t2 && i < reference.size(); i++ ) {
+    KeyedMaxHeap<int, std::string>::Element element = h.heapExtractMax();
+    t2 = element.first == reference[ i ] && element.second == std::to_string( reference[ i ] );
+  }
+  bool thrown = false;
+  try {
+    h.removeAt( 0 );
+  }
+  catch ( const std::out_of_range& ) {
+    thrown = true;
+  }
+  bool t = t1 && t2 && thrown;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "h.removeAt(index) = " << t1 << "\t\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+// Inserts pseudo-random keys, removes some, and checks that the rest come
+// out sorted with their values.
+template<typename Heap>
+bool checkKeyedOrder() {
+  Heap h;
+  std::vector<int> reference;
+  for ( int i = 0; i < 3000; i++ ) {
+    int key = ( i * 7919 ) % 1009;
+    h.maxHeapInsert( key, std::to_string( key ) );
+    reference.push_back( key );
+  }
+  bool consistent = h.isMaxHeap();
+  for ( size_t i = 0; consistent && i < 500; i++ ) {
+    typename Heap::Element element = h.removeAt( ( i * 31 ) % h.getSize() );
+    reference.erase( std::find( reference.begin(), reference.end(), element.first ) );
+    consistent = element.second == std::to_string( element.first ) && h.isMaxHeap();
+  }
+  std::sort( reference.rbegin(), reference.rend() );
+  for ( size_t i = 0; consistent && i < reference.size(); i++ ) {
+    typename Heap::Element element = h.heapExtractMax();
+    consistent = element.first == reference[ i ] && element.second == std::to_string( reference[ i ] );
+  }
+  return consistent && h.empty();
+}
+
+bool test_keyed_max_heap_layouts() {
+  bool result = false;
+  // An arity of 16 over int keys selects children with SimdMaxChild.
+  bool t1 = checkKeyedOrder<KeyedMaxHeap<int, std::string, 16> >();
+  bool t2 = checkKeyedOrder<KeyedMaxHeap<int, std::string, 4, BHeapLayout<64> > >();
+  bool t = t1 && t2;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "arity 16, BHeapLayout = " << t1 << ", " << t2 << "\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+int main( int argc, const char * argv[] ) {
+  if ( test_keyed_max_heap_insert_extract() ) {
+    std::cout << "test_keyed_max_heap_insert_extract -> OK" << std::endl;
+  } else {
+    std::cout << "test_keyed_max_heap_insert_extract -> FAIL" << std::endl;
+  }
+  if ( test_keyed_max_heap_values_follow_keys() ) {
+    std::cout << "test_keyed_max_heap_values_follow_keys -> OK" << std::endl;
+  } else {
+    std::cout << "test_keyed_max_heap_values_follow_keys -> FAIL" << std::endl;
+  }
+  if ( test_keyed_max_heap_remove_at() ) {
+    std::cout << "test_keyed_max_heap_remove_at -> OK" << std::endl;
+  } else {
+    std::cout << "test_keyed_max_heap_remove_at -> FAIL" << std::endl;
+  }
+  if ( test_keyed_max_heap_layouts() ) {
+    std::cout << "test_keyed_max_heap_layouts -> OK" << std::endl;
+  } else {
+    std::cout << "test_keyed_max_heap_layouts -> FAIL" << std::endl;
+  }
+  return 0;
+}
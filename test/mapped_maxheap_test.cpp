@@ -0,0 +1,232 @@
+#include "MappedMaxHeap.h"
+#include "MaxHeap.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+const std::string SNAPSHOT_PATH = "/tmp/mapped_maxheap_test.snapshot";
+
+bool test_mapped_max_heap_open_snapshot() {
+  bool result = false;
+  std::vector<int> vector_h;
+  for ( int i = 0; i < 1000; i++ ) {
+    vector_h.push_back( ( i * 7919 ) % 1009 );
+  }
+  MaxHeap<int, 4> h( vector_h );
+  saveMaxHeapSnapshot( h, SNAPSHOT_PATH );
+  MappedMaxHeap<int, 4> m( SNAPSHOT_PATH );
+  bool t1 = m.getSize() == h.getSize() && m.getCapacity() == h.getSize() && m.isMaxHeap();
+  for ( size_t i = 0; t1 && i < h.getSize(); i++ ) {
+    t1 = m.at( i ) == h.at( i );
+  }
+  bool t2 = true;
+  for ( size_t i = 0; t2 && i < 500; i++ ) {
+    t2 = m.heapMaximum() == h.heapMaximum() && m.heapExtractMax() == h.heapExtractMax();
+  }
+  bool t = t1 && t2 && m.isMaxHeap();
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "MappedMaxHeap(snapshot) = " << t1 << "\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_mapped_max_heap_sync_reopen() {
+  bool result = false;
+  std::vector<uint64_t> reference;
+  {
+    MappedMaxHeap<uint64_t> m( SNAPSHOT_PATH, CREATE_NEW );
+    for ( uint64_t i = 0; i < 5000; i++ ) {
+      m.maxHeapInsert( ( i * 104729 ) % 10007 );
+    }
+    m.maxHeapInsert( m.heapMaximum() );
+    for ( int i = 0; i < 100; i++ ) {
+      m.heapExtractMax();
+    }
+    m.sync();
+    for ( size_t i = 0; i < m.getSize(); i++ ) {
+      reference.push_back( m.at( i ) );
+    }
+  }
+  MappedMaxHeap<uint64_t> reopened( SNAPSHOT_PATH );
+  bool t1 = reopened.getSize() == reference.size() && reopened.getCapacity() >= reference.size();
+  for ( size_t i = 0; t1 && i < reference.size(); i++ ) {
+    t1 = reopened.data()[ i ] == reference[ i ];
+  }
+  MaxHeap<uint64_t> h( reference );
+  bool t2 = true;
+  while ( t2 && !h.empty() ) {
+    t2 = reopened.heapExtractMax() == h.heapExtractMax();
+  }
+  bool thrown = false;
+  try {
+    reopened.heapExtractMax();
+  }
+  catch ( const std::underflow_error& ) {
+    thrown = true;
+  }
+  bool t = t1 && t2 && reopened.empty() && thrown;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "reopened.getSize() = " << reference.size() << "\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+/*
+ * Returns true if opening the snapshot throws std::runtime_error.
+ */
+template<typename T, size_t Arity>
+bool rejects( bool verify ) {
+  try {
+    MappedMaxHeap<T, Arity> m( SNAPSHOT_PATH, OPEN_EXISTING, verify );
+  }
+  catch ( const std::runtime_error& ) {
+    return true;
+  }
+  return false;
+}
+
+bool test_mapped_max_heap_integrity_check() {
+  bool result = false;
+  int array_h[6] = { 9, 5, 8, 1, 2, 7 };
+  MaxHeap<int> h( array_h, 6 );
+  saveMaxHeapSnapshot( h, SNAPSHOT_PATH );
+  bool t1 = !rejects<int, 2>( true ) && rejects<int, 4>( true ) && rejects<uint64_t, 2>( true );
+  std::FILE* file = std::fopen( SNAPSHOT_PATH.c_str(), "r+b" );
+  int larger = 100;
+  std::fseek( file, sizeof( MaxHeapSnapshotHeader ) + 5 * sizeof( int ), SEEK_SET );
+  std::fwrite( &larger, sizeof( larger ), 1, file );
+  std::fclose( file );
+  bool t2 = rejects<int, 2>( true ) && !rejects<int, 2>( false );
+  file = std::fopen( SNAPSHOT_PATH.c_str(), "r+b" );
+  std::fwrite( "NOTAHEAP", 8, 1, file );
+  std::fclose( file );
+  bool t3 = rejects<int, 2>( false );
+  std::remove( SNAPSHOT_PATH.c_str() );
+  bool t4 = rejects<int, 2>( false );
+  bool t = t1 && t2 && t3 && t4;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "corrupt snapshot rejected = " << t2 << "\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_mapped_max_heap_failed_save() {
+  bool result = false;
+  MaxHeap<int, 4> previous;
+  previous.maxHeapInsert( 7 );
+  saveMaxHeapSnapshot( previous, SNAPSHOT_PATH );
+  MaxHeap<int, 4> next;
+  for ( int i = 0; i < 100; i++ ) {
+    next.maxHeapInsert( i );
+  }
+  // A directory in the way of the temporary file makes the save fail.
+  std::string temporary = SNAPSHOT_PATH + ".tmp";
+  mkdir( temporary.c_str(), 0700 );
+  bool thrown = false;
+  try {
+    saveMaxHeapSnapshot( next, SNAPSHOT_PATH );
+  } catch ( const std::runtime_error& ) {
+    thrown = true;
+  }
+  rmdir( temporary.c_str() );
+  bool t1 = false;
+  {
+    MappedMaxHeap<int, 4> kept( SNAPSHOT_PATH );
+    t1 = kept.getSize() == 1 && kept.heapMaximum() == 7;
+  }
+  saveMaxHeapSnapshot( next, SNAPSHOT_PATH );
+  MappedMaxHeap<int, 4> replaced( SNAPSHOT_PATH );
+  bool t2 = replaced.getSize() == 100 && replaced.heapMaximum() == 99 && access( temporary.c_str(), F_OK ) != 0;
+  bool t = thrown && t1 && t2;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "failed saveMaxHeapSnapshot keeps previous = " << t1 << "\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_mapped_max_heap_failed_grow() {
+  bool result = false;
+  MappedMaxHeap<int> h( SNAPSHOT_PATH, CREATE_NEW );
+  for ( int i = 0; i < 100; i++ ) {
+    h.maxHeapInsert( i );
+  }
+  size_t capacity = h.getCapacity();
+  struct stat before;
+  stat( SNAPSHOT_PATH.c_str(), &before );
+  // The file may grow sparsely, but mapping a terabyte exceeds the limit.
+  struct rlimit unlimited;
+  getrlimit( RLIMIT_AS, &unlimited );
+  struct rlimit limited = unlimited;
+  limited.rlim_cur = std::min<rlim_t>( unlimited.rlim_cur, static_cast<rlim_t>( 1 ) << 36 );
+  setrlimit( RLIMIT_AS, &limited );
+  bool thrown = false;
+  try {
+    h.reserve( ( static_cast<size_t>( 1 ) << 40 ) / sizeof( int ) );
+  } catch ( const std::runtime_error& ) {
+    thrown = true;
+  }
+  setrlimit( RLIMIT_AS, &unlimited );
+  struct stat after;
+  stat( SNAPSHOT_PATH.c_str(), &after );
+  bool t1 = h.getSize() == 100 && h.getCapacity() == capacity && h.heapMaximum() == 99 && after.st_size == before.st_size;
+  for ( int i = 100; i < 1000; i++ ) {
+    h.maxHeapInsert( i );
+  }
+  bool t2 = h.getSize() == 1000 && h.heapMaximum() == 999 && h.isMaxHeap();
+  bool t = thrown && t1 && t2;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "failed reserve keeps mapping = " << t1 << "\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+int main( int argc, const char * argv[] ) {
+  if ( test_mapped_max_heap_open_snapshot() ) {
+    std::cout << "test_mapped_max_heap_open_snapshot -> OK" << std::endl;
+  } else {
+    std::cout << "test_mapped_max_heap_open_snapshot -> FAIL" << std::endl;
+  }
+  if ( test_mapped_max_heap_sync_reopen() ) {
+    std::cout << "test_mapped_max_heap_sync_reopen -> OK" << std::endl;
+  } else {
+    std::cout << "test_mapped_max_heap_sync_reopen -> FAIL" << std::endl;
+  }
+  if ( test_mapped_max_heap_integrity_check() ) {
+    std::cout << "test_mapped_max_heap_integrity_check -> OK" << std::endl;
+  } else {
+    std::cout << "test_mapped_max_heap_integrity_check -> FAIL" << std::endl;
+  }
+  if ( test_mapped_max_heap_failed_save() ) {
+    std::cout << "test_mapped_max_heap_failed_save -> OK" << std::endl;
+  } else {
+    std::cout << "test_mapped_max_heap_failed_save -> FAIL" << std::endl;
+  }
+  if ( test_mapped_max_heap_failed_grow() ) {
+    std::cout << "test_mapped_max_heap_failed_grow -> OK" << std::endl;
+  } else {
+    std::cout << "test_mapped_max_heap_failed_grow -> FAIL" << std::endl;
+  }
+  return 0;
+}
@@ -1,7 +1,55 @@
+// Use the SIMD kernels for every key type and arity they support, not only
+// where they are faster, so that all of them are tested.
+#define MAXHEAP_SIMD_ALWAYS
+
 #include "MaxHeap.h"
+#include "MaxHeapSerialization.h"
+#include "MaxHeapSimd.h"
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+// Move-only element type used to check that MaxHeap never copies.
+struct MoveOnlyKey {
+  int key;
+  std::unique_ptr<int> payload;
+
+  MoveOnlyKey( int k ) : key( k ), payload( new int( k ) ) {
+  }
+
+  MoveOnlyKey( MoveOnlyKey&& other ) = default;
+  MoveOnlyKey& operator = ( MoveOnlyKey&& other ) = default;
+
+  friend bool operator < ( const MoveOnlyKey& lhs, const MoveOnlyKey& rhs ) {
+    return lhs.key < rhs.key;
+  }
+
+  friend bool operator > ( const MoveOnlyKey& lhs, const MoveOnlyKey& rhs ) {
+    return lhs.key > rhs.key;
+  }
+
+  friend bool operator >= ( const MoveOnlyKey& lhs, const MoveOnlyKey& rhs ) {
+    return lhs.key >= rhs.key;
+  }
+};
+
+// Containers such as std::vector only move elements on reallocation if the
+// move constructor cannot throw; otherwise they copy, or fail for MoveOnlyKey.
+static_assert( std::is_nothrow_move_constructible<MaxHeap<int> >::value, "MaxHeap<int> must be nothrow move constructible" );
+static_assert( std::is_nothrow_move_constructible<MaxHeap<std::string, 4> >::value, "MaxHeap<std::string, 4> must be nothrow move constructible" );
+static_assert( std::is_nothrow_move_constructible<MaxHeap<MoveOnlyKey, 4, ImplicitLayout, InstanceMaxHeapStats> >::value, "An instrumented MaxHeap must be nothrow move constructible" );
+static_assert( std::is_nothrow_move_assignable<MaxHeap<int> >::value, "MaxHeap<int> must be nothrow move assignable" );
+static_assert( std::is_nothrow_move_assignable<MaxHeap<MoveOnlyKey, 4> >::value, "MaxHeap<MoveOnlyKey, 4> must be nothrow move assignable" );
+
 bool test_max_heap_empty_constructor() {
   bool result = false;
   MaxHeap<int> h;
@@ -507,6 +555,818 @@ bool test_max_heap_remove_at() {
   return result;
 }
 
+bool test_max_heap_quaternary_child_index() {
+  bool result = false;
+  int array_h[10] = { 4, 1, 3, 2, 16, 9, 10, 14, 8, 7 };
+  MaxHeap<int, 4> h( array_h, 10 );
+  bool t1 = h.leftChildIndex( 1 ) == 5;
+  bool t2 = h.rightChildIndex( 1 ) == 8;
+  bool t3 = h.childIndex( 1, 2 ) == 7;
+  bool t4 = h.parentIndex( 8 ) == 1;
+  bool t5 = h.isLeaf( 3 ) == true && h.isLeaf( 2 ) == false;
+  bool t = t1 && t2 && t3 && t4 && t5;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "h.childIndex(1, 2) = " << h.childIndex( 1, 2 ) << "\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_max_heap_quaternary_build_max_heap() {
+  bool result = false;
+  int array_h[10] = { 4, 1, 3, 2, 16, 9, 10, 14, 8, 7 };
+  std::vector<int> vector_h( array_h, array_h + 10 );
+  MaxHeap<int, 4> res_recursive( vector_h, RECURSIVE );
+  MaxHeap<int, 4> res_iterative( vector_h, ITERATIVE );
+  bool t1 = res_recursive.isMaxHeap();
+  bool t2 = res_iterative.isMaxHeap();
+  bool t3 = res_recursive.heapMaximum() == 16;
+  bool t = t1 && t2 && t3;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "h = " << res_recursive << "\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_max_heap_octonary_sort() {
+  bool result = false;
+  int array_h[10] = { 4, 1, 3, 2, 16, 9, 10, 14, 8, 7 };
+  MaxHeap<int, 8> h( array_h, 10 );
+  std::vector<int> res = h.heapSort();
+  int array_ref[10] = { 16, 14, 10, 9, 8, 7, 4, 3, 2, 1 };
+  std::vector<int> ref( array_ref, array_ref + 10 );
+  if ( res == ref && h.isMaxHeap() && h.getSize() == 10 ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "ref == res = " << result << "\t\t\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_max_heap_hexadecimal_insert_extract() {
+  bool result = false;
+  MaxHeap<int, 16> h;
+  for ( int i = 0; i < 100; i++ ) {
+    h.maxHeapInsert( ( i * 37 ) % 100 );
+  }
+  bool t1 = h.isMaxHeap();
+  bool t2 = h.removeAt( 20 ) >= 0 && h.isMaxHeap() && h.getSize() == 99;
+  bool t3 = true;
+  int previous = h.heapExtractMax();
+  while ( !h.empty() ) {
+    int current = h.heapExtractMax();
+    t3 = t3 && current <= previous;
+    previous = current;
+  }
+  bool t = t1 && t2 && t3;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "h.heapExtractMax() ordered = " << t3 << "\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_max_heap_remove_at_duplicates() {
+  bool result = false;
+  int array_h[10] = { 4, 1, 3, 2, 16, 9, 10, 14, 8, 7 };
+  MaxHeap<int> h( array_h, 10 );
+  h.maxHeapInsert( 1 );
+  h.maxHeapInsert( 1 );
+  int removed = h.removeAt( h.getSize() - 1 );
+  bool t1 = removed == 1;
+  bool t2 = h.getSize() == 11;
+  bool t3 = h.isMaxHeap();
+  h.removeAt( 0 );
+  bool t4 = h.getSize() == 10 && h.isMaxHeap() && h.heapMaximum() == 14;
+  bool t = t1 && t2 && t3 && t4;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "h = " << h << "\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_max_heap_vector_move_constructor() {
+  bool result = false;
+  int array_h[10] = { 4, 1, 3, 2, 16, 9, 10, 14, 8, 7 };
+  std::vector<int> vector_h( array_h, array_h + 10 );
+  const int* data = vector_h.data();
+  MaxHeap<int> h( std::move( vector_h ) );
+  bool t1 = &h.heapMaximum() == data;
+  bool t2 = h.isMaxHeap() && h.getSize() == 10;
+  bool t = t1 && t2;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "h = " << h << "\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_max_heap_insert_rvalue() {
+  bool result = false;
+  MaxHeap<std::string> h;
+  std::string a( "delta" );
+  std::string b( "alpha" );
+  h.maxHeapInsert( std::move( a ) );
+  h.maxHeapInsert( b );
+  h.emplace( 5, 'z' );
+  h.emplace( "charlie" );
+  std::string first = h.heapExtractMax();
+  std::string second = h.heapExtractMax();
+  bool t1 = first == "zzzzz" && second == "delta";
+  bool t2 = b == "alpha" && h.getSize() == 2 && h.isMaxHeap();
+  bool t = t1 && t2;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "h = " << h << "\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_max_heap_move_only() {
+  bool result = false;
+  MaxHeap<MoveOnlyKey, 4> h;
+  int keys[10] = { 4, 1, 3, 2, 16, 9, 10, 14, 8, 7 };
+  for ( int i = 0; i < 10; i++ ) {
+    if ( i % 2 == 0 ) {
+      h.maxHeapInsert( MoveOnlyKey( keys[ i ] ) );
+    } else {
+      h.emplace( keys[ i ] );
+    }
+  }
+  MoveOnlyKey removed = h.removeAt( 3 );
+  bool t1 = removed.payload && *removed.payload == removed.key;
+  MaxHeap<MoveOnlyKey, 4> moved( std::move( h ) );
+  bool t2 = h.empty() && moved.getSize() == 9 && moved.isMaxHeap();
+  bool t3 = true;
+  int previous = moved.heapMaximum().key;
+  while ( !moved.empty() ) {
+    MoveOnlyKey current = moved.heapExtractMax();
+    t3 = t3 && current.key <= previous && current.payload && *current.payload == current.key;
+    previous = current.key;
+  }
+  bool t = t1 && t2 && t3;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "moved.heapExtractMax() ordered = " << t3 << "\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_max_heap_at_out_of_range() {
+  bool result = false;
+  int array_h[10] = { 4, 1, 3, 2, 16, 9, 10, 14, 8, 7 };
+  MaxHeap<int> h( array_h, 10 );
+  bool thrown = false;
+  try {
+    h.at( 10 );
+  }
+  catch ( const std::out_of_range& ) {
+    thrown = true;
+  }
+  if ( thrown && h.at( 9 ) == 1 ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "h.at(10) throws = " << thrown << "\t\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_max_heap_bottom_up_extract_max() {
+  bool result = false;
+  int array_h[10] = { 4, 1, 3, 2, 16, 9, 10, 14, 8, 7 };
+  MaxHeap<int> h( array_h, 10 );
+  h.setExtractionType( BOTTOM_UP );
+  int array_ref[10] = { 16, 14, 10, 9, 8, 7, 4, 3, 2, 1 };
+  bool t1 = h.getExtractionType() == BOTTOM_UP;
+  bool t2 = true;
+  for ( int i = 0; i < 10; i++ ) {
+    t2 = t2 && h.heapExtractMax() == array_ref[ i ] && h.isMaxHeap();
+  }
+  bool t = t1 && t2 && h.empty();
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "h.heapExtractMax() ordered = " << t2 << "\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_max_heap_bottom_up_sort() {
+  bool result = false;
+  MaxHeap<int, 4> h;
+  h.setExtractionType( BOTTOM_UP );
+  for ( int i = 0; i < 50; i++ ) {
+    h.maxHeapInsert( ( i * 29 ) % 50 );
+  }
+  std::vector<int> res = h.heapSort();
+  bool t1 = res.size() == 50 && h.getSize() == 50 && h.isMaxHeap();
+  bool t2 = true;
+  for ( int i = 0; i < 50; i++ ) {
+    t2 = t2 && res[ i ] == 49 - i;
+  }
+  bool t = t1 && t2;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "ref == res = " << t << "\t\t\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_max_heap_bottom_up_remove_at() {
+  bool result = false;
+  int array_org[10] = { 4, 1, 3, 2, 16, 9, 10, 14, 8, 7 };
+  MaxHeap<int> h_org( array_org, 10 );
+  h_org.setExtractionType( BOTTOM_UP );
+  int array_ref[9] = { 16, 8, 10, 4, 7, 9, 3, 2, 1 };
+  MaxHeap<int> h_ref( array_ref, 9 );
+  int remove_element_res = h_org.removeAt( 1 );
+  if ( remove_element_res == 14 && h_org == h_ref ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "h.removeAt(1) = " << remove_element_res << "\t\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_max_heap_build_max_heap_parallel() {
+  bool result = false;
+  std::vector<int> vector_h;
+  for ( int i = 0; i < 200000; i++ ) {
+    vector_h.push_back( ( i * 7919 ) % 200003 );
+  }
+  MaxHeap<int> res( vector_h, PARALLEL, 4 );
+  MaxHeap<int, 4> res_quaternary( vector_h, PARALLEL, 3 );
+  int array_h[10] = { 4, 1, 3, 2, 16, 9, 10, 14, 8, 7 };
+  MaxHeap<int> small( array_h, 10, PARALLEL );
+  MaxHeap<int> ref( array_h, 10, ITERATIVE );
+  bool t1 = res.isMaxHeap() && res.getSize() == 200000;
+  bool t2 = res_quaternary.isMaxHeap() && res_quaternary.getSize() == 200000;
+  bool t3 = res.heapMaximum() == *std::max_element( vector_h.begin(), vector_h.end() );
+  bool t4 = small == ref;
+  bool t = t1 && t2 && t3 && t4;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "h.buildMaxHeapParallel = " << small << "\t\t";
+  #endif
+  return result;
+}
+
+bool test_max_heap_insert_range() {
+  bool result = false;
+  int array_h[10] = { 4, 1, 3, 2, 16, 9, 10, 14, 8, 7 };
+  MaxHeap<int> small_batch( array_h, 10 );
+  int array_small[2] = { 15, 5 };
+  small_batch.insertRange( array_small, array_small + 2 );
+  MaxHeap<int, 4> large_batch( array_h, 10 );
+  std::vector<int> vector_large;
+  for ( int i = 0; i < 1000; i++ ) {
+    vector_large.push_back( i );
+  }
+  large_batch.insertRange( vector_large.begin(), vector_large.end() );
+  MaxHeap<int> empty_heap;
+  empty_heap.insertRange( vector_large.begin(), vector_large.end() );
+  bool t1 = small_batch.isMaxHeap() && small_batch.getSize() == 12 && small_batch.heapMaximum() == 16;
+  bool t2 = large_batch.isMaxHeap() && large_batch.getSize() == 1010 && large_batch.heapMaximum() == 999;
+  bool t3 = empty_heap.isMaxHeap() && empty_heap.getSize() == 1000;
+  bool t = t1 && t2 && t3;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "h.insertRange = " << small_batch << "\t";
+  #endif
+  return result;
+}
+
+bool test_max_heap_increase_decrease_key() {
+  bool result = false;
+  int array_h[10] = { 4, 1, 3, 2, 16, 9, 10, 14, 8, 7 };
+  MaxHeap<int> h( array_h, 10 );
+  h.increaseKey( 9, 20 );
+  bool t1 = h.heapMaximum() == 20 && h.isMaxHeap();
+  h.decreaseKey( 0, 0 );
+  bool t2 = h.heapMaximum() == 16 && h.isMaxHeap() && h.getSize() == 10;
+  bool thrown_increase = false;
+  try {
+    h.increaseKey( 0, 1 );
+  }
+  catch ( const std::invalid_argument& ) {
+    thrown_increase = true;
+  }
+  bool thrown_decrease = false;
+  try {
+    h.decreaseKey( 0, 100 );
+  }
+  catch ( const std::invalid_argument& ) {
+    thrown_decrease = true;
+  }
+  bool t = t1 && t2 && thrown_increase && thrown_decrease;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "h = " << h << "\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_max_heap_update_key() {
+  bool result = false;
+  int array_h[10] = { 4, 1, 3, 2, 16, 9, 10, 14, 8, 7 };
+  MaxHeap<int, 4> h( array_h, 10 );
+  h.updateKey( 0, -5 );
+  bool t1 = h.heapMaximum() == 14 && h.isMaxHeap();
+  h.updateKey( h.getSize() - 1, 30 );
+  bool t2 = h.heapMaximum() == 30 && h.isMaxHeap();
+  std::vector<int> res = h.heapSort();
+  bool t3 = res.size() == 10 && res.front() == 30 && res.back() == -5;
+  for ( size_t i = 1; t3 && i < res.size(); i++ ) {
+    t3 = res[ i ] <= res[ i - 1 ];
+  }
+  bool t = t1 && t2 && t3;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "h = " << h << "\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_max_heap_update_keys() {
+  bool result = false;
+  std::vector<int> vector_h;
+  for ( int i = 0; i < 1000; i++ ) {
+    vector_h.push_back( ( i * 7919 ) % 1009 );
+  }
+  MaxHeap<int> few( vector_h );
+  std::vector<std::pair<size_t, int> > few_changes;
+  few_changes.push_back( std::make_pair( 0, -1 ) );
+  few_changes.push_back( std::make_pair( 500, 5000 ) );
+  few_changes.push_back( std::make_pair( 999, 4000 ) );
+  few.updateKeys( few_changes.begin(), few_changes.end() );
+  MaxHeap<int> many( vector_h );
+  std::vector<std::pair<size_t, int> > many_changes;
+  for ( size_t i = 0; i < 1000; i += 2 ) {
+    many_changes.push_back( std::make_pair( i, static_cast<int>( i ) ) );
+  }
+  many.updateKeys( many_changes.begin(), many_changes.end() );
+  bool t1 = few.isMaxHeap() && few.heapExtractMax() == 5000 && few.heapExtractMax() == 4000;
+  bool t2 = many.isMaxHeap() && many.getSize() == 1000;
+  bool t = t1 && t2;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "h.updateKeys = " << t << "\t\t\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_max_heap_sort_in_place() {
+  bool result = false;
+  std::vector<int> vector_h;
+  for ( int i = 0; i < 1000; i++ ) {
+    vector_h.push_back( ( i * 7919 ) % 1009 );
+  }
+  std::vector<int> reference = vector_h;
+  std::sort( reference.begin(), reference.end() );
+  std::reverse( reference.begin(), reference.end() );
+  MaxHeap<int> top_down( vector_h );
+  MaxHeap<int, 4> bottom_up( vector_h );
+  bottom_up.setExtractionType( BOTTOM_UP );
+  std::vector<int> sorted_top_down = top_down.sortInPlace();
+  std::vector<int> sorted_bottom_up = bottom_up.sortInPlace();
+  MaxHeap<int> single;
+  single.maxHeapInsert( 42 );
+  std::vector<int> sorted_single = single.sortInPlace();
+  bool t1 = sorted_top_down == reference && top_down.empty();
+  bool t2 = sorted_bottom_up == reference && bottom_up.empty();
+  bool t3 = sorted_single.size() == 1 && sorted_single[0] == 42 && single.empty();
+  bool t = t1 && t2 && t3;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "h.sortInPlace = " << t << "\t\t\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_max_heap_sort_into() {
+  bool result = false;
+  std::vector<int> vector_h;
+  for ( int i = 0; i < 100; i++ ) {
+    vector_h.push_back( ( i * 37 ) % 101 );
+  }
+  std::vector<int> reference = vector_h;
+  std::sort( reference.begin(), reference.end() );
+  std::reverse( reference.begin(), reference.end() );
+  MaxHeap<int, 3> h( vector_h );
+  int buffer[100];
+  int* end = h.sortInto( buffer );
+  MaxHeap<std::string> strings;
+  strings.maxHeapInsert( "b" );
+  strings.maxHeapInsert( "c" );
+  strings.maxHeapInsert( "a" );
+  std::vector<std::string> sorted_strings;
+  strings.sortInto( std::back_inserter( sorted_strings ) );
+  bool t1 = end == buffer + 100 && std::equal( reference.begin(), reference.end(), buffer ) && h.empty();
+  bool t2 = sorted_strings.size() == 3 && sorted_strings[0] == "c" && sorted_strings[2] == "a" && strings.empty();
+  bool t = t1 && t2;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "h.sortInto = " << t << "\t\t\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_max_heap_replace_max() {
+  bool result = false;
+  int array_h[10] = { 4, 1, 3, 2, 16, 9, 10, 14, 8, 7 };
+  MaxHeap<int> h( array_h, 10 );
+  int first = h.heapReplaceMax( 5 );
+  int second = h.heapReplaceMax( 20 );
+  MaxHeap<int> empty_heap;
+  bool t3 = false;
+  try {
+    empty_heap.heapReplaceMax( 1 );
+  } catch ( const std::underflow_error& ) {
+    t3 = true;
+  }
+  bool t1 = first == 16 && second == 14 && h.getSize() == 10 && h.isMaxHeap();
+  bool t2 = h.heapExtractMax() == 20 && h.heapExtractMax() == 10;
+  bool t = t1 && t2 && t3;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "h.heapReplaceMax() = " << t << "\t\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_max_heap_peek_top_k() {
+  bool result = false;
+  std::vector<int> vector_h;
+  for ( int i = 0; i < 1000; i++ ) {
+    vector_h.push_back( ( i * 7919 ) % 1009 );
+  }
+  std::vector<int> reference = vector_h;
+  std::sort( reference.begin(), reference.end() );
+  std::reverse( reference.begin(), reference.end() );
+  MaxHeap<int> h( vector_h );
+  MaxHeap<int, 4> h4( vector_h );
+  MaxHeap<int> before = h;
+  std::vector<int> top = h.peekTopK( 100 );
+  std::vector<int> top4 = h4.peekTopK( 100 );
+  std::vector<int> all = h.peekTopK( 5000 );
+  MaxHeap<int> empty_heap;
+  bool t1 = std::equal( top.begin(), top.end(), reference.begin() ) && top.size() == 100;
+  bool t2 = std::equal( top4.begin(), top4.end(), reference.begin() ) && top4.size() == 100;
+  bool t3 = all == reference && h == before;
+  bool t4 = h.peekTopK( 0 ).empty() && empty_heap.peekTopK( 10 ).empty();
+  bool t = t1 && t2 && t3 && t4;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "h.peekTopK() = " << t << "\t\t\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_max_heap_extract_batch() {
+  bool result = false;
+  int array_h[10] = { 4, 1, 3, 2, 16, 9, 10, 14, 8, 7 };
+  MaxHeap<int, 3> h( array_h, 10 );
+  std::vector<int> top = h.extractBatch( 4 );
+  std::vector<int> rest = h.extractBatch( 100 );
+  bool t1 = top.size() == 4 && top[ 0 ] == 16 && top[ 1 ] == 14 && top[ 2 ] == 10 && top[ 3 ] == 9;
+  bool t2 = rest.size() == 6 && rest[ 0 ] == 8 && rest[ 5 ] == 1 && h.empty();
+  bool t3 = h.extractBatch( 3 ).empty();
+  bool t = t1 && t2 && t3;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "h.extractBatch() = " << t << "\t\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+template<typename Layout, size_t Arity>
+bool checkLayoutIndices() {
+  typedef typename Layout::template Index<int, Arity> Index;
+  bool t = true;
+  for ( size_t i = 0; t && i < 100000; i++ ) {
+    for ( size_t k = 0; k < Arity; k++ ) {
+      size_t child = Index::child( i, k );
+      t = t && child > i && Index::parent( child ) == i;
+      t = t && ( k == 0 || child > Index::child( i, k - 1 ) );
+    }
+    if ( i > 0 ) {
+      t = t && Index::parent( i ) < i;
+    }
+    size_t end = Index::internalEnd( i + 1 );
+    t = t && ( i == 0 || Index::parent( i ) < end );
+  }
+  return t;
+}
+
+template<size_t Arity, typename Layout>
+bool checkLayoutOperations( const std::vector<int>& vector_h ) {
+  std::vector<int> reference = vector_h;
+  std::sort( reference.begin(), reference.end() );
+  std::reverse( reference.begin(), reference.end() );
+  MaxHeap<int, Arity, Layout> built_recursive( vector_h, RECURSIVE );
+  MaxHeap<int, Arity, Layout> built_parallel( vector_h, PARALLEL, 2 );
+  MaxHeap<int, Arity, Layout> inserted;
+  for ( size_t i = 0; i < vector_h.size() / 2; i++ ) {
+    inserted.maxHeapInsert( vector_h[ i ] );
+  }
+  inserted.insertRange( vector_h.begin() + vector_h.size() / 2, vector_h.end() );
+  bool t1 = built_recursive.isMaxHeap() && built_parallel.isMaxHeap() && inserted.isMaxHeap();
+  bool t2 = built_recursive.heapSort() == reference && inserted.peekTopK( 50 ) == std::vector<int>( reference.begin(), reference.begin() + 50 );
+  built_parallel.setExtractionType( BOTTOM_UP );
+  bool t3 = true;
+  for ( size_t i = 0; i < reference.size(); i++ ) {
+    t3 = t3 && built_parallel.heapExtractMax() == reference[ i ];
+  }
+  inserted.removeAt( inserted.getSize() / 3 );
+  inserted.updateKey( inserted.getSize() - 1, 1 << 30 );
+  bool t4 = inserted.isMaxHeap() && inserted.heapMaximum() == 1 << 30;
+  return t1 && t2 && t3 && t4;
+}
+
+bool test_max_heap_bheap_layout() {
+  bool result = false;
+  std::vector<int> vector_h;
+  for ( int i = 0; i < 5000; i++ ) {
+    vector_h.push_back( ( i * 7919 ) % 5003 );
+  }
+  bool t1 = checkLayoutIndices<ImplicitLayout, 2>() && checkLayoutIndices<BHeapLayout<64>, 2>();
+  bool t2 = checkLayoutIndices<BHeapLayout<256>, 4>() && checkLayoutIndices<BHeapLayout<4096>, 3>();
+  bool t3 = checkLayoutOperations<2, BHeapLayout<64> >( vector_h ) && checkLayoutOperations<2, BHeapLayout<4096> >( vector_h );
+  bool t4 = checkLayoutOperations<4, BHeapLayout<256> >( vector_h ) && checkLayoutOperations<2, ImplicitLayout>( vector_h );
+  bool t = t1 && t2 && t3 && t4;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "BHeapLayout = " << t << "\t\t\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+template<typename T, size_t Arity>
+bool checkSimdMaxChild() {
+  if ( !SimdMaxChild<T, Arity>::ENABLED || !SimdMaxChild<T, Arity>::available() ) {
+    return true;
+  }
+  bool t = true;
+  T children[ Arity ];
+  for ( size_t round = 0; t && round < 1000; round++ ) {
+    for ( size_t k = 0; k < Arity; k++ ) {
+      long long value = static_cast<long long>( ( round * 7919 + k * 104729 ) % ( 3 + round % 11 ) ) - 5;
+      children[ k ] = static_cast<T>( round % 2 == 0 ? value : value * 1000000007LL );
+    }
+    size_t expected = 0;
+    for ( size_t k = 1; k < Arity; k++ ) {
+      if ( children[ expected ] < children[ k ] ) {
+        expected = k;
+      }
+    }
+    t = SimdMaxChild<T, Arity>::select( children ) == expected;
+  }
+  return t;
+}
+
+template<typename T, size_t Arity>
+bool checkSimdHeapSort() {
+  std::vector<T> vector_h;
+  for ( int i = 0; i < 1000; i++ ) {
+    vector_h.push_back( static_cast<T>( ( i * 7919 ) % 1009 ) - static_cast<T>( 500 ) );
+  }
+  std::vector<T> reference = vector_h;
+  std::sort( reference.begin(), reference.end() );
+  std::reverse( reference.begin(), reference.end() );
+  MaxHeap<T, Arity> h( vector_h );
+  bool t = h.isMaxHeap() && h.heapSort() == reference;
+  for ( size_t i = 0; t && i < reference.size(); i++ ) {
+    t = h.heapExtractMax() == reference[ i ];
+  }
+  return t;
+}
+
+bool test_max_heap_simd_max_child() {
+  bool result = false;
+  bool t1 = checkSimdMaxChild<int32_t, 4>() && checkSimdMaxChild<int32_t, 8>() && checkSimdMaxChild<int32_t, 16>();
+  bool t2 = checkSimdMaxChild<uint32_t, 4>() && checkSimdMaxChild<uint32_t, 16>() && checkSimdMaxChild<float, 4>() && checkSimdMaxChild<float, 8>();
+  bool t3 = checkSimdMaxChild<int64_t, 4>() && checkSimdMaxChild<int64_t, 16>() && checkSimdMaxChild<uint64_t, 8>() && checkSimdMaxChild<double, 4>();
+  bool t4 = checkSimdHeapSort<int, 4>() && checkSimdHeapSort<unsigned, 8>() && checkSimdHeapSort<float, 16>();
+  bool t5 = checkSimdHeapSort<long long, 4>() && checkSimdHeapSort<uint64_t, 8>() && checkSimdHeapSort<double, 16>();
+  bool t6 = SimdMaxChild<int, 4>::ENABLED == SimdMaxChild<float, 8>::ENABLED && !SimdMaxChild<int, 2>::ENABLED && !SimdMaxChild<std::string, 4>::ENABLED;
+  bool t = t1 && t2 && t3 && t4 && t5 && t6;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "SimdMaxChild = " << t << "\t\t\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_max_heap_serialize() {
+  bool result = false;
+  std::vector<int> ints;
+  for ( int i = 0; i < 1000; i++ ) {
+    ints.push_back( ( i * 7919 ) % 1009 );
+  }
+  MaxHeap<int, 4> ref( ints );
+  std::stringstream stream;
+  serializeMaxHeap( ref, stream, 100 );
+  stream << "tail";
+  MaxHeap<int, 4> copy;
+  deserializeMaxHeap( stream, copy );
+  std::string tail;
+  stream >> tail;
+  bool t1 = copy == ref && tail == "tail";
+  std::string bytes;
+  {
+    std::ostringstream out;
+    serializeMaxHeap( ref, out, 64 );
+    bytes = out.str();
+  }
+  MaxHeapReader<int> reader( 4 );
+  for ( size_t i = 0; i < bytes.size(); i += 5 ) {
+    reader.feed( bytes.data() + i, std::min<size_t>( 5, bytes.size() - i ) );
+  }
+  MaxHeap<int, 4> fed;
+  deserializeMaxHeap( reader, fed );
+  bool t2 = fed == ref && reader.elements().empty();
+  MaxHeap<std::string> strings;
+  const char* words[] = { "", "heap", "a", "serialized", "max", "zz" };
+  for ( size_t i = 0; i < 6; i++ ) {
+    strings.maxHeapInsert( words[ i ] );
+  }
+  std::stringstream text;
+  serializeMaxHeap( strings, text, 4 );
+  MaxHeap<std::string> restored;
+  deserializeMaxHeap( text, restored );
+  bool t3 = restored == strings;
+  size_t failures = 0;
+  std::string corrupt[ 5 ] = { bytes, bytes, bytes.substr( 0, bytes.size() - 1 ), bytes, bytes + "x" };
+  corrupt[ 0 ][ 0 ] = 'X';
+  corrupt[ 3 ][ sizeof( MaxHeapStreamHeader ) + sizeof( MaxHeapChunkHeader ) + 2 * sizeof( int ) - 1 ] = 0x7f;
+  for ( size_t i = 0; i < 5; i++ ) {
+    MaxHeap<int, 4> target( ints );
+    MaxHeap<int, 2> binary;
+    try {
+      if ( i == 1 ) {
+        deserializeMaxHeap( corrupt[ i ].data(), corrupt[ i ].size(), binary );
+      } else {
+        deserializeMaxHeap( corrupt[ i ].data(), corrupt[ i ].size(), target );
+      }
+    } catch ( const std::runtime_error& ) {
+      failures += target == ref ? 1 : 0;
+    }
+  }
+  bool t4 = failures == 5;
+  MaxHeapStreamHeader huge( 4, sizeof( int ), 1ULL << 60 );
+  MaxHeapChunkHeader one = { 1, sizeof( int ) };
+  MaxHeapChunkHeader last = { 0, 0 };
+  int element = 42;
+  MaxHeapReader<int> hostile( 4 );
+  hostile.feed( reinterpret_cast<const char*>( &huge ), sizeof( huge ) );
+  hostile.feed( reinterpret_cast<const char*>( &one ), sizeof( one ) );
+  hostile.feed( reinterpret_cast<const char*>( &element ), sizeof( element ) );
+  bool bounded = hostile.elements().capacity() <= MAXHEAP_STREAM_MAX_CHUNK_BYTES / sizeof( int );
+  try {
+    hostile.feed( reinterpret_cast<const char*>( &last ), sizeof( last ) );
+    bounded = false;
+  } catch ( const std::runtime_error& ) {
+  }
+  MaxHeapStreamHeader text_header( 2, 0, 1ULL << 40 );
+  MaxHeapChunkHeader oversized = { 1, UINT32_MAX };
+  MaxHeapReader<std::string> text_reader( 2 );
+  text_reader.feed( reinterpret_cast<const char*>( &text_header ), sizeof( text_header ) );
+  try {
+    text_reader.feed( reinterpret_cast<const char*>( &oversized ), sizeof( oversized ) );
+    bounded = false;
+  } catch ( const std::runtime_error& ) {
+  }
+  std::ostringstream printed;
+  printed << std::vector<int>();
+  bool t5 = printed.str() == "{ }";
+  bool t = t1 && t2 && t3 && t4 && t5 && bounded;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "serialize = " << t << "\t\t\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_max_heap_stats() {
+  bool result = false;
+  struct Bare {
+    std::vector<int> heap;
+    MaxHeapExtractionType extraction_type;
+  };
+  // Derived classes reuse the tail padding of their base, so these differ
+  // even if the policy takes only a byte hidden in the padding of MaxHeap.
+  struct BareTail : Bare {
+    char tail[ 4 ];
+  };
+  struct PlainTail : MaxHeap<int> {
+    char tail[ 4 ];
+  };
+  static_assert( sizeof( PlainTail ) == sizeof( BareTail ), "NoMaxHeapStats must take no space" );
+  MaxHeap<int> plain;
+  plain.maxHeapInsert( 1 );
+  plain.maxHeapInsert( 2 );
+  plain.heapExtractMax();
+  bool t1 = sizeof( MaxHeap<int> ) == sizeof( Bare ) && plain.getStats().comparisons == 0 && plain.getStats().inserts == 0;
+  MaxHeap<int, 2, ImplicitLayout, InstanceMaxHeapStats> counted;
+  counted.reserve( 16 );
+  counted.maxHeapInsert( 1 );
+  counted.maxHeapInsert( 2 );
+  counted.maxHeapInsert( 3 );
+  MaxHeapStats s = counted.getStats();
+  bool t2 = s.comparisons == 4 && s.moves == 4 && s.sifts == 2 && s.sift_levels == 2 && s.max_sift_depth == 1
+            && s.reallocations == 1 && s.inserts == 3 && s.extracts == 0;
+  counted.heapExtractMax();
+  std::vector<int> sorted = counted.heapSort();
+  counted.removeAt( 1 );
+  MaxHeapStats delta = counted.getStats().since( s );
+  bool t3 = delta.extracts == 1 && delta.sorts == 1 && delta.removes == 1 && delta.comparisons > 0 && sorted.size() == 2;
+  counted.resetStats();
+  bool t4 = counted.getStats().comparisons == 0 && counted.getStats().inserts == 0 && counted.getStats().max_sift_depth == 0;
+  std::vector<int> many;
+  for ( int i = 0; i < 70000; i++ ) {
+    many.push_back( ( i * 7919 ) % 70001 );
+  }
+  MaxHeap<int, 2, ImplicitLayout, InstanceMaxHeapStats> parallel( many, PARALLEL, 4 );
+  MaxHeap<int, 4, ImplicitLayout, InstanceMaxHeapStats> ascending;
+  for ( int i = 0; i < 1000; i++ ) {
+    ascending.maxHeapInsert( i );
+  }
+  bool t7 = ascending.getStats().moves > 1000 && ascending.getStats().sift_levels > 0 && ascending.getStats().inserts == 1000;
+  bool t5 = parallel.isMaxHeap() && parallel.getStats().sifts > 0 && parallel.getStats().max_sift_depth <= 17;
+  ThreadLocalMaxHeapStats::clear();
+  MaxHeap<int, 2, ImplicitLayout, ThreadLocalMaxHeapStats> a;
+  MaxHeap<int, 4, ImplicitLayout, ThreadLocalMaxHeapStats> b;
+  a.maxHeapInsert( 1 );
+  a.maxHeapInsert( 2 );
+  b.maxHeapInsert( 3 );
+  uint64_t other_inserts = 0;
+  std::thread worker( [ &other_inserts ]() {
+    MaxHeap<int, 2, ImplicitLayout, ThreadLocalMaxHeapStats> c;
+    for ( int i = 0; i < 7; i++ ) {
+      c.maxHeapInsert( i );
+    }
+    other_inserts = c.getStats().inserts;
+  } );
+  worker.join();
+  bool t6 = a.getStats().inserts == 3 && b.getStats().inserts == 3 && ThreadLocalMaxHeapStats::current().inserts == 3 && other_inserts == 7;
+  bool t = t1 && t2 && t3 && t4 && t5 && t6 && t7;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "stats = " << t << "\t\t\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
 int main( int argc, const char * argv[] ) {
   if ( test_max_heap_empty_constructor() ) {
     std::cout << "test_max_heap_empty_constructor -> OK" << std::endl;
@@ -638,5 +1498,135 @@ int main( int argc, const char * argv[] ) {
   } else {
     std::cout << "test_max_heap_remove_at -> FAIL" << std::endl;
   }
+  if ( test_max_heap_quaternary_child_index() ) {
+    std::cout << "test_max_heap_quaternary_child_index -> OK" << std::endl;
+  } else {
+    std::cout << "test_max_heap_quaternary_child_index -> FAIL" << std::endl;
+  }
+  if ( test_max_heap_quaternary_build_max_heap() ) {
+    std::cout << "test_max_heap_quaternary_build_max_heap -> OK" << std::endl;
+  } else {
+    std::cout << "test_max_heap_quaternary_build_max_heap -> FAIL" << std::endl;
+  }
+  if ( test_max_heap_octonary_sort() ) {
+    std::cout << "test_max_heap_octonary_sort -> OK" << std::endl;
+  } else {
+    std::cout << "test_max_heap_octonary_sort -> FAIL" << std::endl;
+  }
+  if ( test_max_heap_hexadecimal_insert_extract() ) {
+    std::cout << "test_max_heap_hexadecimal_insert_extract -> OK" << std::endl;
+  } else {
+    std::cout << "test_max_heap_hexadecimal_insert_extract -> FAIL" << std::endl;
+  }
+  if ( test_max_heap_remove_at_duplicates() ) {
+    std::cout << "test_max_heap_remove_at_duplicates -> OK" << std::endl;
+  } else {
+    std::cout << "test_max_heap_remove_at_duplicates -> FAIL" << std::endl;
+  }
+  if ( test_max_heap_vector_move_constructor() ) {
+    std::cout << "test_max_heap_vector_move_constructor -> OK" << std::endl;
+  } else {
+    std::cout << "test_max_heap_vector_move_constructor -> FAIL" << std::endl;
+  }
+  if ( test_max_heap_insert_rvalue() ) {
+    std::cout << "test_max_heap_insert_rvalue -> OK" << std::endl;
+  } else {
+    std::cout << "test_max_heap_insert_rvalue -> FAIL" << std::endl;
+  }
+  if ( test_max_heap_move_only() ) {
+    std::cout << "test_max_heap_move_only -> OK" << std::endl;
+  } else {
+    std::cout << "test_max_heap_move_only -> FAIL" << std::endl;
+  }
+  if ( test_max_heap_at_out_of_range() ) {
+    std::cout << "test_max_heap_at_out_of_range -> OK" << std::endl;
+  } else {
+    std::cout << "test_max_heap_at_out_of_range -> FAIL" << std::endl;
+  }
+  if ( test_max_heap_bottom_up_extract_max() ) {
+    std::cout << "test_max_heap_bottom_up_extract_max -> OK" << std::endl;
+  } else {
+    std::cout << "test_max_heap_bottom_up_extract_max -> FAIL" << std::endl;
+  }
+  if ( test_max_heap_bottom_up_sort() ) {
+    std::cout << "test_max_heap_bottom_up_sort -> OK" << std::endl;
+  } else {
+    std::cout << "test_max_heap_bottom_up_sort -> FAIL" << std::endl;
+  }
+  if ( test_max_heap_bottom_up_remove_at() ) {
+    std::cout << "test_max_heap_bottom_up_remove_at -> OK" << std::endl;
+  } else {
+    std::cout << "test_max_heap_bottom_up_remove_at -> FAIL" << std::endl;
+  }
+  if ( test_max_heap_build_max_heap_parallel() ) {
+    std::cout << "test_max_heap_build_max_heap_parallel -> OK" << std::endl;
+  } else {
+    std::cout << "test_max_heap_build_max_heap_parallel -> FAIL" << std::endl;
+  }
+  if ( test_max_heap_insert_range() ) {
+    std::cout << "test_max_heap_insert_range -> OK" << std::endl;
+  } else {
+    std::cout << "test_max_heap_insert_range -> FAIL" << std::endl;
+  }
+  if ( test_max_heap_increase_decrease_key() ) {
+    std::cout << "test_max_heap_increase_decrease_key -> OK" << std::endl;
+  } else {
+    std::cout << "test_max_heap_increase_decrease_key -> FAIL" << std::endl;
+  }
+  if ( test_max_heap_update_key() ) {
+    std::cout << "test_max_heap_update_key -> OK" << std::endl;
+  } else {
+    std::cout << "test_max_heap_update_key -> FAIL" << std::endl;
+  }
+  if ( test_max_heap_update_keys() ) {
+    std::cout << "test_max_heap_update_keys -> OK" << std::endl;
+  } else {
+    std::cout << "test_max_heap_update_keys -> FAIL" << std::endl;
+  }
+  if ( test_max_heap_sort_in_place() ) {
+    std::cout << "test_max_heap_sort_in_place -> OK" << std::endl;
+  } else {
+    std::cout << "test_max_heap_sort_in_place -> FAIL" << std::endl;
+  }
+  if ( test_max_heap_sort_into() ) {
+    std::cout << "test_max_heap_sort_into -> OK" << std::endl;
+  } else {
+    std::cout << "test_max_heap_sort_into -> FAIL" << std::endl;
+  }
+  if ( test_max_heap_replace_max() ) {
+    std::cout << "test_max_heap_replace_max -> OK" << std::endl;
+  } else {
+    std::cout << "test_max_heap_replace_max -> FAIL" << std::endl;
+  }
+  if ( test_max_heap_peek_top_k() ) {
+    std::cout << "test_max_heap_peek_top_k -> OK" << std::endl;
+  } else {
+    std::cout << "test_max_heap_peek_top_k -> FAIL" << std::endl;
+  }
+  if ( test_max_heap_extract_batch() ) {
+    std::cout << "test_max_heap_extract_batch -> OK" << std::endl;
+  } else {
+    std::cout << "test_max_heap_extract_batch -> FAIL" << std::endl;
+  }
+  if ( test_max_heap_bheap_layout() ) {
+    std::cout << "test_max_heap_bheap_layout -> OK" << std::endl;
+  } else {
+    std::cout << "test_max_heap_bheap_layout -> FAIL" << std::endl;
+  }
+  if ( test_max_heap_simd_max_child() ) {
+    std::cout << "test_max_heap_simd_max_child -> OK" << std::endl;
+  } else {
+    std::cout << "test_max_heap_simd_max_child -> FAIL" << std::endl;
+  }
+  if ( test_max_heap_serialize() ) {
+    std::cout << "test_max_heap_serialize -> OK" << std::endl;
+  } else {
+    std::cout << "test_max_heap_serialize -> FAIL" << std::endl;
+  }
+  if ( test_max_heap_stats() ) {
+    std::cout << "test_max_heap_stats -> OK" << std::endl;
+  } else {
+    std::cout << "test_max_heap_stats -> FAIL" << std::endl;
+  }
   return 0;
 }
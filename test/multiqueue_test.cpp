@@ -0,0 +1,151 @@
+#include "MultiQueue.h"
+#include <algorithm>
+#include <iostream>
+#include <set>
+#include <thread>
+#include <vector>
+
+bool test_multiqueue_push_pop_all() {
+  bool result = false;
+  MultiQueue<int> q( 4, 2 );
+  for ( int i = 0; i < 1000; i++ ) {
+    q.push( ( i * 7919 ) % 1009 );
+  }
+  bool t1 = q.getShardCount() == 8 && q.getSize() == 1000;
+  std::vector<int> popped;
+  int value = 0;
+  while ( q.tryPop( value ) ) {
+    popped.push_back( value );
+  }
+  std::vector<int> reference;
+  for ( int i = 0; i < 1000; i++ ) {
+    reference.push_back( ( i * 7919 ) % 1009 );
+  }
+  std::sort( popped.begin(), popped.end() );
+  std::sort( reference.begin(), reference.end() );
+  bool t2 = popped == reference && q.empty() && !q.tryPop( value );
+  bool t = t1 && t2;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "q.tryPop() = " << t << "\t\t\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_multiqueue_single_shard_is_exact() {
+  bool result = false;
+  int array_h[10] = { 4, 1, 3, 2, 16, 9, 10, 14, 8, 7 };
+  int array_ref[10] = { 16, 14, 10, 9, 8, 7, 4, 3, 2, 1 };
+  MultiQueue<int, 4> q( 1, 1 );
+  for ( int i = 0; i < 10; i++ ) {
+    q.push( array_h[ i ] );
+  }
+  bool t = q.getShardCount() == 1;
+  for ( int i = 0; i < 10; i++ ) {
+    int value = 0;
+    t = t && q.tryPop( value ) && value == array_ref[ i ];
+  }
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "q.tryPop() ordered = " << t << "\t\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_multiqueue_rank_error() {
+  bool result = false;
+  MultiQueue<int> q( 4, 2 );
+  std::set<int> present;
+  for ( int i = 0; i < 4000; i++ ) {
+    q.push( i );
+    present.insert( i );
+  }
+  double total_rank_error = 0;
+  int pops = 0;
+  int value = 0;
+  while ( q.tryPop( value ) ) {
+    total_rank_error += std::distance( present.upper_bound( value ), present.end() );
+    present.erase( value );
+    pops++;
+  }
+  double mean_rank_error = total_rank_error / pops;
+  bool t = pops == 4000 && present.empty() && mean_rank_error < 4.0 * q.getShardCount();
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "mean rank error = " << mean_rank_error << "\t\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_multiqueue_concurrent() {
+  bool result = false;
+  const int threads = 4;
+  const int per_thread = 10000;
+  MultiQueue<int> q( threads );
+  std::vector<std::vector<int> > popped( threads );
+  std::vector<std::thread> workers;
+  for ( int w = 0; w < threads; w++ ) {
+    workers.push_back( std::thread( [&, w]() {
+      int value;
+      for ( int i = 0; i < per_thread; i++ ) {
+        q.push( w * per_thread + i );
+        if ( i % 2 == 1 && q.tryPop( value ) ) {
+          popped[ w ].push_back( value );
+        }
+      }
+    } ) );
+  }
+  for ( size_t i = 0; i < workers.size(); i++ ) {
+    workers[ i ].join();
+  }
+  std::vector<int> all;
+  int value = 0;
+  while ( q.tryPop( value ) ) {
+    all.push_back( value );
+  }
+  for ( int w = 0; w < threads; w++ ) {
+    all.insert( all.end(), popped[ w ].begin(), popped[ w ].end() );
+  }
+  std::sort( all.begin(), all.end() );
+  bool t = all.size() == static_cast<size_t>( threads * per_thread ) && q.empty();
+  for ( size_t i = 0; t && i < all.size(); i++ ) {
+    t = all[ i ] == static_cast<int>( i );
+  }
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "concurrent push/tryPop = " << t << "\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+int main( int argc, const char * argv[] ) {
+  if ( test_multiqueue_push_pop_all() ) {
+    std::cout << "test_multiqueue_push_pop_all -> OK" << std::endl;
+  } else {
+    std::cout << "test_multiqueue_push_pop_all -> FAIL" << std::endl;
+  }
+  if ( test_multiqueue_single_shard_is_exact() ) {
+    std::cout << "test_multiqueue_single_shard_is_exact -> OK" << std::endl;
+  } else {
+    std::cout << "test_multiqueue_single_shard_is_exact -> FAIL" << std::endl;
+  }
+  if ( test_multiqueue_rank_error() ) {
+    std::cout << "test_multiqueue_rank_error -> OK" << std::endl;
+  } else {
+    std::cout << "test_multiqueue_rank_error -> FAIL" << std::endl;
+  }
+  if ( test_multiqueue_concurrent() ) {
+    std::cout << "test_multiqueue_concurrent -> OK" << std::endl;
+  } else {
+    std::cout << "test_multiqueue_concurrent -> FAIL" << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,186 @@
+#include "PairingMaxHeap.h"
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+bool test_pairing_max_heap_insert_extract() {
+  bool result = false;
+  int array_h[10] = { 4, 1, 3, 2, 16, 9, 10, 14, 8, 7 };
+  PairingMaxHeap<int> h;
+  for ( int i = 0; i < 10; i++ ) {
+    h.maxHeapInsert( array_h[ i ] );
+  }
+  int array_ref[10] = { 16, 14, 10, 9, 8, 7, 4, 3, 2, 1 };
+  bool t1 = h.getSize() == 10 && h.isMaxHeap();
+  bool t2 = true;
+  for ( int i = 0; i < 10; i++ ) {
+    t2 = t2 && h.heapMaximum() == array_ref[ i ] && h.heapExtractMax() == array_ref[ i ] && h.isMaxHeap();
+  }
+  bool thrown = false;
+  try {
+    h.heapExtractMax();
+  }
+  catch ( const std::underflow_error& ) {
+    thrown = true;
+  }
+  bool t = t1 && t2 && h.empty() && thrown;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "h.heapExtractMax() ordered = " << t2 << "\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_pairing_max_heap_erase_increase_key() {
+  bool result = false;
+  PairingMaxHeap<std::string> h;
+  std::vector<PairingMaxHeap<std::string>::Handle> handles;
+  std::vector<std::string> reference;
+  for ( int i = 0; i < 500; i++ ) {
+    std::string key = std::to_string( ( i * 7919 ) % 1009 );
+    handles.push_back( h.maxHeapInsert( key ) );
+    reference.push_back( key );
+  }
+  PairingMaxHeap<std::string>::Handle extracted = h.maximumHandle();
+  h.heapExtractMax();
+  reference.erase( std::max_element( reference.begin(), reference.end() ) );
+  bool t1 = true;
+  for ( size_t i = 0; t1 && i < handles.size(); i += 3 ) {
+    if ( handles[ i ] == extracted ) {
+      continue;
+    }
+    std::string removed = h.erase( handles[ i ] );
+    reference.erase( std::find( reference.begin(), reference.end(), removed ) );
+    t1 = h.isMaxHeap() && h.getSize() == reference.size();
+  }
+  bool t2 = true;
+  for ( size_t i = 1; t2 && i < handles.size(); i += 3 ) {
+    if ( handles[ i ] == extracted ) {
+      continue;
+    }
+    std::string key = h.get( handles[ i ] );
+    *std::find( reference.begin(), reference.end(), key ) = "9" + key;
+    h.increaseKey( handles[ i ], "9" + key );
+    t2 = h.isMaxHeap() && h.get( handles[ i ] ) == "9" + key;
+  }
+  bool thrown = false;
+  try {
+    h.increaseKey( h.maximumHandle(), "0" );
+  }
+  catch ( const std::invalid_argument& ) {
+    thrown = true;
+  }
+  std::sort( reference.rbegin(), reference.rend() );
+  bool t3 = true;
+  for ( size_t i = 0; t3 && i < reference.size(); i++ ) {
+    t3 = h.heapExtractMax() == reference[ i ];
+  }
+  bool t = t1 && t2 && t3 && thrown && h.empty();
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "h.erase(handle) = " << t1 << "\t\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_pairing_max_heap_meld() {
+  bool result = false;
+  PairingMaxHeap<int> h1;
+  PairingMaxHeap<int> h2;
+  std::vector<PairingMaxHeap<int>::Handle> handles;
+  std::vector<int> reference;
+  for ( int i = 0; i < 300; i++ ) {
+    int key = ( i * 37 ) % 101;
+    handles.push_back( i % 2 == 0 ? h1.maxHeapInsert( key ) : h2.maxHeapInsert( key ) );
+    reference.push_back( key );
+  }
+  int extracted = h2.heapExtractMax();
+  reference.erase( std::find( reference.begin(), reference.end(), extracted ) );
+  h1.meld( h2 );
+  bool t1 = h1.getSize() == reference.size() && h2.empty() && h1.isMaxHeap() && h2.isMaxHeap();
+  h1.meld( h2 );
+  h2.maxHeapInsert( 5 );
+  h1.meld( h1 );
+  bool t2 = h1.getSize() == reference.size() && h2.getSize() == 1;
+  int erased = h1.erase( handles[ 1 ] );
+  reference.erase( std::find( reference.begin(), reference.end(), erased ) );
+  h1.increaseKey( handles[ 3 ], 1000 );
+  *std::find( reference.begin(), reference.end(), ( 3 * 37 ) % 101 ) = 1000;
+  PairingMaxHeap<int> h3( std::move( h1 ) );
+  std::sort( reference.rbegin(), reference.rend() );
+  bool t3 = h1.empty() && h3.isMaxHeap() && h3.maximumHandle() == handles[ 3 ];
+  for ( size_t i = 0; t3 && i < reference.size(); i++ ) {
+    t3 = h3.heapExtractMax() == reference[ i ];
+  }
+  bool t = t1 && t2 && t3 && h3.empty();
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "h1.meld(h2) = " << t1 << "\t\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_pairing_max_heap_node_pool() {
+  bool result = false;
+  NodePool<std::string> pool;
+  std::vector<std::string*> nodes;
+  for ( int i = 0; i < 100; i++ ) {
+    nodes.push_back( pool.create( std::to_string( i ) ) );
+  }
+  size_t chunks = pool.getChunkCount();
+  for ( size_t i = 0; i < nodes.size(); i++ ) {
+    pool.destroy( nodes[ i ] );
+  }
+  for ( int i = 0; i < 100; i++ ) {
+    nodes[ i ] = pool.create( std::to_string( i ) );
+  }
+  bool t1 = pool.getChunkCount() == chunks;
+  NodePool<std::string> other;
+  std::string* moved = other.create( "moved" );
+  pool.splice( other );
+  bool t2 = *moved == "moved" && other.getChunkCount() == 0 && pool.getChunkCount() == chunks + 1;
+  pool.destroy( moved );
+  for ( size_t i = 0; i < nodes.size(); i++ ) {
+    t2 = t2 && *nodes[ i ] == std::to_string( i );
+    pool.destroy( nodes[ i ] );
+  }
+  bool t = t1 && t2;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "pool.getChunkCount() = " << chunks << "\t\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+int main( int argc, const char * argv[] ) {
+  if ( test_pairing_max_heap_insert_extract() ) {
+    std::cout << "test_pairing_max_heap_insert_extract -> OK" << std::endl;
+  } else {
+    std::cout << "test_pairing_max_heap_insert_extract -> FAIL" << std::endl;
+  }
+  if ( test_pairing_max_heap_erase_increase_key() ) {
+    std::cout << "test_pairing_max_heap_erase_increase_key -> OK" << std::endl;
+  } else {
+    std::cout << "test_pairing_max_heap_erase_increase_key -> FAIL" << std::endl;
+  }
+  if ( test_pairing_max_heap_meld() ) {
+    std::cout << "test_pairing_max_heap_meld -> OK" << std::endl;
+  } else {
+    std::cout << "test_pairing_max_heap_meld -> FAIL" << std::endl;
+  }
+  if ( test_pairing_max_heap_node_pool() ) {
+    std::cout << "test_pairing_max_heap_node_pool -> OK" << std::endl;
+  } else {
+    std::cout << "test_pairing_max_heap_node_pool -> FAIL" << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,133 @@
+#include "MaxHeap.h"
+#include "RadixMaxHeap.h"
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+bool test_radix_max_heap_insert_extract() {
+  bool result = false;
+  int array_h[10] = { 4, 1, 3, 2, 16, 9, 10, 14, 8, 7 };
+  RadixMaxHeap<int, std::string> h;
+  for ( int i = 0; i < 10; i++ ) {
+    h.maxHeapInsert( array_h[ i ], std::to_string( array_h[ i ] ) );
+  }
+  int array_ref[10] = { 16, 14, 10, 9, 8, 7, 4, 3, 2, 1 };
+  bool t1 = h.getSize() == 10 && h.isMaxHeap();
+  bool t2 = true;
+  for ( int i = 0; i < 10; i++ ) {
+    bool top = h.heapMaximum() == array_ref[ i ] && h.maximumValue() == std::to_string( array_ref[ i ] );
+    RadixMaxHeap<int, std::string>::Element element = h.heapExtractMax();
+    t2 = t2 && top && element.first == array_ref[ i ] && element.second == std::to_string( array_ref[ i ] ) && h.isMaxHeap();
+  }
+  bool thrown = false;
+  try {
+    h.heapExtractMax();
+  }
+  catch ( const std::underflow_error& ) {
+    thrown = true;
+  }
+  bool t = t1 && t2 && h.empty() && thrown;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "h.heapExtractMax() ordered = " << t2 << "\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_radix_max_heap_monotone_limit() {
+  bool result = false;
+  RadixMaxHeap<int32_t, int> h;
+  h.maxHeapInsert( -5, 0 );
+  h.maxHeapInsert( 7, 1 );
+  bool t1 = h.getLimit() == INT32_MAX && h.heapExtractMax().first == 7 && h.getLimit() == 7;
+  h.maxHeapInsert( 7, 2 );
+  h.maxHeapInsert( -2147483647 - 1, 3 );
+  bool thrown = false;
+  try {
+    h.maxHeapInsert( 8, 4 );
+  }
+  catch ( const std::invalid_argument& ) {
+    thrown = true;
+  }
+  bool t2 = h.heapExtractMax().second == 2 && h.heapExtractMax().first == -5 && h.heapExtractMax().first == INT32_MIN;
+  h.clear();
+  h.maxHeapInsert( INT32_MAX, 5 );
+  bool t3 = h.heapMaximum() == INT32_MAX && h.getSize() == 1;
+  bool t = t1 && t2 && t3 && thrown;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "h.getLimit() = " << h.getLimit() << "\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+/*
+ * Runs the same monotone sequence of operations on a radix heap and on a
+ * MaxHeap of pairs, inserting keys at most span below the last maximum.
+ */
+template<typename Key>
+bool checkRadixAgainstMaxHeap( Key start, uint64_t span ) {
+  RadixMaxHeap<Key, uint32_t> radix;
+  MaxHeap<std::pair<Key, uint32_t> > reference;
+  uint64_t state = 88172645463325252ULL;
+  Key limit = start;
+  bool t = true;
+  for ( uint32_t i = 0; t && i < 5000; i++ ) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    if ( state % 3 != 0 || reference.empty() ) {
+      Key key = static_cast<Key>( limit - static_cast<Key>( state % span ) );
+      radix.maxHeapInsert( key, i );
+      reference.maxHeapInsert( std::make_pair( key, i ) );
+    } else {
+      Key expected = reference.heapExtractMax().first;
+      t = radix.heapExtractMax().first == expected && radix.isMaxHeap();
+      limit = expected;
+    }
+  }
+  while ( t && !reference.empty() ) {
+    t = radix.heapExtractMax().first == reference.heapExtractMax().first;
+  }
+  return t && radix.empty();
+}
+
+bool test_radix_max_heap_against_max_heap() {
+  bool result = false;
+  bool t1 = checkRadixAgainstMaxHeap<uint32_t>( 4000000000U, 1000 ) && checkRadixAgainstMaxHeap<int32_t>( 1000, 100000 );
+  bool t2 = checkRadixAgainstMaxHeap<int64_t>( 0, 1ULL << 40 ) && checkRadixAgainstMaxHeap<uint64_t>( UINT64_MAX, 1ULL << 50 );
+  bool t3 = checkRadixAgainstMaxHeap<int16_t>( 30000, 20 );
+  bool t = t1 && t2 && t3;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "RadixMaxHeap == MaxHeap = " << t << "\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+int main( int argc, const char * argv[] ) {
+  if ( test_radix_max_heap_insert_extract() ) {
+    std::cout << "test_radix_max_heap_insert_extract -> OK" << std::endl;
+  } else {
+    std::cout << "test_radix_max_heap_insert_extract -> FAIL" << std::endl;
+  }
+  if ( test_radix_max_heap_monotone_limit() ) {
+    std::cout << "test_radix_max_heap_monotone_limit -> OK" << std::endl;
+  } else {
+    std::cout << "test_radix_max_heap_monotone_limit -> FAIL" << std::endl;
+  }
+  if ( test_radix_max_heap_against_max_heap() ) {
+    std::cout << "test_radix_max_heap_against_max_heap -> OK" << std::endl;
+  } else {
+    std::cout << "test_radix_max_heap_against_max_heap -> FAIL" << std::endl;
+  }
+  return 0;
+}
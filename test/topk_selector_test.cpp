@@ -0,0 +1,128 @@
+#include "TopKSelector.h"
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+bool test_topk_selector_keeps_largest() {
+  bool result = false;
+  TopKSelector<int> s( 10 );
+  std::vector<int> stream;
+  for ( int i = 0; i < 10000; i++ ) {
+    stream.push_back( ( i * 7919 ) % 10007 );
+  }
+  for ( size_t i = 0; i < stream.size(); i++ ) {
+    s.offer( stream[ i ] );
+  }
+  std::vector<int> reference = stream;
+  std::sort( reference.begin(), reference.end() );
+  std::reverse( reference.begin(), reference.end() );
+  reference.resize( 10 );
+  bool t1 = s.getSize() == 10 && s.full() && s.threshold() == reference[ 9 ];
+  std::vector<int> top = s.extractSorted();
+  bool t2 = top == reference && s.empty();
+  bool t = t1 && t2;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "s.extractSorted() = " << t2 << "\t\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_topk_selector_offer_threshold() {
+  bool result = false;
+  TopKSelector<int, 4> s( 3 );
+  bool t1 = s.offer( 5 ) && s.offer( 1 ) && s.offer( 3 );
+  bool t2 = !s.offer( 1 ) && !s.offer( 0 ) && s.threshold() == 1;
+  bool t3 = s.offer( 4 ) && s.threshold() == 3 && s.getSize() == 3;
+  TopKSelector<int> none( 0 );
+  bool t4 = !none.offer( 42 ) && none.empty();
+  bool t5 = false;
+  try {
+    none.threshold();
+  } catch ( const std::underflow_error& ) {
+    t5 = true;
+  }
+  bool t = t1 && t2 && t3 && t4 && t5;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "s.offer() = " << t << "\t\t\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_topk_selector_merge() {
+  bool result = false;
+  std::vector<TopKSelector<int> > partial( 4, TopKSelector<int>( 5 ) );
+  std::vector<int> stream;
+  for ( int i = 0; i < 1000; i++ ) {
+    stream.push_back( ( i * 37 ) % 1009 );
+    partial[ i % 4 ].offer( stream.back() );
+  }
+  TopKSelector<int> global( 5 );
+  for ( size_t i = 0; i < partial.size(); i++ ) {
+    global.merge( std::move( partial[ i ] ) );
+  }
+  std::vector<int> reference = stream;
+  std::sort( reference.begin(), reference.end() );
+  std::reverse( reference.begin(), reference.end() );
+  reference.resize( 5 );
+  bool t = global.extractSorted() == reference;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "s.merge() = " << t << "\t\t\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_topk_selector_strings() {
+  bool result = false;
+  TopKSelector<std::string> s( 2 );
+  std::string a( "apple" );
+  std::string c( "cherry" );
+  s.offer( std::move( a ) );
+  s.offer( std::string( "banana" ) );
+  s.offer( c );
+  std::vector<std::string> top = s.extractSorted();
+  bool t1 = top.size() == 2 && top[ 0 ] == "cherry" && top[ 1 ] == "banana";
+  bool t2 = s.offer( std::string( "date" ) ) && s.getSize() == 1;
+  bool t = t1 && t2;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "s.offer(T&&) = " << t << "\t\t\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+int main( int argc, const char * argv[] ) {
+  if ( test_topk_selector_keeps_largest() ) {
+    std::cout << "test_topk_selector_keeps_largest -> OK" << std::endl;
+  } else {
+    std::cout << "test_topk_selector_keeps_largest -> FAIL" << std::endl;
+  }
+  if ( test_topk_selector_offer_threshold() ) {
+    std::cout << "test_topk_selector_offer_threshold -> OK" << std::endl;
+  } else {
+    std::cout << "test_topk_selector_offer_threshold -> FAIL" << std::endl;
+  }
+  if ( test_topk_selector_merge() ) {
+    std::cout << "test_topk_selector_merge -> OK" << std::endl;
+  } else {
+    std::cout << "test_topk_selector_merge -> FAIL" << std::endl;
+  }
+  if ( test_topk_selector_strings() ) {
+    std::cout << "test_topk_selector_strings -> OK" << std::endl;
+  } else {
+    std::cout << "test_topk_selector_strings -> FAIL" << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,124 @@
+#include "WorkStealingScheduler.h"
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+bool test_work_stealing_scheduler_local_order() {
+  bool result = false;
+  int array_h[10] = { 4, 1, 3, 2, 16, 9, 10, 14, 8, 7 };
+  int array_ref[10] = { 16, 14, 10, 9, 8, 7, 4, 3, 2, 1 };
+  WorkStealingScheduler<int> s( 1 );
+  for ( int i = 0; i < 10; i++ ) {
+    s.push( 0, array_h[ i ] );
+  }
+  bool t1 = s.getWorkerCount() == 1 && s.getSize( 0 ) == 10 && s.getSize() == 10;
+  bool t2 = true;
+  for ( int i = 0; i < 10; i++ ) {
+    int value = 0;
+    t2 = t2 && s.tryPop( 0, value ) && value == array_ref[ i ];
+  }
+  int value = 0;
+  bool t = t1 && t2 && !s.tryPop( 0, value );
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "s.tryPop() ordered = " << t2 << "\t\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_work_stealing_scheduler_steals_top_half() {
+  bool result = false;
+  WorkStealingScheduler<int, 4> s( 3, 64 );
+  for ( int i = 0; i < 10; i++ ) {
+    s.push( 1, i );
+  }
+  s.push( 2, 100 );
+  int value = 0;
+  bool t1 = s.tryPop( 0, value ) && value == 9;
+  bool t2 = s.getSize( 0 ) == 4 && s.getSize( 1 ) == 5 && s.getSize( 2 ) == 1;
+  bool t3 = s.tryPop( 0, value ) && value == 8 && s.getSize() == 9;
+  WorkStealingScheduler<int> bounded( 2, 3 );
+  for ( int i = 0; i < 100; i++ ) {
+    bounded.push( 0, i );
+  }
+  bool t4 = bounded.steal( 1 ) == 3 && bounded.getSize( 1 ) == 3 && bounded.getSize( 0 ) == 97;
+  WorkStealingScheduler<int> disabled( 2, 0 );
+  disabled.push( 0, 1 );
+  bool t5 = !disabled.tryPop( 1, value ) && disabled.getSize( 0 ) == 1;
+  bool t = t1 && t2 && t3 && t4 && t5;
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "s.steal() = " << t << "\t\t\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+bool test_work_stealing_scheduler_concurrent() {
+  bool result = false;
+  const int workers = 4;
+  const int tasks = 40000;
+  WorkStealingScheduler<int> s( workers, 32 );
+  for ( int i = 0; i < tasks; i++ ) {
+    s.push( 0, i );
+  }
+  std::atomic<int> done( 0 );
+  std::vector<std::vector<int> > executed( workers );
+  std::vector<std::thread> threads;
+  for ( int w = 0; w < workers; w++ ) {
+    threads.push_back( std::thread( [&, w]() {
+      int value;
+      while ( done.load() < tasks ) {
+        if ( s.tryPop( w, value ) ) {
+          executed[ w ].push_back( value );
+          done.fetch_add( 1 );
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    } ) );
+  }
+  for ( size_t i = 0; i < threads.size(); i++ ) {
+    threads[ i ].join();
+  }
+  std::vector<int> all;
+  for ( int w = 0; w < workers; w++ ) {
+    all.insert( all.end(), executed[ w ].begin(), executed[ w ].end() );
+  }
+  std::sort( all.begin(), all.end() );
+  bool t = all.size() == static_cast<size_t>( tasks ) && s.getSize() == 0;
+  for ( size_t i = 0; t && i < all.size(); i++ ) {
+    t = all[ i ] == static_cast<int>( i );
+  }
+  if ( t ) {
+    result = true;
+  }
+  #ifdef NDEBUG
+    std::cout << "concurrent tryPop/steal = " << t << "\t\t\t\t\t\t";
+  #endif
+  return result;
+}
+
+int main( int argc, const char * argv[] ) {
+  if ( test_work_stealing_scheduler_local_order() ) {
+    std::cout << "test_work_stealing_scheduler_local_order -> OK" << std::endl;
+  } else {
+    std::cout << "test_work_stealing_scheduler_local_order -> FAIL" << std::endl;
+  }
+  if ( test_work_stealing_scheduler_steals_top_half() ) {
+    std::cout << "test_work_stealing_scheduler_steals_top_half -> OK" << std::endl;
+  } else {
+    std::cout << "test_work_stealing_scheduler_steals_top_half -> FAIL" << std::endl;
+  }
+  if ( test_work_stealing_scheduler_concurrent() ) {
+    std::cout << "test_work_stealing_scheduler_concurrent -> OK" << std::endl;
+  } else {
+    std::cout << "test_work_stealing_scheduler_concurrent -> FAIL" << std::endl;
+  }
+  return 0;
+}